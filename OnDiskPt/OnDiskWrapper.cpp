@@ -25,6 +25,7 @@
 #include "OnDiskWrapper.h"
 #include "moses/Factor.h"
 #include "util/exception.hh"
+#include "util/mmap.hh"
 
 using namespace std;
 
@@ -82,6 +83,9 @@ bool OnDiskWrapper::OpenForLoad(const std::string &filePath)
                 util::FileOpenException,
                 "Couldn't open file " << filePath << "/Misc.dat");
 
+  m_fdSource.reset(util::OpenReadOrThrow((filePath + "/Source.dat").c_str()));
+  m_fdTargetColl.reset(util::OpenReadOrThrow((filePath + "/TargetColl.dat").c_str()));
+
   // set up root node
   LoadMisc();
   m_numSourceFactors = GetMisc("NumSourceFactors");
@@ -91,6 +95,18 @@ bool OnDiskWrapper::OpenForLoad(const std::string &filePath)
   return true;
 }
 
+// nodes and collections have variable size. Reading ahead one page gets the
+// first disk read going, and the kernel's own read-ahead takes over from there
+void OnDiskWrapper::AdviseSourceNode(UINT64 filePos)
+{
+  util::AdviseWillNeed(m_fdSource.get(), filePos, util::SizePage());
+}
+
+void OnDiskWrapper::AdviseTargetPhraseCollection(UINT64 filePos)
+{
+  util::AdviseWillNeed(m_fdTargetColl.get(), filePos, util::SizePage());
+}
+
 bool OnDiskWrapper::LoadMisc()
 {
   char line[100000];
@@ -23,6 +23,7 @@
 #include "Vocab.h"
 #include "PhraseNode.h"
 #include "moses/Word.h"
+#include "util/file.hh"
 
 namespace OnDiskPt
 {
@@ -39,6 +40,7 @@ protected:
   std::string m_filePath;
   int m_numSourceFactors, m_numTargetFactors, m_numScores;
   std::fstream m_fileMisc, m_fileVocab, m_fileSource, m_fileTarget, m_fileTargetInd, m_fileTargetColl;
+  util::scoped_fd m_fdSource, m_fdTargetColl; /**< only used for read-ahead hints */
 
   size_t m_defaultNodeSize;
   PhraseNode *m_rootSourceNode;
@@ -84,6 +86,11 @@ public:
     return m_fileVocab;
   }
 
+  //! hint that the source node at filePos will be read soon
+  void AdviseSourceNode(UINT64 filePos);
+  //! hint that the target phrase collection at filePos will be read soon
+  void AdviseTargetPhraseCollection(UINT64 filePos);
+
   size_t GetNumSourceFactors() const {
     return m_numSourceFactors;
   }
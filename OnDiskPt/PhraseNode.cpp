@@ -194,10 +194,8 @@ void PhraseNode::AddTargetPhrase(size_t pos, const SourcePhrase &sourcePhrase
   }
 }
 
-const PhraseNode *PhraseNode::GetChild(const Word &wordSought, OnDiskWrapper &onDiskWrapper) const
+bool PhraseNode::FindChild(const Word &wordSought, UINT64 &childFilePos, OnDiskWrapper &onDiskWrapper) const
 {
-  const PhraseNode *ret = NULL;
-
   int l = 0;
   int r = m_numChildrenLoad - 1;
   int x;
@@ -206,12 +204,10 @@ const PhraseNode *PhraseNode::GetChild(const Word &wordSought, OnDiskWrapper &on
     x = (l + r) / 2;
 
     Word wordFound;
-    UINT64 childFilePos;
     GetChild(wordFound, childFilePos, x, onDiskWrapper);
 
     if (wordSought == wordFound) {
-      ret = new PhraseNode(childFilePos, onDiskWrapper);
-      break;
+      return true;
     }
     if (wordSought < wordFound)
       r = x - 1;
@@ -219,7 +215,16 @@ const PhraseNode *PhraseNode::GetChild(const Word &wordSought, OnDiskWrapper &on
       l = x + 1;
   }
 
-  return ret;
+  return false;
+}
+
+const PhraseNode *PhraseNode::GetChild(const Word &wordSought, OnDiskWrapper &onDiskWrapper) const
+{
+  UINT64 childFilePos;
+  if (FindChild(wordSought, childFilePos, onDiskWrapper)) {
+    return new PhraseNode(childFilePos, onDiskWrapper);
+  }
+  return NULL;
 }
 
 void PhraseNode::GetChild(Word &wordFound, UINT64 &childFilePos, size_t ind, OnDiskWrapper &onDiskWrapper) const
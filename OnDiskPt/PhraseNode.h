@@ -91,6 +91,8 @@ public:
     m_pos = pos;
   }
 
+  //! file position of the child for wordSought. False if there is none
+  bool FindChild(const Word &wordSought, UINT64 &childFilePos, OnDiskWrapper &onDiskWrapper) const;
   const PhraseNode *GetChild(const Word &wordSought, OnDiskWrapper &onDiskWrapper) const;
   const TargetPhraseCollection *GetTargetPhraseCollection(size_t tableLimit, OnDiskWrapper &onDiskWrapper) const;
 
@@ -209,11 +209,22 @@ public:
    : m_paramList(paramList),
      m_cond(cond),
      m_mut(mut),
-     m_done(false)
-     {}
+     m_done(false),
+     m_cost(0)
+  {
+    // number of source words, for longest-first scheduling
+    const params_t params = m_paramList.getStruct(0);
+    params_t::const_iterator si = params.find("text");
+    if (si != params.end()) {
+      const string source((xmlrpc_c::value_string(si->second)));
+      m_cost = std::count(source.begin(), source.end(), ' ') + 1;
+    }
+  }
 
   virtual bool DeleteAfterExecution() {return false;}
 
+  virtual size_t GetCost() const {return m_cost;}
+
   bool IsDone() const {return m_done;}
 
   const map<string, xmlrpc_c::value>& GetRetData() { return m_retData;}
@@ -248,6 +259,8 @@ public:
 
     si = params.find("add-score-breakdown");
     bool addScoreBreakdown = (si != params.end());
+    si = params.find("threads-per-sentence");
+    int threadsPerSentence = (si == params.end()) ? 0 : int(xmlrpc_c::value_int(si->second));
 
     vector<float> multiModelWeights;
     si = params.find("lambda");
@@ -283,6 +296,9 @@ public:
         stringstream in(source + "\n");
         tinput.Read(in,inputFactorOrder);
         ChartManager manager(tinput);
+        if (threadsPerSentence > 0) {
+          manager.SetThreadsPerSentence(threadsPerSentence);
+        }
         manager.Decode();
         const ChartHypothesis *hypo = manager.GetBestHypothesis();
         outputChartHypo(out,hypo);
@@ -302,6 +318,9 @@ public:
         stringstream in(source + "\n");
         sentence.Read(in,inputFactorOrder);
         Manager manager(sentence);
+        if (threadsPerSentence > 0) {
+          manager.SetThreadsPerSentence(threadsPerSentence);
+        }
 	      manager.Decode();
         const Hypothesis* hypo = manager.GetBestHypothesis();
 
@@ -525,7 +544,7 @@ public:
           toptXml["start"] =  xmlrpc_c::value_int(startPos);
           toptXml["end"] =  xmlrpc_c::value_int(endPos);
           vector<xmlrpc_c::value> scoresXml;
-          const std::valarray<FValue> &scores = topt->GetScoreBreakdown().getCoreFeatures();
+          const FDenseVector &scores = topt->GetScoreBreakdown().getCoreFeatures();
           for (size_t j = 0; j < scores.size(); ++j) {
             scoresXml.push_back(xmlrpc_c::value_double(scores[j]));
           }
@@ -544,12 +563,14 @@ private:
   boost::condition_variable& m_cond;
   boost::mutex& m_mut;
   bool m_done;
+  size_t m_cost;
 };
 
 class Translator : public xmlrpc_c::method
 {
 public:
   Translator(size_t numThreads = 10) : m_threadPool(numThreads) {
+    m_threadPool.SetLongestFirst(StaticData::Instance().ThreadsLongestFirst());
     // signature and help strings are documentation -- the client
     // can query this information with a system.methodSignature and
     // system.methodHelp RPC.
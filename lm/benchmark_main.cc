@@ -0,0 +1,177 @@
+#include "lm/model.hh"
+#include "util/file_piece.hh"
+#include "util/getopt.hh"
+#include "util/usage.hh"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+void Usage(const char *name) {
+  std::cerr <<
+    "Usage: " << name << " [-r repetitions] [-l lazy|populate|read|parallel|huge|interleave] lm_file... <text\n"
+    "Times FullScore over the text for each model, so the data structures written\n"
+    "by build_binary can be compared on the same queries.  Models should be built\n"
+    "from the same ARPA.  Words are mapped to vocabulary ids before timing.\n"
+    "-r: Score the text this many times per model.  Default 5.\n"
+    "-l: How to load the models, as in query.\n";
+  exit(1);
+}
+
+typedef std::vector<std::vector<std::string> > Text;
+
+void ReadText(Text &text) {
+  util::FilePiece in(0);
+  StringPiece word;
+  while (true) {
+    text.resize(text.size() + 1);
+    while (in.ReadWordSameLine(word)) {
+      text.back().push_back(word.as_string());
+    }
+    try {
+      UTIL_THROW_IF('\n' != in.get(), util::Exception, "FilePiece is confused.");
+    } catch (const util::EndOfFileException &e) {
+      if (text.back().empty()) text.pop_back();
+      break;
+    }
+  }
+}
+
+template <class Model> void Benchmark(const char *file, const lm::ngram::Config &config, const Text &text, unsigned int repetitions) {
+  double start = util::WallTime();
+  Model model(file, config);
+  double loaded = util::WallTime();
+
+  // Each sentence ends with </s>.
+  std::vector<std::vector<lm::WordIndex> > ids(text.size());
+  uint64_t queries = 0;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    for (std::vector<std::string>::const_iterator w = text[i].begin(); w != text[i].end(); ++w) {
+      ids[i].push_back(model.GetVocabulary().Index(*w));
+    }
+    ids[i].push_back(model.GetVocabulary().EndSentence());
+    queries += ids[i].size();
+  }
+
+  // The first pass is not timed: it takes the page faults of lazy loading.
+  double total = 0.0, begin_scoring = 0.0;
+  for (unsigned int r = 0; r <= repetitions; ++r) {
+    if (r == 1) {
+      total = 0.0;
+      begin_scoring = util::WallTime();
+    }
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+      typename Model::State state = model.BeginSentenceState(), out;
+      for (std::vector<lm::WordIndex>::const_iterator w = ids[i].begin(); w != ids[i].end(); ++w) {
+        total += model.FullScore(state, *w, out).prob;
+        state = out;
+      }
+    }
+  }
+  double elapsed = util::WallTime() - begin_scoring;
+  queries *= repetitions;
+
+  std::cout << file << '\t' << lm::ngram::kModelNames[Model::kModelType] << '\t'
+    << "load " << (loaded - start) << " s\t"
+    << queries << " queries\t"
+    << std::setprecision(4) << (queries ? elapsed * 1e9 / static_cast<double>(queries) : 0.0) << " ns/query\t"
+    // Printed so the scoring isn't optimized out, and as a check that the models agree.
+    << "total " << std::setprecision(10) << (total / repetitions) << std::endl;
+}
+
+void Dispatch(const char *file, const lm::ngram::Config &config, const Text &text, unsigned int repetitions) {
+  using namespace lm::ngram;
+  ModelType model_type;
+  if (!RecognizeBinary(file, model_type)) model_type = PROBING;
+  switch (model_type) {
+    case PROBING:
+      Benchmark<ProbingModel>(file, config, text, repetitions);
+      break;
+    case REST_PROBING:
+      Benchmark<RestProbingModel>(file, config, text, repetitions);
+      break;
+    case TRIE:
+      Benchmark<TrieModel>(file, config, text, repetitions);
+      break;
+    case QUANT_TRIE:
+      Benchmark<QuantTrieModel>(file, config, text, repetitions);
+      break;
+    case ARRAY_TRIE:
+      Benchmark<ArrayTrieModel>(file, config, text, repetitions);
+      break;
+    case QUANT_ARRAY_TRIE:
+      Benchmark<QuantArrayTrieModel>(file, config, text, repetitions);
+      break;
+    case BUCKET_PROBING:
+      Benchmark<BucketProbingModel>(file, config, text, repetitions);
+      break;
+    case REST_BUCKET_PROBING:
+      Benchmark<RestBucketProbingModel>(file, config, text, repetitions);
+      break;
+    default:
+      std::cerr << "Unrecognized kenlm model type " << model_type << std::endl;
+      abort();
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc == 1 || (argc == 2 && !strcmp(argv[1], "--help")))
+    Usage(argv[0]);
+
+  lm::ngram::Config config;
+  config.messages = NULL;
+  unsigned int repetitions = 5;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "hr:l:")) != -1) {
+    switch (opt) {
+      case 'r':
+        repetitions = atoi(optarg);
+        if (!repetitions) Usage(argv[0]);
+        break;
+      case 'l':
+        if (!strcmp(optarg, "lazy")) {
+          config.load_method = util::LAZY;
+        } else if (!strcmp(optarg, "populate")) {
+          config.load_method = util::POPULATE_OR_READ;
+        } else if (!strcmp(optarg, "read")) {
+          config.load_method = util::READ;
+        } else if (!strcmp(optarg, "parallel")) {
+          config.load_method = util::PARALLEL_READ;
+        } else if (!strcmp(optarg, "huge")) {
+          config.load_method = util::HUGE_READ;
+        } else if (!strcmp(optarg, "interleave")) {
+          config.load_method = util::NUMA_INTERLEAVE_READ;
+        } else {
+          Usage(argv[0]);
+        }
+        break;
+      case 'h':
+      default:
+        Usage(argv[0]);
+    }
+  }
+  if (optind == argc)
+    Usage(argv[0]);
+  try {
+    Text text;
+    ReadText(text);
+    for (int i = optind; i < argc; ++i) {
+      Dispatch(argv[i], config, text, repetitions);
+    }
+    util::PrintUsage(std::cerr);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
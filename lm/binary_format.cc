@@ -15,7 +15,7 @@
 namespace lm {
 namespace ngram {
 
-const char *kModelNames[6] = {"probing hash tables", "probing hash tables with rest costs", "trie", "trie with quantization", "trie with array-compressed pointers", "trie with quantization and array-compressed pointers"};
+const char *kModelNames[8] = {"probing hash tables", "probing hash tables with rest costs", "trie", "trie with quantization", "trie with array-compressed pointers", "trie with quantization and array-compressed pointers", "bucketed probing hash tables", "bucketed probing hash tables with rest costs"};
 
 namespace {
 const char kMagicBeforeVersion[] = "mmap lm http://kheafield.com/code format version";
@@ -61,10 +61,6 @@ struct Sanity {
   }
 };
 
-std::size_t TotalHeaderSize(unsigned char order) {
-  return ALIGN8(sizeof(Sanity) + sizeof(FixedWidthParameters) + sizeof(uint64_t) * order);
-}
-
 void WriteHeader(void *to, const Parameters &params) {
   Sanity header = Sanity();
   header.SetToReference();
@@ -82,6 +78,10 @@ void WriteHeader(void *to, const Parameters &params) {
 
 } // namespace
 
+std::size_t TotalHeaderSize(unsigned char order) {
+  return ALIGN8(sizeof(Sanity) + sizeof(FixedWidthParameters) + sizeof(uint64_t) * order);
+}
+
 bool IsBinaryFormat(int fd) {
   const uint64_t size = util::SizeFile(fd);
   if (size == util::kBadSize || (size <= static_cast<uint64_t>(sizeof(Sanity)))) return false;
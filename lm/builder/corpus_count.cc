@@ -228,22 +228,7 @@ void CorpusCount::Run(const util::stream::ChainPosition &position) {
   // Create list of unigrams that are supposed to be pruned
   if (!prune_vocab_filename_.empty()) {
     try {
-      util::FilePiece prune_vocab_file(prune_vocab_filename_.c_str());
-      
-      prune_words_.resize(vocab.Size(), true);
-      try {
-        while (true) {
-          StringPiece line(prune_vocab_file.ReadLine());
-          for (util::TokenIter<util::BoolCharacter, true> w(line, delimiters); w; ++w)
-            prune_words_[vocab.Index(*w)] = false;
-        }
-      } catch (const util::EndOfFileException &e) {}
-      
-      // Never prune <unk>, <s>, </s>
-      prune_words_[kUNK] = false;
-      prune_words_[kBOS] = false;
-      prune_words_[kEOS] = false;
-      
+      MarkPrunedWords(vocab, prune_vocab_filename_, prune_words_);
     } catch (const util::Exception &e) {
       std::cerr << e.what() << std::endl;
       abort();
@@ -251,5 +236,25 @@ void CorpusCount::Run(const util::stream::ChainPosition &position) {
   }
 }
 
+void MarkPrunedWords(const ngram::GrowableVocab<ngram::WriteUniqueWords> &vocab, const std::string &prune_vocab_filename, std::vector<bool> &prune_words) {
+  bool delimiters[256];
+  util::BoolCharacter::Build("\0\t\n\r ", delimiters);
+  util::FilePiece prune_vocab_file(prune_vocab_filename.c_str());
+
+  prune_words.resize(vocab.Size(), true);
+  try {
+    while (true) {
+      StringPiece line(prune_vocab_file.ReadLine());
+      for (util::TokenIter<util::BoolCharacter, true> w(line, delimiters); w; ++w)
+        prune_words[vocab.Index(*w)] = false;
+    }
+  } catch (const util::EndOfFileException &e) {}
+
+  // Never prune <unk>, <s>, </s>
+  prune_words[kUNK] = false;
+  prune_words[kBOS] = false;
+  prune_words[kEOS] = false;
+}
+
 } // namespace builder
 } // namespace lm
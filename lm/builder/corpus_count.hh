@@ -18,6 +18,11 @@ class ChainPosition;
 } // namespace util
 
 namespace lm {
+namespace ngram {
+class WriteUniqueWords;
+template <class NewWordAction> class GrowableVocab;
+} // namespace ngram
+
 namespace builder {
 
 class CorpusCount {
@@ -48,6 +53,11 @@ class CorpusCount {
     WarningAction disallowed_symbol_action_;
 };
 
+// Words not listed in the whitespace-delimited prune_vocab_filename are marked
+// true in prune_words, which is indexed by vocab id.  <unk>, <s>, and </s> are
+// never pruned.
+void MarkPrunedWords(const ngram::GrowableVocab<ngram::WriteUniqueWords> &vocab, const std::string &prune_vocab_filename, std::vector<bool> &prune_words);
+
 } // namespace builder
 } // namespace lm
 #endif // LM_BUILDER_CORPUS_COUNT_H
@@ -1,6 +1,7 @@
 #include "lm/builder/output.hh"
 #include "lm/builder/pipeline.hh"
 #include "lm/builder/print.hh"
+#include "lm/builder/write_binary.hh"
 #include "lm/lm_exception.hh"
 #include "util/file.hh"
 #include "util/file_piece.hh"
@@ -79,6 +80,8 @@ lm::builder::Discount ParseDiscountFallback(const std::vector<std::string> &para
   return ret;
 }
 
+const char *const kBitOptions[] = {"quantize_prob", "quantize_backoff", "bhiksha"};
+
 } // namespace
 
 int main(int argc, char *argv[]) {
@@ -87,7 +90,10 @@ int main(int argc, char *argv[]) {
     po::options_description options("Language model building options");
     lm::builder::PipelineConfig pipeline;
 
-    std::string text, arpa;
+    std::string text, arpa, shard_out, binary, binary_type;
+    lm::ngram::Config binary_config;
+    unsigned int quantize_prob, quantize_backoff, bhiksha;
+    std::vector<std::string> merge_shards;
     std::vector<std::string> pruning;
     std::vector<std::string> discount_fallback;
     std::vector<std::string> discount_fallback_default;
@@ -116,6 +122,14 @@ int main(int argc, char *argv[]) {
       ("verbose_header", po::bool_switch(&verbose_header), "Add a verbose header to the ARPA file that includes information such as token count, smoothing type, etc.")
       ("text", po::value<std::string>(&text), "Read text from a file instead of stdin")
       ("arpa", po::value<std::string>(&arpa), "Write ARPA to a file instead of stdout")
+      ("binary", po::value<std::string>(&binary), "Write a KenLM binary file directly, as build_binary would from the ARPA.  The ARPA is only written if --arpa is also given.")
+      ("binary_type", po::value<std::string>(&binary_type)->default_value("probing"), "Data structure for --binary: probing, bucket, or trie")
+      ("quantize_prob", po::value<unsigned int>(&quantize_prob), "Quantize probabilities in the --binary trie to this many bits, like build_binary -q")
+      ("quantize_backoff", po::value<unsigned int>(&quantize_backoff), "Quantize backoffs in the --binary trie to this many bits, like build_binary -b.  Defaults to --quantize_prob")
+      ("bhiksha", po::value<unsigned int>(&bhiksha), "Compress --binary trie pointers using at most this many bits, like build_binary -a")
+      ("probing_multiplier", po::value<float>(&binary_config.probing_multiplier)->default_value(1.5), "Hash table size multiplier for a probing --binary, like build_binary -p")
+      ("shard_out", po::value<std::string>(&shard_out), "Only count and sort the text, writing the counts to shard_out.counts and its vocabulary to shard_out.vocab.  Combine shards with --merge_shards.")
+      ("merge_shards", po::value<std::vector<std::string> >(&merge_shards)->multitoken(), "Build the model from shards written by --shard_out instead of text.  List the shards in corpus order and use the same order (-o) that they were counted with.  The model is the same as from the concatenated text.")
       ("collapse_values", po::bool_switch(&pipeline.output_q), "Collapse probability and backoff into a single value, q that yields the same sentence-level probabilities.  See http://kheafield.com/professional/edinburgh/rest_paper.pdf for more details, including a proof.")
       ("prune", po::value<std::vector<std::string> >(&pruning)->multitoken(), "Prune n-grams with count less than or equal to the given threshold.  Specify one value for each order i.e. 0 0 1 to prune singleton trigrams and above.  The sequence of values must be non-decreasing and the last value applies to any remaining orders. Default is to not prune, which is equivalent to --prune 0.")
       ("limit_vocab_file", po::value<std::string>(&pipeline.prune_vocab_file)->default_value(""), "Read allowed vocabulary separated by whitespace. N-grams that contain vocabulary items not in this list will be pruned. Can be combined with --prune arg")
@@ -139,6 +153,9 @@ int main(int argc, char *argv[]) {
         "Provide the corpus on stdin.  The ARPA file will be written to stdout.  Order of\n"
         "the model (-o) is the only mandatory option.  As this is an on-disk program,\n"
         "setting the temporary file location (-T) and sorting memory (-S) is recommended.\n\n"
+        "Large corpora can be split at line boundaries and counted in parallel, for\n"
+        "example on separate machines, with --shard_out.  Then --merge_shards estimates\n"
+        "the model from the shards.\n\n"
         "Memory sizes are specified like GNU sort: a number followed by a unit character.\n"
         "Valid units are \% for percentage of memory (supported platforms only) and (in\n"
         "increasing powers of 1024): b, K, M, G, T, P, E, Z, Y.  Default is K (*1024).\n";
@@ -167,6 +184,50 @@ int main(int argc, char *argv[]) {
       return 1;
     }
 
+    if (vm.count("shard_out") && vm.count("merge_shards")) {
+      std::cerr << "--shard_out counts text and --merge_shards reads shards.  Pick one." << std::endl;
+      return 1;
+    }
+    if (vm.count("merge_shards") && vm.count("text")) {
+      std::cerr << "--merge_shards reads shards instead of text" << std::endl;
+      return 1;
+    }
+
+    lm::ngram::ModelType binary_model_type = lm::ngram::PROBING;
+    if (vm.count("binary")) {
+      for (const char *const *i = kBitOptions; i != kBitOptions + sizeof(kBitOptions) / sizeof(const char*); ++i) {
+        if (vm.count(*i) && vm[*i].as<unsigned int>() > 25) {
+          std::cerr << "--" << *i << " is limited to 25 bits" << std::endl;
+          return 1;
+        }
+      }
+      if (vm.count("quantize_backoff") && !vm.count("quantize_prob")) {
+        std::cerr << "You specified backoff quantization (--quantize_backoff) but not probability quantization (--quantize_prob)" << std::endl;
+        return 1;
+      }
+      if (binary_type == "probing" || binary_type == "bucket") {
+        if (vm.count("quantize_prob") || vm.count("bhiksha")) {
+          std::cerr << "Quantization and pointer compression are only implemented in the trie data structure." << std::endl;
+          return 1;
+        }
+        binary_model_type = (binary_type == "probing") ? lm::ngram::PROBING : lm::ngram::BUCKET_PROBING;
+        binary_config.write_method = lm::ngram::Config::WRITE_AFTER;
+      } else if (binary_type == "trie") {
+        if (vm.count("quantize_prob")) {
+          binary_config.prob_bits = quantize_prob;
+          binary_config.backoff_bits = vm.count("quantize_backoff") ? quantize_backoff : quantize_prob;
+        }
+        if (vm.count("bhiksha")) binary_config.pointer_bhiksha_bits = bhiksha;
+        binary_model_type = vm.count("quantize_prob") ?
+          (vm.count("bhiksha") ? lm::ngram::QUANT_ARRAY_TRIE : lm::ngram::QUANT_TRIE) :
+          (vm.count("bhiksha") ? lm::ngram::ARRAY_TRIE : lm::ngram::TRIE);
+        binary_config.write_method = lm::ngram::Config::WRITE_MMAP;
+      } else {
+        std::cerr << "Unknown --binary_type " << binary_type << ".  Use probing, bucket, or trie." << std::endl;
+        return 1;
+      }
+    }
+
     if (vm["skip_symbols"].as<bool>()) {
       pipeline.disallowed_symbol_action = lm::COMPLAIN;
     } else {
@@ -202,6 +263,11 @@ int main(int argc, char *argv[]) {
     initial.adder_out.block_count = 2;
     pipeline.read_backoffs = initial.adder_out;
 
+    if (vm.count("binary")) {
+      binary_config.temporary_directory_prefix = pipeline.sort.temp_prefix;
+      binary_config.building_memory = pipeline.sort.total_memory;
+    }
+
     util::scoped_fd in(0), out(1);
     if (vm.count("text")) {
       in.reset(util::OpenReadOrThrow(text.c_str()));
@@ -212,9 +278,23 @@ int main(int argc, char *argv[]) {
 
     // Read from stdin
     try {
+      if (vm.count("shard_out")) {
+        lm::builder::CountShard(pipeline, in.release(), shard_out);
+        util::PrintUsage(std::cerr);
+        return 0;
+      }
       lm::builder::Output output;
-      output.Add(new lm::builder::PrintARPA(out.release(), verbose_header));
-      lm::builder::Pipeline(pipeline, in.release(), output);
+      if (vm.count("arpa") || !vm.count("binary")) {
+        output.Add(new lm::builder::PrintARPA(out.release(), verbose_header));
+      }
+      if (vm.count("binary")) {
+        output.Add(new lm::builder::WriteBinary(binary_model_type, binary_config, binary));
+      }
+      if (vm.count("merge_shards")) {
+        lm::builder::MergeShards(pipeline, merge_shards, output);
+      } else {
+        lm::builder::Pipeline(pipeline, in.release(), output);
+      }
     } catch (const util::MallocException &e) {
       std::cerr << e.what() << std::endl;
       std::cerr << "Try rerunning with a more conservative -S setting than " << vm["memory"].as<std::string>() << std::endl;
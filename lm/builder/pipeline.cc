@@ -6,6 +6,7 @@
 #include "lm/builder/initial_probabilities.hh"
 #include "lm/builder/interpolate.hh"
 #include "lm/builder/output.hh"
+#include "lm/builder/shard.hh"
 #include "lm/builder/sort.hh"
 
 #include "lm/sizes.hh"
@@ -14,6 +15,8 @@
 #include "util/file.hh"
 #include "util/stream/io.hh"
 
+#include <boost/scoped_ptr.hpp>
+
 #include <algorithm>
 #include <iostream>
 #include <fstream>
@@ -208,10 +211,9 @@ class Master {
     util::FixedArray<util::stream::FileBuffer> files_;
 };
 
-void CountText(int text_file /* input */, int vocab_file /* output */, Master &master, uint64_t &token_count, std::string &text_file_name, std::vector<bool> &prune_words) {
-  const PipelineConfig &config = master.Config();
-  std::cerr << "=== 1/5 Counting and sorting n-grams ===" << std::endl;
+typedef util::stream::Sort<SuffixOrder, AddCombiner> CountSort;
 
+void CountText(int text_file /* input */, int vocab_file /* output */, const PipelineConfig &config, const std::string &prune_vocab_file, boost::scoped_ptr<CountSort> &sorter, uint64_t &token_count, WordIndex &type_count, std::string &text_file_name, std::vector<bool> &prune_words) {
   const std::size_t vocab_usage = CorpusCount::VocabUsage(config.vocab_estimate);
   UTIL_THROW_IF(config.TotalMemory() < vocab_usage, util::Exception, "Vocab hash size estimate " << vocab_usage << " exceeds total memory " << config.TotalMemory());
   std::size_t memory_for_chain = 
@@ -223,17 +225,15 @@ void CountText(int text_file /* input */, int vocab_file /* output */, Master &m
     static_cast<float>(config.block_count);
   util::stream::Chain chain(util::stream::ChainConfig(NGram::TotalSize(config.order), config.block_count, memory_for_chain));
 
-  WordIndex type_count = config.vocab_estimate;
+  type_count = config.vocab_estimate;
   util::FilePiece text(text_file, NULL, &std::cerr);
   text_file_name = text.FileName();
-  CorpusCount counter(text, vocab_file, token_count, type_count, prune_words, config.prune_vocab_file, chain.BlockSize() / chain.EntrySize(), config.disallowed_symbol_action);
+  CorpusCount counter(text, vocab_file, token_count, type_count, prune_words, prune_vocab_file, chain.BlockSize() / chain.EntrySize(), config.disallowed_symbol_action);
   chain >> boost::ref(counter);
 
-  util::stream::Sort<SuffixOrder, AddCombiner> sorter(chain, config.sort, SuffixOrder(config.order), AddCombiner());
+  sorter.reset(new CountSort(chain, config.sort, SuffixOrder(config.order), AddCombiner()));
   chain.Wait(true);
   std::cerr << "Unigram tokens " << token_count << " types " << type_count << std::endl;
-  std::cerr << "=== 2/5 Calculating and sorting adjusted counts ===" << std::endl;
-  master.InitForAdjust(sorter, type_count);
 }
 
 void InitialProbabilities(const std::vector<uint64_t> &counts, const std::vector<uint64_t> &counts_pruned, const std::vector<Discount> &discounts, Master &master, Sorts<SuffixOrder> &primary,
@@ -285,9 +285,7 @@ void InterpolateProbabilities(const std::vector<uint64_t> &counts, Master &maste
   master.BufferFinal(counts);
 }
 
-} // namespace
-
-void Pipeline(PipelineConfig &config, int text_file, Output &output) {
+void CheckConfig(PipelineConfig &config) {
   // Some fail-fast sanity checks.
   if (config.sort.buffer_size * 4 > config.TotalMemory()) {
     config.sort.buffer_size = config.TotalMemory() / 4;
@@ -300,6 +298,44 @@ void Pipeline(PipelineConfig &config, int text_file, Output &output) {
   UTIL_THROW_IF(config.sort.buffer_size < config.minimum_block, util::Exception, "Sort block size " << config.sort.buffer_size << " is below the minimum block size " << config.minimum_block << ".");
   UTIL_THROW_IF(config.TotalMemory() < config.minimum_block * config.order * config.block_count, util::Exception,
       "Not enough memory to fit " << (config.order * config.block_count) << " blocks with minimum size " << config.minimum_block << ".  Increase memory to " << (config.minimum_block * config.order * config.block_count) << " bytes or decrease the minimum block size.");
+}
+
+int OpenVocab(const PipelineConfig &config) {
+  return config.vocab_file.empty() ?
+    util::MakeTemp(config.TempPrefix()) :
+    util::CreateOrThrow(config.vocab_file.c_str());
+}
+
+// Everything after counting: from the sorted counts to the model.
+void Estimate(Master &master, CountSort &sorter, WordIndex type_count, const std::string &text_file_name, uint64_t token_count, std::vector<bool> &prune_words, Output &output) {
+  const PipelineConfig &config = master.Config();
+  std::cerr << "=== 2/5 Calculating and sorting adjusted counts ===" << std::endl;
+  master.InitForAdjust(sorter, type_count);
+
+  std::vector<uint64_t> counts;
+  std::vector<uint64_t> counts_pruned;
+  std::vector<Discount> discounts;
+  master >> AdjustCounts(config.prune_thresholds, counts, counts_pruned, prune_words, config.discount, discounts);
+
+  {
+    util::FixedArray<util::stream::FileBuffer> gammas;
+    Sorts<SuffixOrder> primary;
+    InitialProbabilities(counts, counts_pruned, discounts, master, primary, gammas, config.prune_thresholds, config.prune_vocab);
+    InterpolateProbabilities(counts_pruned, master, primary, gammas);
+  }
+
+  std::cerr << "=== 5/5 Writing ARPA model ===" << std::endl;
+
+  output.SetHeader(HeaderInfo(text_file_name, token_count, counts_pruned));
+  output.Apply(PROB_SEQUENTIAL_HOOK, master.MutableChains());
+  master >> util::stream::kRecycle;
+  master.MutableChains().Wait(true);
+}
+
+} // namespace
+
+void Pipeline(PipelineConfig &config, int text_file, Output &output) {
+  CheckConfig(config);
 
   UTIL_TIMER("(%w s) Total wall time elapsed\n");
 
@@ -307,34 +343,76 @@ void Pipeline(PipelineConfig &config, int text_file, Output &output) {
   // master's destructor will wait for chains.  But they might be deadlocked if
   // this thread dies because e.g. it ran out of memory.
   try {
-    util::scoped_fd vocab_file(config.vocab_file.empty() ? 
-        util::MakeTemp(config.TempPrefix()) : 
-        util::CreateOrThrow(config.vocab_file.c_str()));
+    util::scoped_fd vocab_file(OpenVocab(config));
     output.SetVocabFD(vocab_file.get());
     uint64_t token_count;
+    WordIndex type_count;
     std::string text_file_name;
     
     std::vector<bool> prune_words;
-    CountText(text_file, vocab_file.get(), master, token_count, text_file_name, prune_words);
-    
-    std::vector<uint64_t> counts;
-    std::vector<uint64_t> counts_pruned;
-    std::vector<Discount> discounts;
-    master >> AdjustCounts(config.prune_thresholds, counts, counts_pruned, prune_words, config.discount, discounts);
-
-    {
-      util::FixedArray<util::stream::FileBuffer> gammas;
-      Sorts<SuffixOrder> primary;
-      InitialProbabilities(counts, counts_pruned, discounts, master, primary, gammas, config.prune_thresholds, config.prune_vocab);
-      InterpolateProbabilities(counts_pruned, master, primary, gammas);
-    }
+    std::cerr << "=== 1/5 Counting and sorting n-grams ===" << std::endl;
+    boost::scoped_ptr<CountSort> sorter;
+    CountText(text_file, vocab_file.get(), config, config.prune_vocab_file, sorter, token_count, type_count, text_file_name, prune_words);
+    Estimate(master, *sorter, type_count, text_file_name, token_count, prune_words, output);
+  } catch (const util::Exception &e) {
+    std::cerr << e.what() << std::endl;
+    abort();
+  }
+}
+
+void CountShard(PipelineConfig &config, int text_file, const std::string &shard) {
+  CheckConfig(config);
+
+  UTIL_TIMER("(%w s) Total wall time elapsed\n");
+
+  try {
+    util::scoped_fd vocab_file(util::CreateOrThrow((shard + ".vocab").c_str()));
+    util::scoped_fd counts_file(util::CreateOrThrow((shard + ".counts").c_str()));
+    uint64_t token_count;
+    WordIndex type_count;
+    std::string text_file_name;
+    // Vocabulary pruning needs the merged vocabulary so it happens in MergeShards.
+    std::vector<bool> prune_words;
+    std::cerr << "=== 1/1 Counting and sorting n-grams for shard " << shard << " ===" << std::endl;
+    boost::scoped_ptr<CountSort> sorter;
+    CountText(text_file, vocab_file.get(), config, "", sorter, token_count, type_count, text_file_name, prune_words);
+
+    const std::size_t lazy = sorter->DefaultLazy();
+    util::stream::Chain chain(util::stream::ChainConfig(NGram::TotalSize(config.order), config.block_count, config.TotalMemory() - lazy));
+    sorter->Output(chain, lazy);
+    chain >> util::stream::WriteAndRecycle(counts_file.get());
+    chain.Wait(true);
+  } catch (const util::Exception &e) {
+    std::cerr << e.what() << std::endl;
+    abort();
+  }
+}
+
+void MergeShards(PipelineConfig &config, const std::vector<std::string> &shards, Output &output) {
+  CheckConfig(config);
 
-    std::cerr << "=== 5/5 Writing ARPA model ===" << std::endl;
+  UTIL_TIMER("(%w s) Total wall time elapsed\n");
+
+  Master master(config);
+  try {
+    util::scoped_fd vocab_file(OpenVocab(config));
+    output.SetVocabFD(vocab_file.get());
+    std::vector<bool> prune_words;
+    std::cerr << "=== 1/5 Merging and sorting n-grams from " << shards.size() << " shards ===" << std::endl;
+    ShardMerge merge(shards, vocab_file.get(), config.vocab_estimate, prune_words, config.prune_vocab_file);
+    std::string shard_names;
+    for (std::vector<std::string>::const_iterator i = shards.begin(); i != shards.end(); ++i) {
+      if (i != shards.begin()) shard_names += ' ';
+      shard_names += *i;
+    }
 
-    output.SetHeader(HeaderInfo(text_file_name, token_count, counts_pruned));
-    output.Apply(PROB_SEQUENTIAL_HOOK, master.MutableChains());
-    master >> util::stream::kRecycle;
-    master.MutableChains().Wait(true);
+    // The id maps are small compared to the n-grams, so the chain gets all the memory.
+    util::stream::Chain chain(util::stream::ChainConfig(NGram::TotalSize(config.order), config.block_count, config.TotalMemory()));
+    chain >> boost::ref(merge);
+    CountSort sorter(chain, config.sort, SuffixOrder(config.order), AddCombiner());
+    chain.Wait(true);
+    std::cerr << "Unigram tokens " << merge.Tokens() << " types " << merge.Types() << std::endl;
+    Estimate(master, sorter, merge.Types(), shard_names, merge.Tokens(), prune_words, output);
   } catch (const util::Exception &e) {
     std::cerr << e.what() << std::endl;
     abort();
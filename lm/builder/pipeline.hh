@@ -10,6 +10,7 @@
 #include "util/file_piece.hh"
 
 #include <string>
+#include <vector>
 #include <cstddef>
 
 namespace lm { namespace builder {
@@ -70,5 +71,19 @@ struct PipelineConfig {
 // Takes ownership of text_file and out_arpa.
 void Pipeline(PipelineConfig &config, int text_file, Output &output);
 
+/* Sharded estimation.  Split the corpus at line boundaries and count each
+ * piece with CountShard, possibly on different machines, then MergeShards with
+ * the shards in corpus order.  The model is identical to running Pipeline on
+ * the whole corpus.  Pruning options apply only to MergeShards.  See shard.hh
+ * for the file format.
+ */
+
+// Count and sort the n-grams of text_file, writing shard.vocab and
+// shard.counts.  Takes ownership of text_file.
+void CountShard(PipelineConfig &config, int text_file, const std::string &shard);
+
+// Like Pipeline, but from the counts of shards instead of text.
+void MergeShards(PipelineConfig &config, const std::vector<std::string> &shards, Output &output);
+
 }} // namespaces
 #endif // LM_BUILDER_PIPELINE_H
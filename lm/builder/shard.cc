@@ -0,0 +1,66 @@
+#include "lm/builder/shard.hh"
+
+#include "lm/builder/corpus_count.hh"
+#include "lm/builder/ngram.hh"
+#include "lm/builder/print.hh"
+#include "lm/vocab.hh"
+#include "util/exception.hh"
+#include "util/file.hh"
+#include "util/read_compressed.hh"
+#include "util/stream/chain.hh"
+
+namespace lm {
+namespace builder {
+
+ShardMerge::ShardMerge(const std::vector<std::string> &shards, int vocab_write, WordIndex vocab_estimate, std::vector<bool> &prune_words, const std::string &prune_vocab_filename)
+  : shards_(shards), ids_(shards.size()), type_count_(0), token_count_(0) {
+  ngram::GrowableVocab<ngram::WriteUniqueWords> vocab(vocab_estimate, vocab_write);
+  for (std::size_t s = 0; s < shards_.size(); ++s) {
+    util::scoped_fd vocab_file(util::OpenReadOrThrow((shards_[s] + ".vocab").c_str()));
+    VocabReconstitute words(vocab_file.get());
+    std::vector<WordIndex> &ids = ids_[s];
+    ids.reserve(words.Size());
+    for (WordIndex i = 0; i < words.Size(); ++i) {
+      ids.push_back(vocab.FindOrInsert(words.LookupPiece(i)));
+    }
+    UTIL_THROW_IF(ids.size() <= kEOS || ids[kUNK] != kUNK || ids[kBOS] != kBOS || ids[kEOS] != kEOS, util::Exception, "Shard vocabulary " << shards_[s] << ".vocab should begin with <unk>, <s>, and </s>.");
+  }
+  type_count_ = vocab.Size();
+  if (!prune_vocab_filename.empty()) {
+    MarkPrunedWords(vocab, prune_vocab_filename, prune_words);
+  }
+}
+
+void ShardMerge::Run(const util::stream::ChainPosition &position) {
+  const std::size_t entry_size = position.GetChain().EntrySize();
+  const std::size_t block_size = position.GetChain().BlockSize();
+  const std::size_t order = NGram::OrderFromSize(entry_size);
+  uint64_t total = 0, sentences = 0;
+  util::stream::Link block(position);
+  for (std::size_t s = 0; s < shards_.size(); ++s) {
+    const std::vector<WordIndex> &ids = ids_[s];
+    util::ReadCompressed counts(util::OpenReadOrThrow((shards_[s] + ".counts").c_str()));
+    while (true) {
+      std::size_t got = counts.ReadOrEOF(block->Get(), block_size);
+      if (!got) break;
+      UTIL_THROW_IF(got % entry_size, util::Exception, "Shard counts " << shards_[s] << ".counts ended with " << (got % entry_size) << " bytes, which is not a complete record of length " << entry_size << ".  Did the shard use a different order?");
+      for (NGram gram(block->Get(), order); gram.Base() != static_cast<uint8_t*>(block->Get()) + got; gram.NextInMemory()) {
+        for (WordIndex *i = gram.begin(); i != gram.end(); ++i) {
+          UTIL_THROW_IF(*i >= ids.size(), util::Exception, "Vocab ID " << *i << " in " << shards_[s] << ".counts is larger than the shard's vocabulary size " << ids.size() << ".  Did the shard use a different order?");
+          *i = ids[*i];
+        }
+        total += gram.Count();
+        if (*(gram.end() - 1) == kEOS) sentences += gram.Count();
+      }
+      block->SetValidSize(got);
+      ++block;
+      if (got != block_size) break;
+    }
+  }
+  // Every line contributes one </s> n-gram and every token one n-gram.
+  token_count_ = total - sentences;
+  block.Poison();
+}
+
+} // namespace builder
+} // namespace lm
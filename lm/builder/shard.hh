@@ -0,0 +1,57 @@
+#ifndef LM_BUILDER_SHARD_H
+#define LM_BUILDER_SHARD_H
+
+#include "lm/word_index.hh"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace util { namespace stream { class ChainPosition; } }
+
+namespace lm {
+namespace builder {
+
+/* A shard is the counted and sorted n-grams of a contiguous piece of the
+ * corpus, as written by lmplz --shard_out.  The shard PREFIX consists of
+ *   PREFIX.vocab  Words delimited by null bytes in order of the shard's ids.
+ *   PREFIX.counts N-gram records (ids followed by a uint64_t count) in suffix
+ *                 order.  This is the format read by dump_counts.
+ * CorpusCount assigns ids in order of first appearance.  Merging the shard
+ * vocabularies in corpus order therefore assigns the same ids as counting the
+ * whole corpus at once and, since n-grams do not cross lines, the summed
+ * counts are the same too.  So the model estimated from merged shards is
+ * identical.
+ */
+class ShardMerge {
+  public:
+    // Merges the shard vocabularies in the order given, writing the merged
+    // vocabulary to vocab_write.  If prune_vocab_filename is non-empty, marks
+    // prune_words like CorpusCount does.
+    ShardMerge(const std::vector<std::string> &shards, int vocab_write, WordIndex vocab_estimate, std::vector<bool> &prune_words, const std::string &prune_vocab_filename);
+
+    // Size of the merged vocabulary.
+    WordIndex Types() const { return type_count_; }
+
+    // Valid after Run.  Counts tokens like CorpusCount: </s> is not a token.
+    uint64_t Tokens() const { return token_count_; }
+
+    // Writes the n-grams of all shards with merged ids.  Each block holds
+    // n-grams from only one shard so that blocks have no duplicates.  Feed
+    // this to a Sort with AddCombiner.
+    void Run(const util::stream::ChainPosition &position);
+
+  private:
+    std::vector<std::string> shards_;
+
+    // Shard id to merged id for each shard.
+    std::vector<std::vector<WordIndex> > ids_;
+
+    WordIndex type_count_;
+
+    uint64_t token_count_;
+};
+
+} // namespace builder
+} // namespace lm
+#endif // LM_BUILDER_SHARD_H
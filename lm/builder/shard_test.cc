@@ -0,0 +1,94 @@
+#include "lm/builder/shard.hh"
+
+#include "lm/builder/ngram.hh"
+#include "lm/builder/ngram_stream.hh"
+#include "lm/builder/print.hh"
+#include "util/file.hh"
+#include "util/stream/chain.hh"
+#include "util/stream/stream.hh"
+
+#define BOOST_TEST_MODULE ShardTest
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace lm { namespace builder { namespace {
+
+struct Gram2 {
+  WordIndex ids[2];
+  uint64_t count;
+};
+
+void WriteShard(const std::string &name, const char *vocab, std::size_t vocab_size, const Gram2 *grams, std::size_t gram_count) {
+  util::scoped_fd vocab_file(util::CreateOrThrow((name + ".vocab").c_str()));
+  util::WriteOrThrow(vocab_file.get(), vocab, vocab_size);
+  util::scoped_fd counts_file(util::CreateOrThrow((name + ".counts").c_str()));
+  for (std::size_t i = 0; i < gram_count; ++i) {
+    util::WriteOrThrow(counts_file.get(), grams[i].ids, sizeof(grams[i].ids));
+    util::WriteOrThrow(counts_file.get(), &grams[i].count, sizeof(uint64_t));
+  }
+}
+
+#define Check(first, second, count) { \
+  BOOST_REQUIRE(stream); \
+  BOOST_CHECK_EQUAL(first, vocab.Lookup(stream->begin()[0])); \
+  BOOST_CHECK_EQUAL(second, vocab.Lookup(stream->begin()[1])); \
+  BOOST_CHECK_EQUAL((uint64_t)count, stream->Count()); \
+  ++stream; \
+}
+
+BOOST_AUTO_TEST_CASE(Merge) {
+  std::vector<std::string> shards;
+  shards.push_back("shard_test_temp0");
+  shards.push_back("shard_test_temp1");
+
+  // Text "a b"
+  const char vocab0[] = "<unk>\0<s>\0</s>\0a\0b\0";
+  const Gram2 grams0[] = {{{1,3},1}, {{3,4},1}, {{4,2},1}};
+  WriteShard(shards[0], vocab0, sizeof(vocab0) - 1, grams0, 3);
+  // Text "b c\nb"
+  const char vocab1[] = "<unk>\0<s>\0</s>\0b\0c\0";
+  const Gram2 grams1[] = {{{1,3},2}, {{3,4},1}, {{4,2},1}, {{3,2},1}};
+  WriteShard(shards[1], vocab1, sizeof(vocab1) - 1, grams1, 4);
+
+  util::scoped_fd vocab_file(util::MakeTemp("shard_test_vocab"));
+  std::vector<bool> prune_words;
+  ShardMerge merge(shards, vocab_file.get(), 10, prune_words, "");
+  BOOST_CHECK_EQUAL(6, merge.Types());
+  BOOST_CHECK(prune_words.empty());
+
+  util::stream::ChainConfig config;
+  config.entry_size = NGram::TotalSize(2);
+  config.total_memory = config.entry_size * 4;
+  config.block_count = 2;
+  util::stream::Chain chain(config);
+  NGramStream stream;
+  chain >> boost::ref(merge) >> stream >> util::stream::kRecycle;
+
+  VocabReconstitute vocab(vocab_file.get());
+  BOOST_REQUIRE_EQUAL(6, vocab.Size());
+  BOOST_CHECK_EQUAL("a", vocab.Lookup(3));
+  BOOST_CHECK_EQUAL("c", vocab.Lookup(5));
+
+  // Ids are merged but order within each shard is kept.
+  Check("<s>", "a", 1);
+  Check("a", "b", 1);
+  Check("b", "</s>", 1);
+  Check("<s>", "b", 2);
+  Check("b", "c", 1);
+  Check("c", "</s>", 1);
+  Check("b", "</s>", 1);
+  BOOST_CHECK(!stream);
+  chain.Wait();
+  BOOST_CHECK_EQUAL(5, merge.Tokens());
+
+  for (std::vector<std::string>::const_iterator i = shards.begin(); i != shards.end(); ++i) {
+    unlink((*i + ".vocab").c_str());
+    unlink((*i + ".counts").c_str());
+  }
+}
+
+}}} // namespaces
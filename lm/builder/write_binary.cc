@@ -0,0 +1,100 @@
+#include "lm/builder/write_binary.hh"
+
+#include "lm/builder/ngram_stream.hh"
+#include "lm/builder/print.hh"
+#include "lm/model.hh"
+#include "lm/ngram_source.hh"
+#include "util/exception.hh"
+#include "util/stream/multi_stream.hh"
+
+#include <boost/scoped_ptr.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace lm { namespace builder {
+namespace {
+
+// Hands the model builder one order at a time, just like PrintARPA reads.
+class ChainSource : public NGramSource {
+  public:
+    ChainSource(const VocabReconstitute &vocab, const util::stream::ChainPositions &positions, const std::vector<uint64_t> &counts)
+      : vocab_(vocab), positions_(positions), counts_(counts), order_(0), words_(counts.size()) {}
+
+    void ReadCounts(std::vector<uint64_t> &counts) {
+      counts = counts_;
+    }
+
+    void BeginOrder(unsigned char order) {
+      UTIL_THROW_IF(order != order_ + 1 || order > positions_.size(), util::Exception, "Reading order " << static_cast<unsigned int>(order) << " after " << static_cast<unsigned int>(order_));
+      CheckFinished();
+      order_ = order;
+      stream_.reset(new NGramStream(positions_[order_ - 1]));
+    }
+
+    const WordIndex *Read(float &prob, float &backoff) {
+      NGramStream &stream = *stream_;
+      UTIL_THROW_IF(!stream, util::Exception, "Ran out of " << static_cast<unsigned int>(order_) << "-grams");
+      prob = stream->Value().complete.prob;
+      backoff = stream->Value().complete.backoff;
+      std::copy(stream->begin(), stream->end(), words_.begin());
+      // Advance now so that the last block goes back to the chain.
+      ++stream;
+      return &words_[0];
+    }
+
+    StringPiece Word(WordIndex id) const {
+      return vocab_.LookupPiece(id);
+    }
+
+    // Make sure every order was consumed, otherwise the chains would stall.
+    void CheckFinished() {
+      if (order_) UTIL_THROW_IF(*stream_, util::Exception, "The model did not read all of the " << static_cast<unsigned int>(order_) << "-grams");
+    }
+
+    unsigned char Order() const { return order_; }
+
+  private:
+    const VocabReconstitute &vocab_;
+    const util::stream::ChainPositions &positions_;
+    const std::vector<uint64_t> &counts_;
+
+    unsigned char order_;
+    // Streams can't be reinitialized, so there's a new one for each order.
+    boost::scoped_ptr<NGramStream> stream_;
+    std::vector<WordIndex> words_;
+};
+
+} // namespace
+
+void WriteBinary::Run(const util::stream::ChainPositions &positions) {
+  using namespace ngram;
+  VocabReconstitute vocab(GetVocabFD());
+  ChainSource source(vocab, positions, GetHeader().counts_pruned);
+  switch (model_type_) {
+    case PROBING:
+      ProbingModel(source, config_);
+      break;
+    case BUCKET_PROBING:
+      BucketProbingModel(source, config_);
+      break;
+    case TRIE:
+      TrieModel(source, config_);
+      break;
+    case QUANT_TRIE:
+      QuantTrieModel(source, config_);
+      break;
+    case ARRAY_TRIE:
+      ArrayTrieModel(source, config_);
+      break;
+    case QUANT_ARRAY_TRIE:
+      QuantArrayTrieModel(source, config_);
+      break;
+    default:
+      UTIL_THROW(util::Exception, "Writing " << kModelNames[model_type_] << " directly from lmplz is not supported.");
+  }
+  UTIL_THROW_IF(source.Order() != positions.size(), util::Exception, "The model read " << static_cast<unsigned int>(source.Order()) << " orders of " << positions.size());
+  source.CheckFinished();
+}
+
+}} // namespaces
@@ -0,0 +1,33 @@
+#ifndef LM_BUILDER_WRITE_BINARY_H
+#define LM_BUILDER_WRITE_BINARY_H
+
+#include "lm/builder/output.hh"
+#include "lm/config.hh"
+#include "lm/model_type.hh"
+
+#include <string>
+
+namespace lm { namespace builder {
+
+/* Builds a KenLM binary file straight from the estimated n-grams, instead of
+ * printing ARPA for build_binary to parse.  The file is the same as
+ * build_binary makes from the ARPA with the same config.
+ */
+class WriteBinary : public OutputHook {
+  public:
+    WriteBinary(ngram::ModelType model_type, const ngram::Config &config, const std::string &file)
+      : OutputHook(PROB_SEQUENTIAL_HOOK), model_type_(model_type), config_(config), file_(file) {
+      config_.write_mmap = file_.c_str();
+    }
+
+    void Run(const util::stream::ChainPositions &positions);
+
+  private:
+    const ngram::ModelType model_type_;
+    ngram::Config config_;
+    // Backs config_.write_mmap.
+    const std::string file_;
+};
+
+}} // namespaces
+#endif // LM_BUILDER_WRITE_BINARY_H
@@ -2,6 +2,7 @@
 
 #include "lm/blank.hh"
 #include "lm/lm_exception.hh"
+#include "lm/ngram_source.hh"
 #include "lm/search_hashed.hh"
 #include "lm/search_trie.hh"
 #include "lm/read_arpa.hh"
@@ -76,6 +77,18 @@ template <class Search, class VocabularyT> GenericModel<Search, VocabularyT>::Ge
     InitializeFromARPA(fd.release(), file, init_config);
   }
 
+  InitializeStates();
+}
+
+template <class Search, class VocabularyT> GenericModel<Search, VocabularyT>::GenericModel(NGramSource &source, const Config &config) : backing_(config) {
+  std::vector<uint64_t> counts;
+  source.ReadCounts(counts);
+  // Temporary files for the trie go with the output when there is one.
+  InitializeFrom(source, config.write_mmap ? config.write_mmap : "", counts, config);
+  InitializeStates();
+}
+
+template <class Search, class VocabularyT> void GenericModel<Search, VocabularyT>::InitializeStates() {
   // g++ prints warnings unless these are fully initialized.
   State begin_sentence = State();
   begin_sentence.length = 1;
@@ -92,43 +105,49 @@ template <class Search, class VocabularyT> GenericModel<Search, VocabularyT>::Ge
 template <class Search, class VocabularyT> void GenericModel<Search, VocabularyT>::InitializeFromARPA(int fd, const char *file, const Config &config) {
   // Backing file is the ARPA.
   util::FilePiece f(fd, file, config.ProgressMessages());
+  std::vector<uint64_t> counts;
   try {
-    std::vector<uint64_t> counts;
     // File counts do not include pruned trigrams that extend to quadgrams etc.   These will be fixed by search_.
     ReadARPACounts(f, counts);
-    CheckCounts(counts);
-    if (counts.size() < 2) UTIL_THROW(FormatLoadException, "This ngram implementation assumes at least a bigram model.");
-    if (config.probing_multiplier <= 1.0) UTIL_THROW(ConfigException, "probing multiplier must be > 1.0");
-
-    std::size_t vocab_size = util::CheckOverflow(VocabularyT::Size(counts[0], config));
-    // Setup the binary file for writing the vocab lookup table.  The search_ is responsible for growing the binary file to its needs.
-    vocab_.SetupMemory(backing_.SetupJustVocab(vocab_size, counts.size()), vocab_size, counts[0], config);
-
-    if (config.write_mmap && config.include_vocab) {
-      WriteWordsWrapper wrap(config.enumerate_vocab);
-      vocab_.ConfigureEnumerate(&wrap, counts[0]);
-      search_.InitializeFromARPA(file, f, counts, config, vocab_, backing_);
-      void *vocab_rebase, *search_rebase;
-      backing_.WriteVocabWords(wrap.Buffer(), vocab_rebase, search_rebase);
-      // Due to writing at the end of file, mmap may have relocated data.  So remap.
-      vocab_.Relocate(vocab_rebase);
-      search_.SetupMemory(reinterpret_cast<uint8_t*>(search_rebase), counts, config);
-    } else {
-      vocab_.ConfigureEnumerate(config.enumerate_vocab, counts[0]);
-      search_.InitializeFromARPA(file, f, counts, config, vocab_, backing_);
-    }
-
-    if (!vocab_.SawUnk()) {
-      assert(config.unknown_missing != THROW_UP);
-      // Default probabilities for unknown.
-      search_.UnknownUnigram().backoff = 0.0;
-      search_.UnknownUnigram().prob = config.unknown_missing_logprob;
-    }
-    backing_.FinishFile(config, kModelType, kVersion, counts);
   } catch (util::Exception &e) {
     e << " Byte: " << f.Offset();
     throw;
   }
+  // Errors in n-grams say which byte they're at.  f.Offset() isn't it after
+  // this point: the trie reads ahead of the lines being parsed.
+  InitializeFrom(f, file, counts, config);
+}
+
+template <class Search, class VocabularyT> template <class Source> void GenericModel<Search, VocabularyT>::InitializeFrom(Source &f, const char *file, std::vector<uint64_t> &counts, const Config &config) {
+  CheckCounts(counts);
+  if (counts.size() < 2) UTIL_THROW(FormatLoadException, "This ngram implementation assumes at least a bigram model.");
+  if (config.probing_multiplier <= 1.0) UTIL_THROW(ConfigException, "probing multiplier must be > 1.0");
+
+  std::size_t vocab_size = util::CheckOverflow(VocabularyT::Size(counts[0], config));
+  // Setup the binary file for writing the vocab lookup table.  The search_ is responsible for growing the binary file to its needs.
+  vocab_.SetupMemory(backing_.SetupJustVocab(vocab_size, counts.size()), vocab_size, counts[0], config);
+
+  if (config.write_mmap && config.include_vocab) {
+    WriteWordsWrapper wrap(config.enumerate_vocab);
+    vocab_.ConfigureEnumerate(&wrap, counts[0]);
+    search_.InitializeFromARPA(file, f, counts, config, vocab_, backing_);
+    void *vocab_rebase, *search_rebase;
+    backing_.WriteVocabWords(wrap.Buffer(), vocab_rebase, search_rebase);
+    // Due to writing at the end of file, mmap may have relocated data.  So remap.
+    vocab_.Relocate(vocab_rebase);
+    search_.SetupMemory(reinterpret_cast<uint8_t*>(search_rebase), counts, config);
+  } else {
+    vocab_.ConfigureEnumerate(config.enumerate_vocab, counts[0]);
+    search_.InitializeFromARPA(file, f, counts, config, vocab_, backing_);
+  }
+
+  if (!vocab_.SawUnk()) {
+    assert(config.unknown_missing != THROW_UP);
+    // Default probabilities for unknown.
+    search_.UnknownUnigram().backoff = 0.0;
+    search_.UnknownUnigram().prob = config.unknown_missing_logprob;
+  }
+  backing_.FinishFile(config, kModelType, kVersion, counts);
 }
 
 template <class Search, class VocabularyT> FullScoreReturn GenericModel<Search, VocabularyT>::FullScore(const State &in_state, const WordIndex new_word, State &out_state) const {
@@ -316,8 +335,10 @@ template <class Search, class VocabularyT> float GenericModel<Search, Vocabulary
   return ret;
 }
 
-template class GenericModel<HashedSearch<BackoffValue>, ProbingVocabulary>;
-template class GenericModel<HashedSearch<RestValue>, ProbingVocabulary>;
+template class GenericModel<HashedSearch<BackoffValue, LinearProbing>, ProbingVocabulary>;
+template class GenericModel<HashedSearch<RestValue, LinearProbing>, ProbingVocabulary>;
+template class GenericModel<HashedSearch<BackoffValue, BucketProbing>, ProbingVocabulary>;
+template class GenericModel<HashedSearch<RestValue, BucketProbing>, ProbingVocabulary>;
 template class GenericModel<trie::TrieSearch<DontQuantize, trie::DontBhiksha>, SortedVocabulary>;
 template class GenericModel<trie::TrieSearch<DontQuantize, trie::ArrayBhiksha>, SortedVocabulary>;
 template class GenericModel<trie::TrieSearch<SeparatelyQuantize, trie::DontBhiksha>, SortedVocabulary>;
@@ -340,6 +361,10 @@ base::Model *LoadVirtual(const char *file_name, const Config &config, ModelType
       return new ArrayTrieModel(file_name, config);
     case QUANT_ARRAY_TRIE:
       return new QuantArrayTrieModel(file_name, config);
+    case BUCKET_PROBING:
+      return new BucketProbingModel(file_name, config);
+    case REST_BUCKET_PROBING:
+      return new RestBucketProbingModel(file_name, config);
     default:
       UTIL_THROW(FormatLoadException, "Confused by model type " << model_type);
   }
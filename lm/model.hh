@@ -23,6 +23,7 @@
 namespace util { class FilePiece; }
 
 namespace lm {
+class NGramSource;
 namespace ngram {
 namespace detail {
 
@@ -51,6 +52,12 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
      */
     explicit GenericModel(const char *file, const Config &config = Config());
 
+    /* Build the model from n-grams supplied by source instead of an ARPA
+     * file, for example by lmplz.  Set config.write_mmap to save a binary
+     * file, as build_binary does.  See lm/ngram_source.hh.
+     */
+    explicit GenericModel(NGramSource &source, const Config &config = Config());
+
     /* Score p(new_word | in_state) and incorporate new_word into out_state.
      * Note that in_state and out_state must be different references:
      * &in_state != &out_state.  
@@ -66,6 +73,21 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
      */
     FullScoreReturn FullScoreForgotState(const WordIndex *context_rbegin, const WordIndex *context_rend, const WordIndex new_word, State &out_state) const;
 
+    /* Hint that FullScore(in_state, new_word, ...) will be called soon.  This
+     * issues prefetches for the hash table buckets that query will probe, so
+     * a decoder with many independent queries can prefetch for a batch of
+     * them, then score the batch while the memory system catches up.  Does
+     * nothing for trie models.
+     */
+    void Prefetch(const State &in_state, const WordIndex new_word) const {
+      search_.Prefetch(in_state.words, in_state.words + in_state.length, new_word);
+    }
+
+    // Same as above, with the context in reverse order as for FullScoreForgotState.
+    void Prefetch(const WordIndex *context_rbegin, const WordIndex *context_rend, const WordIndex new_word) const {
+      search_.Prefetch(context_rbegin, std::min(context_rend, context_rbegin + P::Order() - 1), new_word);
+    }
+
     /* Get the state for a context.  Don't use this if you can avoid it.  Use
      * BeginSentenceState or NullContextState and extend from those.  If
      * you're only going to use this state to call FullScore once, use
@@ -114,6 +136,12 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
 
     void InitializeFromARPA(int fd, const char *file, const Config &config);
 
+    // Source is util::FilePiece for ARPA or NGramSource.
+    template <class Source> void InitializeFrom(Source &f, const char *file, std::vector<uint64_t> &counts, const Config &config);
+
+    // Set up the begin sentence and null context states after loading.
+    void InitializeStates();
+
     float InternalUnRest(const uint64_t *pointers_begin, const uint64_t *pointers_end, unsigned char first_length) const;
 
     BinaryFormat backing_;
@@ -132,10 +160,13 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
 class name : public from {\
   public:\
     name(const char *file, const Config &config = Config()) : from(file, config) {}\
+    name(NGramSource &source, const Config &config = Config()) : from(source, config) {}\
 };
 
-LM_NAME_MODEL(ProbingModel, detail::GenericModel<detail::HashedSearch<BackoffValue> LM_COMMA() ProbingVocabulary>);
-LM_NAME_MODEL(RestProbingModel, detail::GenericModel<detail::HashedSearch<RestValue> LM_COMMA() ProbingVocabulary>);
+LM_NAME_MODEL(ProbingModel, detail::GenericModel<detail::HashedSearch<BackoffValue LM_COMMA() detail::LinearProbing> LM_COMMA() ProbingVocabulary>);
+LM_NAME_MODEL(RestProbingModel, detail::GenericModel<detail::HashedSearch<RestValue LM_COMMA() detail::LinearProbing> LM_COMMA() ProbingVocabulary>);
+LM_NAME_MODEL(BucketProbingModel, detail::GenericModel<detail::HashedSearch<BackoffValue LM_COMMA() detail::BucketProbing> LM_COMMA() ProbingVocabulary>);
+LM_NAME_MODEL(RestBucketProbingModel, detail::GenericModel<detail::HashedSearch<RestValue LM_COMMA() detail::BucketProbing> LM_COMMA() ProbingVocabulary>);
 LM_NAME_MODEL(TrieModel, detail::GenericModel<trie::TrieSearch<DontQuantize LM_COMMA() trie::DontBhiksha> LM_COMMA() SortedVocabulary>);
 LM_NAME_MODEL(ArrayTrieModel, detail::GenericModel<trie::TrieSearch<DontQuantize LM_COMMA() trie::ArrayBhiksha> LM_COMMA() SortedVocabulary>);
 LM_NAME_MODEL(QuantTrieModel, detail::GenericModel<trie::TrieSearch<SeparatelyQuantize LM_COMMA() trie::DontBhiksha> LM_COMMA() SortedVocabulary>);
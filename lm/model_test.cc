@@ -347,6 +347,9 @@ template <class ModelT> void LoadingTest() {
 BOOST_AUTO_TEST_CASE(probing) {
   LoadingTest<Model>();
 }
+BOOST_AUTO_TEST_CASE(bucket_probing) {
+  LoadingTest<BucketProbingModel>();
+}
 BOOST_AUTO_TEST_CASE(trie) {
   LoadingTest<TrieModel>();
 }
@@ -418,6 +421,12 @@ BOOST_AUTO_TEST_CASE(write_and_read_probing) {
 BOOST_AUTO_TEST_CASE(write_and_read_rest_probing) {
   BinaryTest<RestProbingModel>();
 }
+BOOST_AUTO_TEST_CASE(write_and_read_bucket_probing) {
+  BinaryTest<BucketProbingModel>();
+}
+BOOST_AUTO_TEST_CASE(write_and_read_rest_bucket_probing) {
+  BinaryTest<RestBucketProbingModel>();
+}
 BOOST_AUTO_TEST_CASE(write_and_read_trie) {
   BinaryTest<TrieModel>();
 }
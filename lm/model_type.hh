@@ -6,7 +6,7 @@ namespace ngram {
 
 /* Not the best numbering system, but it grew this way for historical reasons
  * and I want to preserve existing binary files. */
-typedef enum {PROBING=0, REST_PROBING=1, TRIE=2, QUANT_TRIE=3, ARRAY_TRIE=4, QUANT_ARRAY_TRIE=5} ModelType;
+typedef enum {PROBING=0, REST_PROBING=1, TRIE=2, QUANT_TRIE=3, ARRAY_TRIE=4, QUANT_ARRAY_TRIE=5, BUCKET_PROBING=6, REST_BUCKET_PROBING=7} ModelType;
 
 // Historical names.  
 const ModelType HASH_PROBING = PROBING;
@@ -17,6 +17,7 @@ const ModelType QUANT_ARRAY_TRIE_SORTED = QUANT_ARRAY_TRIE;
 
 const static ModelType kQuantAdd = static_cast<ModelType>(QUANT_TRIE - TRIE);
 const static ModelType kArrayAdd = static_cast<ModelType>(ARRAY_TRIE - TRIE);
+const static ModelType kBucketAdd = static_cast<ModelType>(BUCKET_PROBING - PROBING);
 
 } // namespace ngram
 } // namespace lm
@@ -0,0 +1,32 @@
+#include "lm/ngram_source.hh"
+
+#include "lm/blank.hh"
+
+#include <cmath>
+
+#ifdef WIN32
+#include <float.h>
+#endif
+
+namespace lm {
+
+NGramSource::~NGramSource() {}
+
+void ReadNGramHeader(NGramSource &in, unsigned int length) {
+  in.BeginOrder(static_cast<unsigned char>(length));
+}
+
+void ReadEnd(NGramSource & /*in*/) {}
+
+void SetBackoff(float &to, float backoff) {
+#ifdef WIN32
+  int float_class = _fpclass(backoff);
+  UTIL_THROW_IF(float_class == _FPCLASS_SNAN || float_class == _FPCLASS_QNAN || float_class == _FPCLASS_NINF || float_class == _FPCLASS_PINF, FormatLoadException, "Bad backoff " << backoff);
+#else
+  int float_class = std::fpclassify(backoff);
+  UTIL_THROW_IF(float_class == FP_NAN || float_class == FP_INFINITE, FormatLoadException, "Bad backoff " << backoff);
+#endif
+  to = (backoff == ngram::kExtensionBackoff) ? ngram::kNoExtensionBackoff : backoff;
+}
+
+} // namespace lm
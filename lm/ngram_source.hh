@@ -0,0 +1,111 @@
+#ifndef LM_NGRAM_SOURCE_H
+#define LM_NGRAM_SOURCE_H
+
+#include "lm/read_arpa.hh"
+#include "lm/weights.hh"
+#include "lm/word_index.hh"
+#include "util/exception.hh"
+#include "util/string_piece.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <stdint.h>
+
+namespace lm {
+
+/* Supplies n-grams to build a model without going through an ARPA file, for
+ * example straight from lmplz.  The content is the same as an ARPA file: all
+ * the unigrams, then all the bigrams, etc.  N-grams within an order can come
+ * in any order.  Words are identified by the source's own ids, which need not
+ * be the model's; every id that appears must be the id of a unigram.
+ *
+ * Pass to the GenericModel constructor that takes a source.  The overloads of
+ * the read_arpa.hh functions below let the model building code read either.
+ */
+class NGramSource {
+  public:
+    NGramSource() {}
+
+    virtual ~NGramSource();
+
+    // Number of n-grams of each order, like the ARPA header.
+    virtual void ReadCounts(std::vector<uint64_t> &counts) = 0;
+
+    // Start reading n-grams of this order.  Called for 1, 2, ... in turn.
+    virtual void BeginOrder(unsigned char order) = 0;
+
+    // Returns the next n-gram of the current order as source ids in the
+    // usual left to right order.  backoff is ignored for the highest order.
+    virtual const WordIndex *Read(float &prob, float &backoff) = 0;
+
+    // String for a source id.  Must live as long as the source.
+    virtual StringPiece Word(WordIndex id) const = 0;
+
+    // Source id to model id.  Filled in by Read1Grams.
+    std::vector<WordIndex> &ModelIds() { return model_ids_; }
+
+  private:
+    std::vector<WordIndex> model_ids_;
+};
+
+void ReadNGramHeader(NGramSource &in, unsigned int length);
+
+void ReadEnd(NGramSource &in);
+
+inline void SetBackoff(Prob & /*weights*/, float /*backoff*/) {}
+// Same convention as ReadBackoff: zero backoff is always negative zero.
+void SetBackoff(float &to, float backoff);
+inline void SetBackoff(ProbBackoff &weights, float backoff) {
+  SetBackoff(weights.backoff, backoff);
+}
+inline void SetBackoff(RestWeights &weights, float backoff) {
+  SetBackoff(weights.backoff, backoff);
+}
+
+template <class Voc, class Weights> void Read1Grams(NGramSource &f, std::size_t count, Voc &vocab, Weights *unigrams, PositiveProbWarn &warn) {
+  ReadNGramHeader(f, 1);
+  std::vector<WordIndex> source_ids;
+  source_ids.reserve(count);
+  WordIndex bound = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    float prob, backoff;
+    const WordIndex source = *f.Read(prob, backoff);
+    if (prob > 0.0) {
+      warn.Warn(prob);
+      prob = 0.0;
+    }
+    Weights &w = unigrams[vocab.Insert(f.Word(source))];
+    w.prob = prob;
+    SetBackoff(w, backoff);
+    source_ids.push_back(source);
+    bound = std::max(bound, source + 1);
+  }
+  vocab.FinishedLoading(unigrams);
+  // Insert's ids may be reordered by FinishedLoading, so map by string.
+  std::vector<WordIndex> &model_ids = f.ModelIds();
+  model_ids.assign(bound, kMaxWordIndex);
+  for (std::vector<WordIndex>::const_iterator i = source_ids.begin(); i != source_ids.end(); ++i) {
+    model_ids[*i] = vocab.Index(f.Word(*i));
+  }
+}
+
+template <class Voc, class Weights, class Iterator> void ReadNGram(NGramSource &f, const unsigned char n, const Voc & /*vocab*/, Iterator indices_out, Weights &weights, PositiveProbWarn &warn) {
+  float backoff;
+  const WordIndex *words = f.Read(weights.prob, backoff);
+  if (weights.prob > 0.0) {
+    warn.Warn(weights.prob);
+    weights.prob = 0.0;
+  }
+  const std::vector<WordIndex> &model_ids = f.ModelIds();
+  for (const WordIndex *i = words; i != words + n; ++i, ++indices_out) {
+    UTIL_THROW_IF(*i >= model_ids.size() || model_ids[*i] == kMaxWordIndex, FormatLoadException, "Word id " << *i << " in a " << static_cast<unsigned int>(n) << "-gram is not a unigram");
+    *indices_out = model_ids[*i];
+  }
+  SetBackoff(weights, backoff);
+}
+
+} // namespace lm
+
+#endif // LM_NGRAM_SOURCE_H
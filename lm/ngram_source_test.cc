@@ -0,0 +1,178 @@
+#include "lm/ngram_source.hh"
+
+#include "lm/model.hh"
+#include "util/string_piece.hh"
+#include "util/tokenize_piece.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BOOST_TEST_MODULE NGramSourceTest
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+// Apparently some Boost versions use templates and are pretty strict about types matching.
+#define SLOPPY_CHECK_CLOSE(ref, value, tol) BOOST_CHECK_CLOSE(static_cast<double>(ref), static_cast<double>(value), static_cast<double>(tol));
+
+namespace lm {
+namespace ngram {
+namespace {
+
+const char *TestLocation() {
+  if (boost::unit_test::framework::master_test_suite().argc < 2) {
+    return "test.arpa";
+  }
+  return boost::unit_test::framework::master_test_suite().argv[1];
+}
+
+struct Entry {
+  float prob, backoff;
+  std::vector<WordIndex> words;
+};
+
+/* Holds an ARPA file in memory and hands it out like lmplz would.  Source ids
+ * are the unigrams numbered from the end, so they differ from the model's.
+ */
+class ARPASource : public NGramSource {
+  public:
+    explicit ARPASource(const char *file) : order_(0), next_(0) {
+      std::ifstream in(file);
+      std::string line;
+      unsigned int order = 0;
+      std::vector<std::vector<std::string> > ngram_words;
+      while (std::getline(in, line)) {
+        if (line.empty() || line == "\\data\\" || line == "\\end\\") continue;
+        if (line.compare(0, 6, "ngram ") == 0) {
+          counts_.push_back(strtoull(line.c_str() + line.find('=') + 1, NULL, 10));
+          continue;
+        }
+        if (line[0] == '\\') {
+          order = atoi(line.c_str() + 1);
+          entries_.resize(order);
+          continue;
+        }
+        std::vector<StringPiece> fields;
+        for (util::TokenIter<util::SingleCharacter> i(line, '\t'); i; ++i) fields.push_back(*i);
+        BOOST_REQUIRE(fields.size() == 2 || fields.size() == 3);
+        Entry entry;
+        entry.prob = static_cast<float>(strtod(fields[0].data(), NULL));
+        entry.backoff = (fields.size() == 3) ? static_cast<float>(strtod(fields[2].data(), NULL)) : 0.0;
+        std::vector<std::string> words;
+        for (util::TokenIter<util::SingleCharacter, true> i(fields[1], ' '); i; ++i) words.push_back(i->as_string());
+        BOOST_REQUIRE_EQUAL(order, words.size());
+        if (order == 1) {
+          vocab_.push_back(words[0]);
+        }
+        ngram_words.push_back(words);
+        entries_[order - 1].push_back(entry);
+      }
+      BOOST_REQUIRE_EQUAL(counts_.size(), entries_.size());
+      // Now that the unigrams are known, number the words.
+      std::vector<std::vector<std::string> >::const_iterator words = ngram_words.begin();
+      for (std::vector<std::vector<Entry> >::iterator order = entries_.begin(); order != entries_.end(); ++order) {
+        for (std::vector<Entry>::iterator entry = order->begin(); entry != order->end(); ++entry, ++words) {
+          for (std::vector<std::string>::const_iterator word = words->begin(); word != words->end(); ++word) {
+            entry->words.push_back(Id(*word));
+          }
+        }
+      }
+    }
+
+    void ReadCounts(std::vector<uint64_t> &counts) {
+      counts = counts_;
+    }
+
+    void BeginOrder(unsigned char order) {
+      BOOST_REQUIRE_EQUAL(order_ + 1, order);
+      order_ = order;
+      next_ = 0;
+    }
+
+    const WordIndex *Read(float &prob, float &backoff) {
+      const Entry &entry = entries_[order_ - 1][next_++];
+      prob = entry.prob;
+      backoff = entry.backoff;
+      return &entry.words[0];
+    }
+
+    StringPiece Word(WordIndex id) const {
+      return vocab_[vocab_.size() - 1 - id];
+    }
+
+  private:
+    WordIndex Id(const std::string &word) const {
+      std::vector<std::string>::const_iterator found = std::find(vocab_.begin(), vocab_.end(), word);
+      BOOST_REQUIRE(found != vocab_.end());
+      return vocab_.end() - found - 1;
+    }
+
+    std::vector<uint64_t> counts_;
+    std::vector<std::vector<Entry> > entries_;
+    std::vector<std::string> vocab_;
+    unsigned char order_;
+    std::size_t next_;
+};
+
+std::string ReadFile(const char *name) {
+  std::ifstream in(name, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+template <class Model> void CheckScores(const Model &model) {
+  const typename Model::Vocabulary &vocab = model.GetVocabulary();
+  State state(model.BeginSentenceState()), out;
+  const char *words[] = {"looking", "on", "a", "little"};
+  const float probs[] = {-0.4846522, -0.3488368, -0.01552657, -0.003061223};
+  for (unsigned int i = 0; i < 4; ++i) {
+    FullScoreReturn ret(model.FullScore(state, vocab.Index(words[i]), out));
+    SLOPPY_CHECK_CLOSE(probs[i], ret.prob, 0.001);
+    BOOST_CHECK_EQUAL(i + 2, ret.ngram_length);
+    state = out;
+  }
+  SLOPPY_CHECK_CLOSE(-1.285941, model.FullScore(model.NullContextState(), vocab.Index("a"), out).prob, 0.001);
+}
+
+// The source must build the same file as the ARPA it came from.
+template <class Model> void SameAsARPA() {
+  Config config;
+  config.messages = NULL;
+  config.write_mmap = "ngram_source_arpa.binary";
+  {
+    Model from_arpa(TestLocation(), config);
+  }
+  config.write_mmap = "ngram_source.binary";
+  {
+    ARPASource source(TestLocation());
+    Model from_source(source, config);
+    CheckScores(from_source);
+  }
+  config.write_mmap = NULL;
+  {
+    Model binary("ngram_source.binary", config);
+    CheckScores(binary);
+  }
+  std::string expected(ReadFile("ngram_source_arpa.binary"));
+  BOOST_CHECK(!expected.empty());
+  BOOST_CHECK(expected == ReadFile("ngram_source.binary"));
+  unlink("ngram_source_arpa.binary");
+  unlink("ngram_source.binary");
+}
+
+BOOST_AUTO_TEST_CASE(probing) {
+  SameAsARPA<ProbingModel>();
+}
+BOOST_AUTO_TEST_CASE(trie) {
+  SameAsARPA<TrieModel>();
+}
+
+} // namespace
+} // namespace ngram
+} // namespace lm
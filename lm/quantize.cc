@@ -11,6 +11,9 @@
 #include "lm/binary_format.hh"
 #include "lm/lm_exception.hh"
 #include "util/file.hh"
+#include "util/task_group.hh"
+
+#include <boost/bind.hpp>
 
 #include <algorithm>
 #include <numeric>
@@ -20,8 +23,44 @@ namespace ngram {
 
 namespace {
 
+void SortRange(std::vector<float>::iterator begin, std::vector<float>::iterator end) {
+  std::sort(begin, end);
+}
+
+void MergeRange(std::vector<float>::iterator begin, std::vector<float>::iterator middle, std::vector<float>::iterator end) {
+  std::inplace_merge(begin, middle, end);
+}
+
+// Sort pieces on separate threads then merge neighbouring pieces, also in parallel, until one is left.
+void ParallelSort(std::vector<float> &values) {
+  // Not worth splitting small tables.  
+  const std::size_t pieces = std::max<std::size_t>(1, std::min<std::size_t>(util::DefaultTaskCount(), values.size() / 65536));
+  std::vector<std::size_t> bounds;
+  for (std::size_t i = 0; i <= pieces; ++i) {
+    bounds.push_back(values.size() * i / pieces);
+  }
+  const std::vector<float>::iterator base(values.begin());
+  util::TaskGroup group;
+  for (std::size_t i = 0; i + 1 < bounds.size(); ++i) {
+    group.Start(boost::bind(&SortRange, base + bounds[i], base + bounds[i + 1]));
+  }
+  group.Join();
+  while (bounds.size() > 2) {
+    std::vector<std::size_t> merged;
+    std::size_t i = 0;
+    for (; i + 2 < bounds.size(); i += 2) {
+      group.Start(boost::bind(&MergeRange, base + bounds[i], base + bounds[i + 1], base + bounds[i + 2]));
+      merged.push_back(bounds[i]);
+    }
+    // End, and the last piece if there was an odd number.  
+    merged.insert(merged.end(), bounds.begin() + i, bounds.end());
+    group.Join();
+    bounds.swap(merged);
+  }
+}
+
 void MakeBins(std::vector<float> &values, float *centers, uint32_t bins) {
-  std::sort(values.begin(), values.end());
+  ParallelSort(values);
   std::vector<float>::const_iterator start = values.begin(), finish;
   for (uint32_t i = 0; i < bins; ++i, ++centers, start = finish) {
     finish = values.begin() + ((values.size() * static_cast<uint64_t>(i + 1)) / bins);
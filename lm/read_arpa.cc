@@ -85,7 +85,9 @@ void ReadNGramHeader(util::FilePiece &in, unsigned int length) {
   if (line != expected.str()) UTIL_THROW(FormatLoadException, "Was expecting n-gram header " << expected.str() << " but got " << line << " instead");
 }
 
-void ReadBackoff(util::FilePiece &in, Prob &/*weights*/) {
+namespace {
+// In is util::FilePiece or ARPAText.
+template <class In> void ReadBackoffProb(In &in) {
   switch (in.get()) {
     case '\t':
       {
@@ -101,7 +103,7 @@ void ReadBackoff(util::FilePiece &in, Prob &/*weights*/) {
   }
 }
 
-void ReadBackoff(util::FilePiece &in, float &backoff) {
+template <class In> void ReadBackoffFloat(In &in, float &backoff) {
   // Always make zero negative.
   // Negative zero means that no (n+1)-gram has this n-gram as context.
   // Therefore the hypothesis state can be shorter.  Of course, many n-grams
@@ -130,6 +132,34 @@ void ReadBackoff(util::FilePiece &in, float &backoff) {
   }
 }
 
+} // namespace
+
+void ReadBackoff(util::FilePiece &in, Prob &/*weights*/) {
+  ReadBackoffProb(in);
+}
+
+void ReadBackoff(util::FilePiece &in, float &backoff) {
+  ReadBackoffFloat(in, backoff);
+}
+
+void ReadBackoff(ARPAText &in, Prob &/*weights*/) {
+  ReadBackoffProb(in);
+}
+
+void ReadBackoff(ARPAText &in, float &backoff) {
+  ReadBackoffFloat(in, backoff);
+}
+
+float ARPAText::ReadFloat() {
+  for (; position_ != end_ && util::kSpaces[static_cast<unsigned char>(*position_)]; ++position_) {}
+  const char *end = end_;
+  float ret;
+  util::ParseNumber(position_, end, ret);
+  if (end == position_) throw util::ParseNumberException(ReadDelimited(util::kSpaces));
+  position_ = end;
+  return ret;
+}
+
 void ReadEnd(util::FilePiece &in) {
   StringPiece line;
   do {
@@ -146,6 +176,9 @@ void ReadEnd(util::FilePiece &in) {
 }
 
 void PositiveProbWarn::Warn(float prob) {
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(mutex_);
+#endif
   switch (action_) {
     case THROW_UP:
       UTIL_THROW(FormatLoadException, "Positive log probability " << prob << " in the model.  This is a bug in IRSTLM; you can set config.positive_log_probability = SILENT or pass -i to build_binary to substitute 0.0 for the log probability.  Error");
@@ -10,6 +10,10 @@
 #include <iosfwd>
 #include <vector>
 
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
+
 namespace lm {
 
 void ReadARPACounts(util::FilePiece &in, std::vector<uint64_t> &number);
@@ -28,17 +32,66 @@ void ReadEnd(util::FilePiece &in);
 
 extern const bool kARPASpaces[256];
 
-// Positive log probability warning.
+/* N-gram lines copied out of an ARPA file so that several threads can parse
+ * parts of the same order.  Has the parts of FilePiece that ReadNGram uses.
+ * offset is where begin was in the file, for error messages.  
+ */
+class ARPAText {
+  public:
+    ARPAText(const char *begin, const char *end, uint64_t offset)
+      : begin_(begin), position_(begin), end_(end), offset_(offset) {}
+
+    char get() {
+      if (position_ == end_) throw util::EndOfFileException();
+      return *(position_++);
+    }
+
+    StringPiece ReadDelimited(const bool *delim) {
+      for (; position_ != end_ && delim[static_cast<unsigned char>(*position_)]; ++position_) {}
+      const char *start = position_;
+      for (; position_ != end_ && !delim[static_cast<unsigned char>(*position_)]; ++position_) {}
+      return StringPiece(start, position_ - start);
+    }
+
+    // Same parsing as FilePiece::ReadFloat.
+    float ReadFloat();
+
+    uint64_t Offset() const {
+      return offset_ + (position_ - begin_);
+    }
+
+  private:
+    const char *const begin_;
+    const char *position_;
+    const char *const end_;
+    const uint64_t offset_;
+};
+
+void ReadBackoff(ARPAText &in, Prob &weights);
+void ReadBackoff(ARPAText &in, float &backoff);
+inline void ReadBackoff(ARPAText &in, ProbBackoff &weights) {
+  ReadBackoff(in, weights.backoff);
+}
+inline void ReadBackoff(ARPAText &in, RestWeights &weights) {
+  ReadBackoff(in, weights.backoff);
+}
+
+// Positive log probability warning.  Parsing tasks share one, so the
+// complaint is printed once per file.
 class PositiveProbWarn {
   public:
     PositiveProbWarn() : action_(THROW_UP) {}
 
     explicit PositiveProbWarn(WarningAction action) : action_(action) {}
 
+    // Thread safe.
     void Warn(float prob);
 
   private:
     WarningAction action_;
+#ifdef WITH_THREADS
+    boost::mutex mutex_;
+#endif
 };
 
 template <class Voc, class Weights> void Read1Gram(util::FilePiece &f, Voc &vocab, Weights *unigrams, PositiveProbWarn &warn) {
@@ -67,8 +120,9 @@ template <class Voc, class Weights> void Read1Grams(util::FilePiece &f, std::siz
   vocab.FinishedLoading(unigrams);
 }
 
-// Read ngram, write vocab ids to indices_out.
-template <class Voc, class Weights, class Iterator> void ReadNGram(util::FilePiece &f, const unsigned char n, const Voc &vocab, Iterator indices_out, Weights &weights, PositiveProbWarn &warn) {
+namespace detail {
+// In is util::FilePiece or ARPAText.
+template <class In, class Voc, class Weights, class Iterator> void ReadNGram(In &f, const unsigned char n, const Voc &vocab, Iterator indices_out, Weights &weights, PositiveProbWarn &warn) {
   try {
     weights.prob = f.ReadFloat();
     if (weights.prob > 0.0) {
@@ -89,6 +143,17 @@ template <class Voc, class Weights, class Iterator> void ReadNGram(util::FilePie
     throw;
   }
 }
+} // namespace detail
+
+// Read ngram, write vocab ids to indices_out.
+template <class Voc, class Weights, class Iterator> void ReadNGram(util::FilePiece &f, const unsigned char n, const Voc &vocab, Iterator indices_out, Weights &weights, PositiveProbWarn &warn) {
+  detail::ReadNGram(f, n, vocab, indices_out, weights, warn);
+}
+
+// Read ngram from a copy, which is safe to do in parallel if vocab is done loading.
+template <class Voc, class Weights, class Iterator> void ReadNGram(ARPAText &f, const unsigned char n, const Voc &vocab, Iterator indices_out, Weights &weights, PositiveProbWarn &warn) {
+  detail::ReadNGram(f, n, vocab, indices_out, weights, warn);
+}
 
 } // namespace lm
 
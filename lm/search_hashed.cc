@@ -4,6 +4,7 @@
 #include "lm/blank.hh"
 #include "lm/lm_exception.hh"
 #include "lm/model.hh"
+#include "lm/ngram_source.hh"
 #include "lm/read_arpa.hh"
 #include "lm/value.hh"
 #include "lm/vocab.hh"
@@ -55,12 +56,12 @@ template <class Weights> class ActivateUnigram {
 };
 
 // Find the lower order entry, inserting blanks along the way as necessary.
-template <class Value> void FindLower(
+template <class Value, class Middle> void FindLower(
     const std::vector<uint64_t> &keys,
     typename Value::Weights &unigram,
-    std::vector<util::ProbingHashTable<typename Value::ProbingEntry, util::IdentityHash> > &middle,
+    std::vector<Middle> &middle,
     std::vector<typename Value::Weights *> &between) {
-  typename util::ProbingHashTable<typename Value::ProbingEntry, util::IdentityHash>::MutableIterator iter;
+  typename Middle::MutableIterator iter;
   typename Value::ProbingEntry entry;
   // Backoff will always be 0.0.  We'll get the probability and rest in another pass.
   entry.value.backoff = kNoExtensionBackoff;
@@ -78,20 +79,19 @@ template <class Value> void FindLower(
 }
 
 // Between usually has  single entry, the value to adjust.  But sometimes SRI stupidly pruned entries so it has unitialized blank values to be set here.
-template <class Added, class Build> void AdjustLower(
+template <class Added, class Build, class Middle> void AdjustLower(
     const Added &added,
     const Build &build,
     std::vector<typename Build::Value::Weights *> &between,
     const unsigned int n,
     const std::vector<WordIndex> &vocab_ids,
     typename Build::Value::Weights *unigrams,
-    std::vector<util::ProbingHashTable<typename Build::Value::ProbingEntry, util::IdentityHash> > &middle) {
+    std::vector<Middle> &middle) {
   typedef typename Build::Value Value;
   if (between.size() == 1) {
     build.MarkExtends(*between.front(), added);
     return;
   }
-  typedef util::ProbingHashTable<typename Value::ProbingEntry, util::IdentityHash> Middle;
   float prob = -fabs(between.back()->prob);
   // Order of the n-gram on which probabilities are based.
   unsigned char basis = n - between.size();
@@ -136,11 +136,11 @@ template <class Added, class Build> void AdjustLower(
 }
 
 // Continue marking lower entries even they know that they extend left.  This is used for upper/lower bounds.
-template <class Build> void MarkLower(
+template <class Build, class Middle> void MarkLower(
     const std::vector<uint64_t> &keys,
     const Build &build,
     typename Build::Value::Weights &unigram,
-    std::vector<util::ProbingHashTable<typename Build::Value::ProbingEntry, util::IdentityHash> > &middle,
+    std::vector<Middle> &middle,
     int start_order,
     const typename Build::Value::Weights &longer) {
   if (start_order == 0) return;
@@ -156,14 +156,14 @@ template <class Build> void MarkLower(
   }
 }
 
-template <class Build, class Activate, class Store> void ReadNGrams(
-    util::FilePiece &f,
+template <class Build, class Activate, class Store, class Middle, class Source> void ReadNGrams(
+    Source &f,
     const unsigned int n,
     const size_t count,
     const ProbingVocabulary &vocab,
     const Build &build,
     typename Build::Value::Weights *unigrams,
-    std::vector<util::ProbingHashTable<typename Build::Value::ProbingEntry, util::IdentityHash> > &middle,
+    std::vector<Middle> &middle,
     Activate activate,
     Store &store,
     PositiveProbWarn &warn) {
@@ -203,20 +203,57 @@ template <class Build, class Activate, class Store> void ReadNGrams(
 } // namespace
 namespace detail {
 
-template <class Value> uint8_t *HashedSearch<Value>::SetupMemory(uint8_t *start, const std::vector<uint64_t> &counts, const Config &config) {
+// Interpret config's rest cost build policy and pass the right template argument to ApplyBuild.
+template <> class BuildDispatch<BackoffValue> {
+  public:
+    template <class Search, class Source> static void Apply(Search &search, Source &f, const std::vector<uint64_t> &counts, const Config &, const ProbingVocabulary &vocab, PositiveProbWarn &warn) {
+      NoRestBuild build;
+      search.ApplyBuild(f, counts, vocab, warn, build);
+    }
+};
+
+template <> class BuildDispatch<RestValue> {
+  public:
+    template <class Search, class Source> static void Apply(Search &search, Source &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn) {
+      switch (config.rest_function) {
+        case Config::REST_MAX:
+          {
+            MaxRestBuild build;
+            search.ApplyBuild(f, counts, vocab, warn, build);
+          }
+          break;
+        case Config::REST_LOWER:
+          {
+            LowerRestBuild<ProbingModel> build(config, counts.size(), vocab);
+            search.ApplyBuild(f, counts, vocab, warn, build);
+          }
+          break;
+      }
+    }
+};
+
+template <class Value, class Probing> uint8_t *HashedSearch<Value, Probing>::SetupMemory(uint8_t *start, const std::vector<uint64_t> &counts, const Config &config) {
+  // The search follows the header and vocabulary in a binary file.
+  return SetupMemory(start, counts, config, TotalHeaderSize(counts.size()) + ProbingVocabulary::Size(counts[0], config));
+}
+
+template <class Value, class Probing> uint8_t *HashedSearch<Value, Probing>::SetupMemory(uint8_t *start, const std::vector<uint64_t> &counts, const Config &config, uint64_t offset) {
+  uint8_t *const base = start;
   unigram_ = Unigram(start, counts[0]);
   start += Unigram::Size(counts[0]);
   std::size_t allocated;
   middle_.clear();
   for (unsigned int n = 2; n < counts.size(); ++n) {
+    start += (Probing::kAlign - (offset + (start - base)) % Probing::kAlign) % Probing::kAlign;
     allocated = Middle::Size(counts[n - 1], config.probing_multiplier);
     middle_.push_back(Middle(start, allocated));
     start += allocated;
   }
+  start += (Probing::kAlign - (offset + (start - base)) % Probing::kAlign) % Probing::kAlign;
   allocated = Longest::Size(counts.back(), config.probing_multiplier);
   longest_ = Longest(start, allocated);
-  start += allocated;
-  return start;
+  // Unused alignment slack goes at the end.
+  return base + Size(counts, config);
 }
 
 /*template <class Value> void HashedSearch<Value>::Relocate(uint8_t *start, const std::vector<uint64_t> &counts, const Config &config) {
@@ -229,41 +266,32 @@ template <class Value> uint8_t *HashedSearch<Value>::SetupMemory(uint8_t *start,
   longest_.Relocate(start);
 }*/
 
-template <class Value> void HashedSearch<Value>::InitializeFromARPA(const char * /*file*/, util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing) {
+template <class Value, class Probing> void HashedSearch<Value, Probing>::InitializeFromARPA(const char * /*file*/, util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing) {
+  InitializeFrom(f, counts, config, vocab, backing);
+}
+
+template <class Value, class Probing> void HashedSearch<Value, Probing>::InitializeFromARPA(const char * /*file*/, NGramSource &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing) {
+  InitializeFrom(f, counts, config, vocab, backing);
+}
+
+template <class Value, class Probing> template <class Source> void HashedSearch<Value, Probing>::InitializeFrom(Source &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing) {
   void *vocab_rebase;
   void *search_base = backing.GrowForSearch(Size(counts, config), vocab.UnkCountChangePadding(), vocab_rebase);
   vocab.Relocate(vocab_rebase);
-  SetupMemory(reinterpret_cast<uint8_t*>(search_base), counts, config);
+  // Without a file, the search has its own page-aligned memory.
+  if (config.write_mmap) {
+    SetupMemory(reinterpret_cast<uint8_t*>(search_base), counts, config);
+  } else {
+    SetupMemory(reinterpret_cast<uint8_t*>(search_base), counts, config, 0);
+  }
 
   PositiveProbWarn warn(config.positive_log_probability);
   Read1Grams(f, counts[0], vocab, unigram_.Raw(), warn);
   CheckSpecials(config, vocab);
-  DispatchBuild(f, counts, config, vocab, warn);
-}
-
-template <> void HashedSearch<BackoffValue>::DispatchBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn) {
-  NoRestBuild build;
-  ApplyBuild(f, counts, vocab, warn, build);
-}
-
-template <> void HashedSearch<RestValue>::DispatchBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn) {
-  switch (config.rest_function) {
-    case Config::REST_MAX:
-      {
-        MaxRestBuild build;
-        ApplyBuild(f, counts, vocab, warn, build);
-      }
-      break;
-    case Config::REST_LOWER:
-      {
-        LowerRestBuild<ProbingModel> build(config, counts.size(), vocab);
-        ApplyBuild(f, counts, vocab, warn, build);
-      }
-      break;
-  }
+  BuildDispatch<Value>::Apply(*this, f, counts, config, vocab, warn);
 }
 
-template <class Value> template <class Build> void HashedSearch<Value>::ApplyBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build) {
+template <class Value, class Probing> template <class Build, class Source> void HashedSearch<Value, Probing>::ApplyBuild(Source &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build) {
   for (WordIndex i = 0; i < counts[0]; ++i) {
     build.SetRest(&i, (unsigned int)1, unigram_.Raw()[i]);
   }
@@ -290,8 +318,10 @@ template <class Value> template <class Build> void HashedSearch<Value>::ApplyBui
   ReadEnd(f);
 }
 
-template class HashedSearch<BackoffValue>;
-template class HashedSearch<RestValue>;
+template class HashedSearch<BackoffValue, LinearProbing>;
+template class HashedSearch<RestValue, LinearProbing>;
+template class HashedSearch<BackoffValue, BucketProbing>;
+template class HashedSearch<RestValue, BucketProbing>;
 
 } // namespace detail
 } // namespace ngram
@@ -8,6 +8,7 @@
 #include "lm/weights.hh"
 
 #include "util/bit_packing.hh"
+#include "util/bucket_probing_hash_table.hh"
 #include "util/probing_hash_table.hh"
 
 #include <algorithm>
@@ -17,6 +18,7 @@
 namespace util { class FilePiece; }
 
 namespace lm {
+class NGramSource;
 namespace ngram {
 class BinaryFormat;
 class ProbingVocabulary;
@@ -59,7 +61,28 @@ class LongestPointer {
     const float *to_;
 };
 
-template <class Value> class HashedSearch {
+// Probing policies for HashedSearch.  Table<Entry>::T is the hash table type.
+struct LinearProbing {
+  static const ModelType kModelTypeAdd = static_cast<ModelType>(0);
+  // Tables are packed end to end.
+  static const std::size_t kAlign = 1;
+  template <class Entry> struct Table {
+    typedef util::ProbingHashTable<Entry, util::IdentityHash> T;
+  };
+};
+
+struct BucketProbing {
+  static const ModelType kModelTypeAdd = kBucketAdd;
+  // Start each table on a cache line.
+  static const std::size_t kAlign = 64;
+  template <class Entry> struct Table {
+    typedef util::BucketProbingHashTable<Entry, util::IdentityHash> T;
+  };
+};
+
+template <class Value> class BuildDispatch;
+
+template <class Value, class Probing> class HashedSearch {
   public:
     typedef uint64_t Node;
 
@@ -67,7 +90,7 @@ template <class Value> class HashedSearch {
     typedef typename Value::ProbingProxy MiddlePointer;
     typedef ::lm::ngram::detail::LongestPointer LongestPointer;
 
-    static const ModelType kModelType = Value::kProbingModelType;
+    static const ModelType kModelType = static_cast<ModelType>(Value::kProbingModelType + Probing::kModelTypeAdd);
     static const bool kDifferentRest = Value::kDifferentRest;
     static const unsigned int kVersion = 0;
 
@@ -77,15 +100,19 @@ template <class Value> class HashedSearch {
     static uint64_t Size(const std::vector<uint64_t> &counts, const Config &config) {
       uint64_t ret = Unigram::Size(counts[0]);
       for (unsigned char n = 1; n < counts.size() - 1; ++n) {
-        ret += Middle::Size(counts[n], config.probing_multiplier);
+        ret += Middle::Size(counts[n], config.probing_multiplier) + Probing::kAlign - 1;
       }
-      return ret + Longest::Size(counts.back(), config.probing_multiplier);
+      return ret + Longest::Size(counts.back(), config.probing_multiplier) + Probing::kAlign - 1;
     }
 
+    // Lays tables out for a binary file.
     uint8_t *SetupMemory(uint8_t *start, const std::vector<uint64_t> &counts, const Config &config);
 
     void InitializeFromARPA(const char *file, util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing);
 
+    // Same, but from a source of n-grams instead of an ARPA file.
+    void InitializeFromARPA(const char *file, NGramSource &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing);
+
     unsigned char Order() const {
       return middle_.size() + 2;
     }
@@ -125,6 +152,25 @@ template <class Value> class HashedSearch {
       return LongestPointer(found->value.prob);
     }
 
+    // Prefetch the entries a query for new_word after the context would
+    // probe.  The full context is used; entries beyond what the query ends up
+    // needing are wasted bandwidth but harmless.
+    void Prefetch(const WordIndex *context_rbegin, const WordIndex *context_rend, WordIndex new_word) const {
+#if defined(__GNUC__)
+      __builtin_prefetch(&unigram_.Lookup(new_word));
+#endif
+      Node node = static_cast<Node>(new_word);
+      unsigned char order_minus_2 = 0;
+      for (const WordIndex *i = context_rbegin; i != context_rend; ++i, ++order_minus_2) {
+        node = CombineWordHash(node, *i);
+        if (order_minus_2 == middle_.size()) {
+          longest_.Prefetch(node);
+          return;
+        }
+        middle_[order_minus_2].Prefetch(node);
+      }
+    }
+
     // Generate a node without necessarily checking that it actually exists.
     // Optionally return false if it's know to not exist.
     bool FastMakeNode(const WordIndex *begin, const WordIndex *end, Node &node) const {
@@ -137,10 +183,17 @@ template <class Value> class HashedSearch {
     }
 
   private:
-    // Interpret config's rest cost build policy and pass the right template argument to ApplyBuild.
-    void DispatchBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn);
+    // BuildDispatch<Value> interprets config's rest cost build policy and passes the right template argument to ApplyBuild.
+    friend class BuildDispatch<Value>;
+
+    // offset is where start will be relative to a page boundary.  Each table
+    // begins at a multiple of Probing::kAlign from that boundary.
+    uint8_t *SetupMemory(uint8_t *start, const std::vector<uint64_t> &counts, const Config &config, uint64_t offset);
+
+    // Source is util::FilePiece for ARPA or NGramSource.
+    template <class Source> void InitializeFrom(Source &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing);
 
-    template <class Build> void ApplyBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build);
+    template <class Build, class Source> void ApplyBuild(Source &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build);
 
     class Unigram {
       public:
@@ -178,10 +231,10 @@ template <class Value> class HashedSearch {
 
     Unigram unigram_;
 
-    typedef util::ProbingHashTable<typename Value::ProbingEntry, util::IdentityHash> Middle;
+    typedef typename Probing::template Table<typename Value::ProbingEntry>::T Middle;
     std::vector<Middle> middle_;
 
-    typedef util::ProbingHashTable<ProbEntry, util::IdentityHash> Longest;
+    typedef typename Probing::template Table<ProbEntry>::T Longest;
     Longest longest_;
 };
 
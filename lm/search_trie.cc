@@ -17,6 +17,9 @@
 #include "util/proxy_iterator.hh"
 #include "util/scoped.hh"
 #include "util/sized_iterator.hh"
+#include "util/task_group.hh"
+
+#include <boost/bind.hpp>
 
 #include <algorithm>
 #include <cstring>
@@ -416,8 +419,9 @@ void SanityCheckCounts(const std::vector<uint64_t> &initial, const std::vector<u
   }
 }
 
-template <class Quant> void TrainQuantizer(uint8_t order, uint64_t count, const std::vector<float> &additional, RecordReader &reader, util::ErsatzProgress &progress, Quant &quant) {
-  std::vector<float> probs(additional), backoffs;
+void ReadQuantizerValues(uint8_t order, uint64_t count, const std::vector<float> &additional, RecordReader &reader, util::ErsatzProgress &progress, std::vector<float> &probs, std::vector<float> &backoffs) {
+  probs.assign(additional.begin(), additional.end());
+  backoffs.clear();
   probs.reserve(count + additional.size());
   backoffs.reserve(count);
   for (reader.Rewind(); reader; ++reader) {
@@ -426,18 +430,16 @@ template <class Quant> void TrainQuantizer(uint8_t order, uint64_t count, const
     if (weights.backoff != 0.0) backoffs.push_back(weights.backoff);
     ++progress;
   }
-  quant.Train(order, probs, backoffs);
 }
 
-template <class Quant> void TrainProbQuantizer(uint8_t order, uint64_t count, RecordReader &reader, util::ErsatzProgress &progress, Quant &quant) {
-  std::vector<float> probs, backoffs;
+void ReadProbQuantizerValues(uint8_t order, uint64_t count, RecordReader &reader, util::ErsatzProgress &progress, std::vector<float> &probs) {
+  probs.clear();
   probs.reserve(count);
   for (reader.Rewind(); reader; ++reader) {
     const Prob &weights = *reinterpret_cast<const Prob*>(reinterpret_cast<const uint8_t*>(reader.Data()) + sizeof(WordIndex) * order);
     probs.push_back(weights.prob);
     ++progress;
   }
-  quant.TrainProb(order, probs);
 }
 
 void PopulateUnigramWeights(FILE *file, WordIndex unigram_count, RecordReader &contexts, UnigramValue *unigrams) {
@@ -499,10 +501,18 @@ template <class Quant, class Bhiksha> void BuildTrie(SortedFiles &files, std::ve
   if (Quant::kTrain) {
     util::ErsatzProgress progress(std::accumulate(counts.begin() + 1, counts.end(), 0),
                                   config.ProgressMessages(), "Quantizing");
+    // Train each order in the background while reading the next, alternating between two sets of values.
+    std::vector<float> probs[2], backoffs[2];
+    util::TaskGroup training;
     for (unsigned char i = 2; i < counts.size(); ++i) {
-      TrainQuantizer(i, counts[i-1], sri.Values(i), inputs[i-2], progress, quant);
+      ReadQuantizerValues(i, counts[i-1], sri.Values(i), inputs[i-2], progress, probs[i % 2], backoffs[i % 2]);
+      training.Join();
+      training.Start(boost::bind(&Quant::Train, &quant, i, boost::ref(probs[i % 2]), boost::ref(backoffs[i % 2])));
     }
-    TrainProbQuantizer(counts.size(), counts.back(), inputs[counts.size() - 2], progress, quant);
+    std::vector<float> &longest = probs[counts.size() % 2];
+    ReadProbQuantizerValues(counts.size(), counts.back(), inputs[counts.size() - 2], progress, longest);
+    training.Join();
+    quant.TrainProb(counts.size(), longest);
     quant.FinishedLoading(config);
   }
 
@@ -576,6 +586,14 @@ template <class Quant, class Bhiksha> uint8_t *TrieSearch<Quant, Bhiksha>::Setup
 }
 
 template <class Quant, class Bhiksha> void TrieSearch<Quant, Bhiksha>::InitializeFromARPA(const char *file, util::FilePiece &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing) {
+  InitializeFrom(file, f, counts, config, vocab, backing);
+}
+
+template <class Quant, class Bhiksha> void TrieSearch<Quant, Bhiksha>::InitializeFromARPA(const char *file, NGramSource &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing) {
+  InitializeFrom(file, f, counts, config, vocab, backing);
+}
+
+template <class Quant, class Bhiksha> template <class Source> void TrieSearch<Quant, Bhiksha>::InitializeFrom(const char *file, Source &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing) {
   std::string temporary_prefix;
   if (!config.temporary_directory_prefix.empty()) {
     temporary_prefix = config.temporary_directory_prefix;
@@ -16,6 +16,7 @@
 #include <assert.h>
 
 namespace lm {
+class NGramSource;
 namespace ngram {
 class BinaryFormat;
 class SortedVocabulary;
@@ -62,6 +63,9 @@ template <class Quant, class Bhiksha> class TrieSearch {
 
     void InitializeFromARPA(const char *file, util::FilePiece &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing);
 
+    // Same, but from a source of n-grams instead of an ARPA file.
+    void InitializeFromARPA(const char *file, NGramSource &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing);
+
     unsigned char Order() const {
       return middle_end_ - middle_begin_ + 2;
     }
@@ -89,6 +93,10 @@ template <class Quant, class Bhiksha> class TrieSearch {
       return LongestPointer(quant_, longest_.Find(word, node));
     }
 
+    // Trie lookups depend on the previous level, so there is nothing useful to
+    // prefetch ahead of time.
+    void Prefetch(const WordIndex * /*context_rbegin*/, const WordIndex * /*context_rend*/, WordIndex /*new_word*/) const {}
+
     bool FastMakeNode(const WordIndex *begin, const WordIndex *end, Node &node) const {
       assert(begin != end);
       bool independent_left;
@@ -101,6 +109,9 @@ template <class Quant, class Bhiksha> class TrieSearch {
     }
 
   private:
+    // Source is util::FilePiece for ARPA or NGramSource.
+    template <class Source> void InitializeFrom(const char *file, Source &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing);
+
     friend void BuildTrie<Quant, Bhiksha>(SortedFiles &files, std::vector<uint64_t> &counts, const Config &config, TrieSearch<Quant, Bhiksha> &out, Quant &quant, SortedVocabulary &vocab, BinaryFormat &backing);
 
     // Middles are managed manually so we can delay construction and they don't have to be copyable.
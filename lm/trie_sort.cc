@@ -2,6 +2,7 @@
 
 #include "lm/config.hh"
 #include "lm/lm_exception.hh"
+#include "lm/ngram_source.hh"
 #include "lm/read_arpa.hh"
 #include "lm/vocab.hh"
 #include "lm/weights.hh"
@@ -10,12 +11,16 @@
 #include "util/mmap.hh"
 #include "util/proxy_iterator.hh"
 #include "util/sized_iterator.hh"
+#include "util/task_group.hh"
+
+#include <boost/bind.hpp>
 
 #include <algorithm>
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
 #include <deque>
+#include <functional>
 #include <iterator>
 #include <limits>
 #include <vector>
@@ -76,9 +81,20 @@ FILE *DiskFlush(const void *mem_begin, const void *mem_end, const std::string &t
   return util::FDOpenOrThrow(file);
 }
 
-FILE *WriteContextFile(uint8_t *begin, uint8_t *end, const std::string &temp_prefix, std::size_t entry_size, unsigned char order) {
+void SortEntries(uint8_t *begin, uint8_t *end, std::size_t entry_size, unsigned char order) {
+  util::SizedProxy proxy_begin(begin, entry_size), proxy_end(end, entry_size);
+  // parallel_sort uses too much RAM.  TODO: figure out why windows sort doesn't like my proxies.  
+#if defined(_WIN32) || defined(_WIN64)
+  std::stable_sort
+#else
+  std::sort
+#endif
+      (NGramIter(proxy_begin), NGramIter(proxy_end), util::SizedCompare<EntryCompare>(EntryCompare(order)));
+}
+
+// Sort just the contexts using the same memory.  This scrambles the entries.
+void SortContexts(uint8_t *begin, uint8_t *end, std::size_t entry_size, unsigned char order) {
   const size_t context_size = sizeof(WordIndex) * (order - 1);
-  // Sort just the contexts using the same memory.  
   PartialIter context_begin(PartialViewProxy(begin + sizeof(WordIndex), entry_size, context_size));
   PartialIter context_end(PartialViewProxy(end + sizeof(WordIndex), entry_size, context_size));
 
@@ -88,6 +104,13 @@ FILE *WriteContextFile(uint8_t *begin, uint8_t *end, const std::string &temp_pre
   std::sort
 #endif
     (context_begin, context_end, util::SizedCompare<EntryCompare, PartialViewProxy>(EntryCompare(order - 1)));
+}
+
+FILE *WriteContextFile(uint8_t *begin, uint8_t *end, const std::string &temp_prefix, std::size_t entry_size, unsigned char order) {
+  const size_t context_size = sizeof(WordIndex) * (order - 1);
+  SortContexts(begin, end, entry_size, order);
+  PartialIter context_begin(PartialViewProxy(begin + sizeof(WordIndex), entry_size, context_size));
+  PartialIter context_end(PartialViewProxy(end + sizeof(WordIndex), entry_size, context_size));
 
   util::scoped_FILE out(util::FMakeTemp(temp_prefix));
 
@@ -106,6 +129,93 @@ FILE *WriteContextFile(uint8_t *begin, uint8_t *end, const std::string &temp_pre
   return out.release();
 }
 
+// Records from one sorted piece of a batch.
+struct Run {
+  uint8_t *begin, *end;
+};
+
+// Heap order, so the smallest record comes first.
+class RunGreater : public std::binary_function<std::size_t, std::size_t, bool> {
+  public:
+    RunGreater(const std::vector<Run> &runs, unsigned char order) : runs_(runs), less_(order) {}
+
+    bool operator()(std::size_t first, std::size_t second) const {
+      return less_(runs_[second].begin, runs_[first].begin);
+    }
+
+  private:
+    const std::vector<Run> &runs_;
+    EntryCompare less_;
+};
+
+/* Merge sorted runs of records, which are stride bytes apart, and write the
+ * first size bytes of each to a temporary file.  Records are compared as order
+ * words.  If unique, records equal to the previous one are skipped.  
+ */
+FILE *WriteMerged(std::vector<Run> runs, std::size_t stride, std::size_t size, unsigned char order, bool unique, const std::string &temp_prefix) {
+  RunGreater greater(runs, order);
+  std::vector<std::size_t> heap;
+  for (std::size_t i = 0; i < runs.size(); ++i) {
+    if (runs[i].begin != runs[i].end) heap.push_back(i);
+  }
+  std::make_heap(heap.begin(), heap.end(), greater);
+
+  util::scoped_FILE out(util::FMakeTemp(temp_prefix));
+  const uint8_t *previous = NULL;
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), greater);
+    Run &run = runs[heap.back()];
+    if (!unique || !previous || memcmp(previous, run.begin, size)) {
+      util::WriteOrThrow(out.get(), run.begin, size);
+      previous = run.begin;
+    }
+    run.begin += stride;
+    if (run.begin == run.end) {
+      heap.pop_back();
+    } else {
+      std::push_heap(heap.begin(), heap.end(), greater);
+    }
+  }
+  return out.release();
+}
+
+/* Sort a batch of entries, then write them and their unique contexts to
+ * temporary files.  With threads, pieces of the batch are sorted in parallel
+ * and merged as they are written.  
+ */
+void SortBatch(uint8_t *begin, uint8_t *end, std::size_t entry_size, unsigned char order, const std::string &temp_prefix, std::deque<FILE*> &files, std::deque<FILE*> &contexts) {
+  const std::size_t count = (end - begin) / entry_size;
+  // Not worth splitting tiny batches.  
+  const std::size_t pieces = std::max<std::size_t>(1, std::min<std::size_t>(util::DefaultTaskCount(), count / 1024));
+  if (pieces == 1) {
+    SortEntries(begin, end, entry_size, order);
+    files.push_back(DiskFlush(begin, end, temp_prefix));
+    contexts.push_back(WriteContextFile(begin, end, temp_prefix, entry_size, order));
+    return;
+  }
+
+  std::vector<Run> runs(pieces);
+  util::TaskGroup sorting;
+  for (std::size_t i = 0; i < pieces; ++i) {
+    uint8_t *run_begin = begin + (count * i / pieces) * entry_size;
+    uint8_t *run_end = begin + (count * (i + 1) / pieces) * entry_size;
+    runs[i].begin = run_begin;
+    runs[i].end = run_end;
+    sorting.Start(boost::bind(&SortEntries, run_begin, run_end, entry_size, order));
+  }
+  sorting.Join();
+  files.push_back(WriteMerged(runs, entry_size, entry_size, order, false, temp_prefix));
+
+  for (std::vector<Run>::iterator i = runs.begin(); i != runs.end(); ++i) {
+    sorting.Start(boost::bind(&SortContexts, i->begin, i->end, entry_size, order));
+    // Words are reversed, so the context follows the last word.  
+    i->begin += sizeof(WordIndex);
+    i->end += sizeof(WordIndex);
+  }
+  sorting.Join();
+  contexts.push_back(WriteMerged(runs, entry_size, sizeof(WordIndex) * (order - 1), order - 1, true, temp_prefix));
+}
+
 struct ThrowCombine {
   void operator()(std::size_t entry_size, unsigned char order, const void *first, const void *second, FILE * /*out*/) const {
     const WordIndex *base = reinterpret_cast<const WordIndex*>(first);
@@ -150,6 +260,125 @@ template <class Combine> FILE *MergeSortedFiles(FILE *first_file, FILE *second_f
   return out_file.release();
 }
 
+// Closes leftover files for orders 2 through count + 1.  
+class Closer {
+  public:
+    Closer(std::deque<FILE*> *files, std::size_t count) : files_(files), count_(count) {}
+
+    ~Closer() {
+      for (std::deque<FILE*> *order = files_; order != files_ + count_; ++order) {
+        for (std::deque<FILE*>::iterator i = order->begin(); i != order->end(); ++i) {
+          util::scoped_FILE deleter(*i);
+        }
+      }
+    }
+
+  private:
+    std::deque<FILE*> *files_;
+    std::size_t count_;
+};
+
+// Merge batches until there is one file, which out takes.  Runs in the background while later orders are read.  
+template <class Combine> void MergeBatches(std::deque<FILE*> &files, const std::string &temp_prefix, std::size_t weights_size, unsigned char order, util::scoped_FILE &out) {
+  while (files.size() > 1) {
+    files.push_back(MergeSortedFiles(files[0], files[1], temp_prefix, weights_size, order, Combine()));
+    for (unsigned int i = 0; i < 2; ++i) {
+      util::scoped_FILE deleter(files.front());
+      files.pop_front();
+    }
+  }
+  if (!files.empty()) {
+    out.reset(files.front());
+    files.pop_front();
+  }
+}
+
+// Reads n-grams into entries, reversing the words.  
+template <class Weights, class Source> void ReadEntries(Source &f, const SortedVocabulary &vocab, unsigned char order, uint8_t *begin, uint8_t *end, std::size_t entry_size, PositiveProbWarn &warn) {
+  for (uint8_t *out = begin; out != end; out += entry_size) {
+    std::reverse_iterator<WordIndex*> it(reinterpret_cast<WordIndex*>(out) + order);
+    ReadNGram(f, order, vocab, it, *reinterpret_cast<Weights*>(out + sizeof(WordIndex) * order), warn);
+  }
+}
+
+template <class Weights> void ParseEntries(ARPAText text, const SortedVocabulary *vocab, unsigned char order, uint8_t *begin, uint8_t *end, std::size_t entry_size, PositiveProbWarn *warn) {
+  ReadEntries<Weights>(text, *vocab, order, begin, end, entry_size, *warn);
+}
+
+// N-gram lines copied from the ARPA file.  
+struct ARPAChunk {
+  std::string text;
+  // Where each non-blank line starts in text.  
+  std::vector<std::size_t> starts;
+  // Of text in the file.  
+  uint64_t offset;
+};
+
+const std::size_t kChunkBytes = 1 << 24;
+
+bool IsBlank(const StringPiece &line) {
+  for (const char *i = line.data(); i != line.data() + line.size(); ++i) {
+    if (!util::kSpaces[static_cast<unsigned char>(*i)]) return false;
+  }
+  return true;
+}
+
+// Copy up to max_lines n-grams, stopping early after about kChunkBytes.  
+void CopyLines(util::FilePiece &f, unsigned char order, std::size_t max_lines, ARPAChunk &chunk) {
+  chunk.text.clear();
+  chunk.starts.clear();
+  chunk.offset = f.Offset();
+  try {
+    while (chunk.starts.size() < max_lines && chunk.text.size() < kChunkBytes) {
+      StringPiece line(f.ReadLine());
+      // Blank lines are copied so that offsets match the file, but ReadNGram will skip them.  
+      if (!IsBlank(line)) chunk.starts.push_back(chunk.text.size());
+      chunk.text.append(line.data(), line.size());
+      chunk.text.push_back('\n');
+    }
+  } catch (util::Exception &e) {
+    e << " in the " << static_cast<unsigned int>(order) << "-gram at byte " << f.Offset();
+    throw;
+  }
+}
+
+template <class Weights> void FillBatch(NGramSource &f, const SortedVocabulary &vocab, unsigned char order, uint8_t *begin, uint8_t *end, std::size_t entry_size, PositiveProbWarn &warn) {
+  ReadEntries<Weights>(f, vocab, order, begin, end, entry_size, warn);
+}
+
+/* Parsing is most of the time spent reading ARPA, so the main thread copies
+ * lines while other threads parse the previous chunk of lines.  
+ */
+template <class Weights> void FillBatch(util::FilePiece &f, const SortedVocabulary &vocab, unsigned char order, uint8_t *begin, uint8_t *end, std::size_t entry_size, PositiveProbWarn &warn) {
+  const std::size_t tasks = util::DefaultTaskCount();
+  if (tasks == 1) {
+    ReadEntries<Weights>(f, vocab, order, begin, end, entry_size, warn);
+    return;
+  }
+  ARPAChunk chunks[2];
+  for (unsigned int i = 0; i < 2; ++i) {
+    chunks[i].text.reserve(kChunkBytes + 1024);
+  }
+  util::TaskGroup parsing;
+  uint8_t *out = begin;
+  CopyLines(f, order, (end - out) / entry_size, chunks[0]);
+  for (unsigned int current = 0; !chunks[current].starts.empty(); current ^= 1) {
+    const ARPAChunk &chunk = chunks[current];
+    const std::size_t lines = chunk.starts.size();
+    for (std::size_t t = 0; t < tasks; ++t) {
+      std::size_t from = lines * t / tasks, to = lines * (t + 1) / tasks;
+      if (from == to) continue;
+      // Each task stops at the next task's text, so a bad line can't run into it.  
+      std::size_t text_end = (to == lines) ? chunk.text.size() : chunk.starts[to];
+      ARPAText text(chunk.text.data() + chunk.starts[from], chunk.text.data() + text_end, chunk.offset + chunk.starts[from]);
+      parsing.Start(boost::bind(&ParseEntries<Weights>, text, &vocab, order, out + from * entry_size, out + to * entry_size, entry_size, &warn));
+    }
+    out += lines * entry_size;
+    CopyLines(f, order, (end - out) / entry_size, chunks[current ^ 1]);
+    parsing.Join();
+  }
+}
+
 } // namespace
 
 void RecordReader::Init(FILE *file, std::size_t entry_size) {
@@ -188,6 +417,14 @@ void RecordReader::Rewind() {
 }
 
 SortedFiles::SortedFiles(const Config &config, util::FilePiece &f, std::vector<uint64_t> &counts, size_t buffer, const std::string &file_prefix, SortedVocabulary &vocab) {
+  Init(config, f, counts, buffer, file_prefix, vocab);
+}
+
+SortedFiles::SortedFiles(const Config &config, NGramSource &f, std::vector<uint64_t> &counts, size_t buffer, const std::string &file_prefix, SortedVocabulary &vocab) {
+  Init(config, f, counts, buffer, file_prefix, vocab);
+}
+
+template <class Source> void SortedFiles::Init(const Config &config, Source &f, std::vector<uint64_t> &counts, size_t buffer, const std::string &file_prefix, SortedVocabulary &vocab) {
   PositiveProbWarn warn(config.positive_log_probability);
   unigram_.reset(util::MakeTemp(file_prefix));
   {
@@ -211,33 +448,21 @@ SortedFiles::SortedFiles(const Config &config, util::FilePiece &f, std::vector<u
   mem.reset(malloc(buffer));
   if (!mem.get()) UTIL_THROW(util::ErrnoException, "malloc failed for sort buffer size " << buffer);
 
+  std::deque<FILE*> files[KENLM_MAX_ORDER - 1], contexts[KENLM_MAX_ORDER - 1];
+  Closer files_closer(files, counts.size() - 1), contexts_closer(contexts, counts.size() - 1);
+  // Declared after the files so it waits for merges before they are closed.
+  util::TaskGroup merging;
   for (unsigned char order = 2; order <= counts.size(); ++order) {
-    ConvertToSorted(f, vocab, counts, file_prefix, order, warn, mem.get(), buffer);
+    ConvertToSorted(f, vocab, counts, file_prefix, order, warn, mem.get(), buffer, files[order - 2], contexts[order - 2]);
+    const size_t weights_size = sizeof(float) + ((order == counts.size()) ? 0 : sizeof(float));
+    merging.Start(boost::bind(&MergeBatches<ThrowCombine>, boost::ref(files[order - 2]), boost::cref(file_prefix), weights_size, order, boost::ref(full_[order - 2])));
+    merging.Start(boost::bind(&MergeBatches<FirstCombine>, boost::ref(contexts[order - 2]), boost::cref(file_prefix), 0, order - 1, boost::ref(context_[order - 2])));
   }
   ReadEnd(f);
+  merging.Join();
 }
 
-namespace {
-class Closer {
-  public:
-    explicit Closer(std::deque<FILE*> &files) : files_(files) {}
-
-    ~Closer() {
-      for (std::deque<FILE*>::iterator i = files_.begin(); i != files_.end(); ++i) {
-        util::scoped_FILE deleter(*i);
-      }
-    }
-
-    void PopFront() {
-      util::scoped_FILE deleter(files_.front());
-      files_.pop_front();
-    }
-  private:
-    std::deque<FILE*> &files_;
-};
-} // namespace
-
-void SortedFiles::ConvertToSorted(util::FilePiece &f, const SortedVocabulary &vocab, const std::vector<uint64_t> &counts, const std::string &file_prefix, unsigned char order, PositiveProbWarn &warn, void *mem, std::size_t mem_size) {
+template <class Source> void SortedFiles::ConvertToSorted(Source &f, const SortedVocabulary &vocab, const std::vector<uint64_t> &counts, const std::string &file_prefix, unsigned char order, PositiveProbWarn &warn, void *mem, std::size_t mem_size, std::deque<FILE*> &files, std::deque<FILE*> &contexts) {
   ReadNGramHeader(f, order);
   const size_t count = counts[order - 1];
   // Size of weights.  Does it include backoff?  
@@ -247,56 +472,18 @@ void SortedFiles::ConvertToSorted(util::FilePiece &f, const SortedVocabulary &vo
   const size_t batch_size = std::min(count, mem_size / entry_size);
   uint8_t *const begin = reinterpret_cast<uint8_t*>(mem);
 
-  std::deque<FILE*> files, contexts;
-  Closer files_closer(files), contexts_closer(contexts);
-
   for (std::size_t batch = 0, done = 0; done < count; ++batch) {
-    uint8_t *out = begin;
-    uint8_t *out_end = out + std::min(count - done, batch_size) * entry_size;
+    uint8_t *out_end = begin + std::min(count - done, batch_size) * entry_size;
     if (order == counts.size()) {
-      for (; out != out_end; out += entry_size) {
-        std::reverse_iterator<WordIndex*> it(reinterpret_cast<WordIndex*>(out) + order);
-        ReadNGram(f, order, vocab, it, *reinterpret_cast<Prob*>(out + words_size), warn);
-      }
+      FillBatch<Prob>(f, vocab, order, begin, out_end, entry_size, warn);
     } else {
-      for (; out != out_end; out += entry_size) {
-        std::reverse_iterator<WordIndex*> it(reinterpret_cast<WordIndex*>(out) + order);
-        ReadNGram(f, order, vocab, it, *reinterpret_cast<ProbBackoff*>(out + words_size), warn);
-      }
+      FillBatch<ProbBackoff>(f, vocab, order, begin, out_end, entry_size, warn);
     }
     // Sort full records by full n-gram.  
-    util::SizedProxy proxy_begin(begin, entry_size), proxy_end(out_end, entry_size);
-    // parallel_sort uses too much RAM.  TODO: figure out why windows sort doesn't like my proxies.  
-#if defined(_WIN32) || defined(_WIN64)
-    std::stable_sort
-#else
-    std::sort
-#endif
-        (NGramIter(proxy_begin), NGramIter(proxy_end), util::SizedCompare<EntryCompare>(EntryCompare(order)));
-    files.push_back(DiskFlush(begin, out_end, file_prefix));
-    contexts.push_back(WriteContextFile(begin, out_end, file_prefix, entry_size, order));
+    SortBatch(begin, out_end, entry_size, order, file_prefix, files, contexts);
 
     done += (out_end - begin) / entry_size;
   }
-
-  // All individual files created.  Merge them.  
-
-  while (files.size() > 1) {
-    files.push_back(MergeSortedFiles(files[0], files[1], file_prefix, weights_size, order, ThrowCombine()));
-    files_closer.PopFront();
-    files_closer.PopFront();
-    contexts.push_back(MergeSortedFiles(contexts[0], contexts[1], file_prefix, 0, order - 1, FirstCombine()));
-    contexts_closer.PopFront();
-    contexts_closer.PopFront();
-  }
-
-  if (!files.empty()) {
-    // Steal from closers.
-    full_[order - 2].reset(files.front());
-    files.pop_front();
-    context_[order - 2].reset(contexts.front());
-    contexts.pop_front();
-  }
 }
 
 } // namespace trie
@@ -10,6 +10,8 @@
 #include "util/scoped.hh"
 
 #include <cstddef>
+#include <cstdio>
+#include <deque>
 #include <functional>
 #include <string>
 #include <vector>
@@ -21,6 +23,7 @@ class FilePiece;
 } // namespace util
 
 namespace lm {
+class NGramSource;
 class PositiveProbWarn;
 namespace ngram {
 class SortedVocabulary;
@@ -87,6 +90,9 @@ class SortedFiles {
     // Build from ARPA
     SortedFiles(const Config &config, util::FilePiece &f, std::vector<uint64_t> &counts, std::size_t buffer, const std::string &file_prefix, SortedVocabulary &vocab);
 
+    // Build from a source of n-grams.
+    SortedFiles(const Config &config, NGramSource &f, std::vector<uint64_t> &counts, std::size_t buffer, const std::string &file_prefix, SortedVocabulary &vocab);
+
     int StealUnigram() {
       return unigram_.release();
     }
@@ -100,7 +106,11 @@ class SortedFiles {
     }
 
   private:
-    void ConvertToSorted(util::FilePiece &f, const SortedVocabulary &vocab, const std::vector<uint64_t> &counts, const std::string &prefix, unsigned char order, PositiveProbWarn &warn, void *mem, std::size_t mem_size);
+    // Source is util::FilePiece or NGramSource.
+    template <class Source> void Init(const Config &config, Source &f, std::vector<uint64_t> &counts, std::size_t buffer, const std::string &file_prefix, SortedVocabulary &vocab);
+
+    // Sorts batches of the order's n-grams into files and their contexts into contexts, which Init merges.
+    template <class Source> void ConvertToSorted(Source &f, const SortedVocabulary &vocab, const std::vector<uint64_t> &counts, const std::string &prefix, unsigned char order, PositiveProbWarn &warn, void *mem, std::size_t mem_size, std::deque<FILE*> &files, std::deque<FILE*> &contexts);
     
     util::scoped_fd unigram_;
 
@@ -140,6 +140,7 @@ int main(int argc, char** argv)
 
 #ifdef WITH_THREADS
     ThreadPool pool(staticData.ThreadCount());
+    pool.SetLongestFirst(staticData.ThreadsLongestFirst());
 #endif
 
     // main loop over set of input sentences
@@ -153,6 +154,9 @@ int main(int argc, char** argv)
 
       FeatureFunction::CallChangeSource(source);
 
+      // don't read too far ahead of the output
+      ioWrapper->WaitForReorderWindow(lineCount);
+
       // set up task of translating one sentence
       TranslationTask* task = new TranslationTask(source, *ioWrapper);
 
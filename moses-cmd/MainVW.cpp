@@ -140,6 +140,7 @@ int main(int argc, char** argv)
 
 #ifdef WITH_THREADS
     ThreadPool pool(staticData.ThreadCount());
+    pool.SetLongestFirst(staticData.ThreadsLongestFirst());
 #endif
 
     // main loop over set of input sentences
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <vector>
 
 #include "StaticData.h"
@@ -9,6 +10,17 @@ using namespace std;
 
 namespace Moses
 {
+BaseManager::BaseManager(const InputType &source)
+  :m_source(source)
+  ,m_threadsPerSentence(StaticData::Instance().GetThreadsPerSentence())
+{
+}
+
+void BaseManager::SetThreadsPerSentence(size_t threads)
+{
+  m_threadsPerSentence = std::max<size_t>(1, std::min(threads, StaticData::Instance().GetThreadsPerSentence()));
+}
+
 /***
  * print surface factor only for the given phrase
  */
@@ -15,10 +15,9 @@ class BaseManager
 {
 protected:
   const InputType &m_source; /**< source sentence to be translated */
+  size_t m_threadsPerSentence; /**< threads decoding this input, including the calling one */
 
-  BaseManager(const InputType &source)
-    :m_source(source) {
-  }
+  BaseManager(const InputType &source);
 
   // output
   typedef std::vector<std::pair<Moses::Word, Moses::WordsRange> > ApplicationContext;
@@ -53,6 +52,13 @@ public:
     return m_source;
   }
 
+  /** decode with up to threads threads, including the calling one. Default
+   * and maximum is -threads-per-sentence. Call before Decode() */
+  void SetThreadsPerSentence(size_t threads);
+  size_t GetThreadsPerSentence() const {
+    return m_threadsPerSentence;
+  }
+
   virtual void Decode() = 0;
   // outputs
   virtual void OutputBest(OutputCollector *collector) const = 0;
@@ -110,13 +110,13 @@ public:
 BackwardsEdge::BackwardsEdge(const BitmapContainer &prevBitmapContainer
                              , BitmapContainer &parent
                              , const TranslationOptionList &translations
-                             , const SquareMatrix &futureScore,
+                             , float parentFutureScore,
                              const InputType& itype)
   : m_initialized(false)
   , m_prevBitmapContainer(prevBitmapContainer)
   , m_parent(parent)
   , m_translations(translations)
-  , m_futurescore(futureScore)
+  , m_parentFutureScore(parentFutureScore)
   , m_seenPosition()
 {
 
@@ -211,7 +211,7 @@ Hypothesis *BackwardsEdge::CreateHypothesis(const Hypothesis &hypothesis, const
   IFVERBOSE(2) {
     hypothesis.GetManager().GetSentenceStats().StopTimeBuildHyp();
   }
-  newHypo->EvaluateWhenApplied(m_futurescore);
+  newHypo->EvaluateWhenApplied(m_parentFutureScore);
 
   return newHypo;
 }
@@ -164,7 +164,7 @@ private:
   const BitmapContainer &m_prevBitmapContainer;
   BitmapContainer &m_parent;
   const TranslationOptionList &m_translations;
-  const SquareMatrix &m_futurescore;
+  float m_parentFutureScore; /**< future score of the coverage every hypothesis on this edge has */
 
   std::vector< const Hypothesis* > m_hypotheses;
   boost::unordered_set< int > m_seenPosition;
@@ -183,7 +183,7 @@ public:
   BackwardsEdge(const BitmapContainer &prevBitmapContainer
                 , BitmapContainer &parent
                 , const TranslationOptionList &translations
-                , const SquareMatrix &futureScore,
+                , float parentFutureScore,
                 const InputType& source);
   ~BackwardsEdge();
 
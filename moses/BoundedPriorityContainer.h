@@ -1,12 +1,12 @@
 #pragma once
 
-#include <queue>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
 #include <vector>
 
 namespace Moses
 {
-namespace Syntax
-{
 
 // A container that can hold up to k objects of type T, each with an associated
 // priority.  The container accepts new elements unconditionally until the
@@ -18,9 +18,13 @@ namespace Syntax
 //
 // BoundedPriorityContainer pre-allocates space for all k objects.
 //
-// (Although BoundedPriorityContainer is implemented using a priority queue,
-// it doesn't provide the interface of a priority queue, hence the generic
-// name 'container'.)
+// The worst element is found with a min-heap of (priority, index) pairs that
+// is kept in a vector.  Displacing the worst element overwrites the root and
+// sifts it down in place, and LazyClear() just forgets the heap contents, so
+// a container reused for many cells never reallocates.
+//
+// It is used both for the hyperedge bundles of the S2T decoder and for beam
+// pruning in ChartHypothesisCollection.
 template<typename T>
 class BoundedPriorityContainer
 {
@@ -51,16 +55,9 @@ public:
 
   // 'Lazily' clear the container by setting the size to 0 (allowing elements
   // to be overwritten).
-  // TODO Eliminate heap-reorganisation overhead by using a vector-based heap
-  // TODO directly instead of priority_queue, which requires pop() to clear
-  // TODO Alternative, is to clear m_queue by assigning an empty queue value
-  // TODO but that might incur an alloc-related overhead when the new underlying
-  // TODO has to be regrown.
   void LazyClear() {
     m_size = 0;
-    while (!m_queue.empty()) {
-      m_queue.pop();
-    }
+    m_heap.clear();
   }
 
   // Insert the given object iff
@@ -82,12 +79,18 @@ public:
 
   // Determine if an object with the given priority would be accepted for
   // insertion based on the current contents of the container.
-  bool WouldAccept(float priority) {
-    return m_size < m_limit || priority > m_queue.top().first;
+  bool WouldAccept(float priority) const {
+    return m_size < m_limit || (m_size > 0 && priority > m_heap.front().first);
+  }
+
+  // Return the lowest priority currently held.  Must not be called when the
+  // container is empty.
+  float WorstPriority() const {
+    return m_heap.front().first;
   }
 
 private:
-  typedef std::pair<float, int> PriorityIndexPair;
+  typedef std::pair<float, std::size_t> PriorityIndexPair;
 
   class PriorityIndexPairOrderer
   {
@@ -98,11 +101,8 @@ private:
     }
   };
 
-  // Min-priority queue.  The queue stores the indices of the elements, not
-  // the elements themselves to keep down the costs of heap maintenance.
-  typedef std::priority_queue<PriorityIndexPair,
-          std::vector<PriorityIndexPair>,
-          PriorityIndexPairOrderer> Queue;
+  // Give the root a new priority and restore the heap property.
+  void ReplaceWorst(float priority);
 
   // The elements are stored in a vector.  Note that the size of this vector
   // can be greater than m_size (after a call to LazyClear).
@@ -114,8 +114,9 @@ private:
   // The maximum number of elements.
   const std::size_t m_limit;
 
-  // The min-priority queue.
-  Queue m_queue;
+  // Min-heap of the priorities and indices of the elements (the elements
+  // themselves are not moved, to keep down the costs of heap maintenance).
+  std::vector<PriorityIndexPair> m_heap;
 };
 
 template<typename T>
@@ -124,14 +125,34 @@ BoundedPriorityContainer<T>::BoundedPriorityContainer(std::size_t limit)
   , m_limit(limit)
 {
   m_elements.reserve(m_limit);
+  m_heap.reserve(m_limit);
+}
+
+template<typename T>
+void BoundedPriorityContainer<T>::ReplaceWorst(float priority)
+{
+  PriorityIndexPair root(priority, m_heap.front().second);
+  const std::size_t size = m_heap.size();
+  std::size_t hole = 0;
+  for (std::size_t child = 1; child < size; child = 2 * hole + 1) {
+    if (child + 1 < size && m_heap[child + 1].first < m_heap[child].first) {
+      ++child;
+    }
+    if (!(m_heap[child].first < root.first)) {
+      break;
+    }
+    m_heap[hole] = m_heap[child];
+    hole = child;
+  }
+  m_heap[hole] = root;
 }
 
 template<typename T>
 bool BoundedPriorityContainer<T>::Insert(const T &t, float priority)
 {
   if (m_size < m_limit) {
-    PriorityIndexPair pair(priority, m_size);
-    m_queue.push(pair);
+    m_heap.push_back(PriorityIndexPair(priority, m_size));
+    std::push_heap(m_heap.begin(), m_heap.end(), PriorityIndexPairOrderer());
     if (m_size < m_elements.size()) {
       m_elements[m_size] = t;
     } else {
@@ -139,12 +160,9 @@ bool BoundedPriorityContainer<T>::Insert(const T &t, float priority)
     }
     ++m_size;
     return true;
-  } else if (priority > m_queue.top().first) {
-    PriorityIndexPair pair = m_queue.top();
-    m_queue.pop();
-    pair.first = priority;
-    m_elements[pair.second] = t;
-    m_queue.push(pair);
+  } else if (m_size > 0 && priority > m_heap.front().first) {
+    m_elements[m_heap.front().second] = t;
+    ReplaceWorst(priority);
     return true;
   }
   return false;
@@ -154,8 +172,8 @@ template<typename T>
 bool BoundedPriorityContainer<T>::SwapIn(T &t, float priority)
 {
   if (m_size < m_limit) {
-    PriorityIndexPair pair(priority, m_size);
-    m_queue.push(pair);
+    m_heap.push_back(PriorityIndexPair(priority, m_size));
+    std::push_heap(m_heap.begin(), m_heap.end(), PriorityIndexPairOrderer());
     if (m_size < m_elements.size()) {
       swap(m_elements[m_size], t);
     } else {
@@ -163,16 +181,12 @@ bool BoundedPriorityContainer<T>::SwapIn(T &t, float priority)
     }
     ++m_size;
     return true;
-  } else if (priority > m_queue.top().first) {
-    PriorityIndexPair pair = m_queue.top();
-    m_queue.pop();
-    pair.first = priority;
-    swap(m_elements[pair.second], t);
-    m_queue.push(pair);
+  } else if (m_size > 0 && priority > m_heap.front().first) {
+    swap(m_elements[m_heap.front().second], t);
+    ReplaceWorst(priority);
     return true;
   }
   return false;
 }
 
-}  // Syntax
 }  // Moses
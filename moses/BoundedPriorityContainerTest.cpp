@@ -0,0 +1,67 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "BoundedPriorityContainer.h"
+
+using namespace Moses;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(bounded_priority_container)
+
+BOOST_AUTO_TEST_CASE(keeps_best)
+{
+  BoundedPriorityContainer<int> container(10);
+  vector<int> all;
+  srand(7);
+  for (size_t i = 0; i < 1000; ++i) {
+    int value = rand() % 500;
+    all.push_back(value);
+    bool accept = container.WouldAccept(value);
+    BOOST_CHECK_EQUAL(container.Insert(value, value), accept);
+  }
+  BOOST_CHECK_EQUAL(container.Size(), 10);
+
+  sort(all.begin(), all.end(), greater<int>());
+  vector<int> kept(container.Begin(), container.End());
+  sort(kept.begin(), kept.end(), greater<int>());
+  BOOST_CHECK_EQUAL_COLLECTIONS(kept.begin(), kept.end(), all.begin(), all.begin() + 10);
+  BOOST_CHECK_EQUAL(container.WorstPriority(), all[9]);
+}
+
+BOOST_AUTO_TEST_CASE(lazy_clear)
+{
+  BoundedPriorityContainer<int> container(2);
+  container.Insert(5, 5);
+  container.Insert(6, 6);
+  BOOST_CHECK(!container.Insert(1, 1));
+  container.LazyClear();
+  BOOST_CHECK_EQUAL(container.Size(), 0);
+  BOOST_CHECK(container.Insert(1, 1));
+  BOOST_CHECK_EQUAL(container.WorstPriority(), 1);
+  BOOST_CHECK_EQUAL(*container.Begin(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <vector>
+#include <boost/functional/hash.hpp>
 #include "ChartHypothesis.h"
 #include "RuleCubeItem.h"
 #include "ChartCell.h"
@@ -207,29 +208,58 @@ int ChartHypothesis::RecombineCompare(const ChartHypothesis &compare) const
   return 0;
 }
 
+size_t ChartHypothesis::RecombineHash() const
+{
+  size_t seed = 0;
+  for (unsigned i = 0; i < m_ffStates.size(); ++i) {
+    if (m_ffStates[i]) {
+      boost::hash_combine(seed, m_ffStates[i]->hash());
+    } else {
+      boost::hash_combine(seed, 0);
+    }
+  }
+  return seed;
+}
+
 /** calculate total score */
 void ChartHypothesis::EvaluateWhenApplied()
 {
-  const StaticData &staticData = StaticData::Instance();
-
   // compute values of stateless feature functions that were not
   // cached in the translation option-- there is no principled distinction
   const std::vector<const StatelessFeatureFunction*>& sfs =
     StatelessFeatureFunction::GetStatelessFeatureFunctions();
   for (unsigned i = 0; i < sfs.size(); ++i) {
-    if (! staticData.IsFeatureFunctionIgnored( *sfs[i] )) {
-      sfs[i]->EvaluateWhenApplied(*this,&m_currScoreBreakdown);
-    }
+    EvaluateWhenApplied(*sfs[i]);
   }
 
   const std::vector<const StatefulFeatureFunction*>& ffs =
     StatefulFeatureFunction::GetStatefulFeatureFunctions();
   for (unsigned i = 0; i < ffs.size(); ++i) {
-    if (! staticData.IsFeatureFunctionIgnored( *ffs[i] )) {
-      m_ffStates[i] = ffs[i]->EvaluateWhenApplied(*this,i,&m_currScoreBreakdown);
-    }
+    EvaluateWhenApplied(*ffs[i], i);
+  }
+
+  EvaluateTotalScore();
+}
+
+void ChartHypothesis::EvaluateWhenApplied(const StatefulFeatureFunction &sfff,
+    int featureID)
+{
+  const StaticData &staticData = StaticData::Instance();
+  if (! staticData.IsFeatureFunctionIgnored( sfff )) {
+    m_ffStates[featureID] = sfff.EvaluateWhenApplied(*this, featureID, &m_currScoreBreakdown);
+  }
+}
+
+void ChartHypothesis::EvaluateWhenApplied(const StatelessFeatureFunction &slff)
+{
+  const StaticData &staticData = StaticData::Instance();
+  if (! staticData.IsFeatureFunctionIgnored( slff )) {
+    slff.EvaluateWhenApplied(*this, &m_currScoreBreakdown);
   }
+}
 
+void ChartHypothesis::EvaluateTotalScore()
+{
   // total score from current translation rule
   m_totalScore = GetTranslationOption().GetScores().GetWeightedScore();
   m_totalScore += m_currScoreBreakdown.GetWeightedScore();
@@ -241,6 +271,32 @@ void ChartHypothesis::EvaluateWhenApplied()
   }
 }
 
+void ChartHypothesis::EvaluateWhenAppliedBatch(const std::vector<ChartHypothesis*> &hypos)
+{
+  const StaticData &staticData = StaticData::Instance();
+  std::vector<ChartHypothesis*>::const_iterator iter;
+
+  const std::vector<const StatelessFeatureFunction*>& sfs =
+    StatelessFeatureFunction::GetStatelessFeatureFunctions();
+  for (unsigned i = 0; i < sfs.size(); ++i) {
+    for (iter = hypos.begin(); iter != hypos.end(); ++iter) {
+      (*iter)->EvaluateWhenApplied(*sfs[i]);
+    }
+  }
+
+  const std::vector<const StatefulFeatureFunction*>& ffs =
+    StatefulFeatureFunction::GetStatefulFeatureFunctions();
+  for (unsigned i = 0; i < ffs.size(); ++i) {
+    if (! staticData.IsFeatureFunctionIgnored( *ffs[i] )) {
+      ffs[i]->EvaluateWhenAppliedBatch(hypos, i);
+    }
+  }
+
+  for (iter = hypos.begin(); iter != hypos.end(); ++iter) {
+    (*iter)->EvaluateTotalScore();
+  }
+}
+
 void ChartHypothesis::AddArc(ChartHypothesis *loserHypo)
 {
   if (!m_arcList) {
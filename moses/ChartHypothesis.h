@@ -37,6 +37,8 @@ class ChartHypothesis;
 class ChartManager;
 class RuleCubeItem;
 class FFState;
+class StatefulFeatureFunction;
+class StatelessFeatureFunction;
 
 typedef std::vector<ChartHypothesis*> ChartArcList;
 
@@ -147,8 +149,17 @@ public:
   void GetOutputPhrase(size_t leftRightMost, size_t numWords, Phrase &outPhrase) const;
 
   int RecombineCompare(const ChartHypothesis &compare) const;
+  //! hash consistent with RecombineCompare(): equal hypos have equal hashes
+  size_t RecombineHash() const;
 
   void EvaluateWhenApplied();
+  void EvaluateWhenApplied(const StatefulFeatureFunction &sfff, int featureID);
+  void EvaluateWhenApplied(const StatelessFeatureFunction &slff);
+  void EvaluateTotalScore();
+
+  /** same as EvaluateWhenApplied() on each hypothesis, but each stateful
+   * feature function sees the whole batch, so it can prefetch */
+  static void EvaluateWhenAppliedBatch(const std::vector<ChartHypothesis*> &hypos);
 
   void AddArc(ChartHypothesis *loserHypo);
   void CleanupArcList();
@@ -22,6 +22,7 @@
 #include <algorithm>
 #include "StaticData.h"
 #include "ChartHypothesisCollection.h"
+#include "BoundedPriorityContainer.h"
 #include "ChartHypothesis.h"
 #include "ChartManager.h"
 #include "HypergraphOutput.h"
@@ -194,29 +195,21 @@ void ChartHypothesisCollection::PruneToSize(ChartManager &manager)
   if (m_maxHypoStackSize == 0) return; // no limit
 
   if (GetSize() > m_maxHypoStackSize) { // ok, if not over the limit
-    priority_queue<float> bestScores;
-
-    // push all scores to a heap
+    // keep the best m_maxHypoStackSize scores in a bounded min-heap
     // (but never push scores below m_bestScore+m_beamWidth)
-    HCType::iterator iter = m_hypos.begin();
-    float score = 0;
-    while (iter != m_hypos.end()) {
+    BoundedPriorityContainer<ChartHypothesis*> bestHypos(m_maxHypoStackSize);
+    HCType::iterator iter;
+    for (iter = m_hypos.begin(); iter != m_hypos.end(); ++iter) {
       ChartHypothesis *hypo = *iter;
-      score = hypo->GetTotalScore();
+      float score = hypo->GetTotalScore();
       if (score > m_bestScore+m_beamWidth) {
-        bestScores.push(score);
+        bestHypos.Insert(hypo, score);
       }
-      ++iter;
     }
+    if (bestHypos.Size() == 0) return;
 
-    // pop the top newSize scores (and ignore them, these are the scores of hyps that will remain)
-    //  ensure to never pop beyond heap size
-    size_t minNewSizeHeapSize = m_maxHypoStackSize > bestScores.size() ? bestScores.size() : m_maxHypoStackSize;
-    for (size_t i = 1 ; i < minNewSizeHeapSize ; i++)
-      bestScores.pop();
-
-    // and remember the threshold
-    float scoreThreshold = bestScores.top();
+    // the worst of those is the threshold
+    float scoreThreshold = bestHypos.WorstPriority();
 
     // delete all hypos under score threshold
     iter = m_hypos.begin();
@@ -246,9 +239,9 @@ void ChartHypothesisCollection::PruneToSize(ChartManager &manager)
     if (m_hypos.size() > m_maxHypoStackSize * 2) {
       std::vector<ChartHypothesis*> hyposOrdered;
 
-      // sort hypos
+      // partition hypos: the best |size| go first
       std::copy(m_hypos.begin(), m_hypos.end(), std::inserter(hyposOrdered, hyposOrdered.end()));
-      std::sort(hyposOrdered.begin(), hyposOrdered.end(), ChartHypothesisScoreOrderer());
+      std::nth_element(hyposOrdered.begin(), hyposOrdered.begin() + (m_maxHypoStackSize * 2), hyposOrdered.end(), ChartHypothesisScoreOrderer());
 
       //keep only |size|. delete the rest
       std::vector<ChartHypothesis*>::iterator iter;
@@ -20,8 +20,8 @@
  ***********************************************************************/
 #pragma once
 
-#include <set>
 #include "ChartHypothesis.h"
+#include "RecombinationTable.h"
 #include "RuleCube.h"
 
 
@@ -60,6 +60,29 @@ public:
   }
 };
 
+//! hash and equality for recombining (chart) hypotheses in a RecombinationTable
+class ChartHypothesisRecombinationHasher
+{
+public:
+  size_t operator()(const ChartHypothesis* hypo) const {
+    return hypo->RecombineHash();
+  }
+};
+
+class ChartHypothesisRecombinationEqual
+{
+public:
+  bool operator()(const ChartHypothesis* hypoA, const ChartHypothesis* hypoB) const {
+    // assert in same cell
+    assert(hypoA->GetCurrSourceRange() == hypoB->GetCurrSourceRange());
+
+    // shouldn't be mixing hypos with different lhs
+    assert(hypoA->GetTargetLHS() == hypoB->GetTargetLHS());
+
+    return hypoA->RecombineCompare(*hypoB) == 0;
+  }
+};
+
 /** Contains a set of unique hypos that have the same HS non-term.
   * ie. 1 of these for each target LHS in each cell
   */
@@ -68,7 +91,7 @@ class ChartHypothesisCollection
   friend std::ostream& operator<<(std::ostream&, const ChartHypothesisCollection&);
 
 protected:
-  typedef std::set<ChartHypothesis*, ChartHypothesisRecombinationOrderer> HCType;
+  typedef RecombinationTable<ChartHypothesis*, ChartHypothesisRecombinationHasher, ChartHypothesisRecombinationEqual> HCType;
   HCType m_hypos;
   HypoList m_hyposOrdered;
 
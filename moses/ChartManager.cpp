@@ -34,6 +34,7 @@
 #include "moses/OutputCollector.h"
 #include "moses/ChartKBestExtractor.h"
 #include "moses/HypergraphOutput.h"
+#include "moses/ThreadPool.h"
 
 using namespace std;
 
@@ -76,29 +77,33 @@ void ChartManager::Decode()
 
   AddXmlChartOptions();
 
-  // MAIN LOOP
   size_t size = m_source.GetSize();
-  for (int startPos = size-1; startPos >= 0; --startPos) {
-    for (size_t width = 1; width <= size-startPos; ++width) {
-      size_t endPos = startPos + width - 1;
-      WordsRange range(startPos, endPos);
-
-      // create trans opt
-      m_translationOptionList.Clear();
-      m_parser.Create(range, m_translationOptionList);
-      m_translationOptionList.ApplyThreshold();
 
-      const InputPath &inputPath = m_parser.GetInputPath(range);
-      m_translationOptionList.EvaluateWithSourceContext(m_source, inputPath);
-
-      // decode
-      ChartCell &cell = m_hypoStackColl.Get(range);
-      cell.Decode(m_translationOptionList, m_hypoStackColl);
+  bool decodedByWidth = false;
+#ifdef WITH_THREADS
+  ThreadPool *pool = StaticData::Instance().GetSentenceThreadPool();
+  if (pool && m_threadsPerSentence > 1 && size > 1) {
+    if (!m_parser.SupportsConcurrentLookup()) {
+      VERBOSE(1, "Rule tables don't support concurrent lookup, decoding chart cells serially" << endl);
+    } else if (!FeatureFunction::AllSupportConcurrentSourceContextEvaluation() ||
+               !FeatureFunction::AllSupportConcurrentEvaluationWhenApplied()) {
+      // features that keep per-input state in InitializeForInput(), e.g. in
+      // thread local storage, only see it on this thread
+      VERBOSE(1, "Features need to be evaluated on the decoding thread, decoding chart cells serially" << endl);
+    } else {
+      DecodeByWidth(*pool);
+      decodedByWidth = true;
+    }
+  }
+#endif
 
-      m_translationOptionList.Clear();
-      cell.PruneToSize();
-      cell.CleanupArcList();
-      cell.SortHypotheses();
+  if (!decodedByWidth) {
+    // MAIN LOOP. The rule lookup managers rely on this order
+    for (int startPos = size-1; startPos >= 0; --startPos) {
+      for (size_t width = 1; width <= size-startPos; ++width) {
+        size_t endPos = startPos + width - 1;
+        DecodeCell(WordsRange(startPos, endPos), m_translationOptionList, false);
+      }
     }
   }
 
@@ -123,6 +128,108 @@ void ChartManager::Decode()
   }
 }
 
+//! fill one chart cell. All cells inside range must have been decoded
+void ChartManager::DecodeCell(const WordsRange &range, ChartTranslationOptionList &transOptList, bool concurrent)
+{
+  // create trans opt
+  transOptList.Clear();
+  if (concurrent) {
+    m_parser.CreateConcurrent(range, transOptList);
+  } else {
+    m_parser.Create(range, transOptList);
+  }
+  transOptList.ApplyThreshold();
+
+  const InputPath &inputPath = m_parser.GetInputPath(range);
+  transOptList.EvaluateWithSourceContext(m_source, inputPath);
+
+  // decode
+  ChartCell &cell = m_hypoStackColl.Get(range);
+  cell.Decode(transOptList, m_hypoStackColl);
+
+  transOptList.Clear();
+  cell.PruneToSize();
+  cell.CleanupArcList();
+  cell.SortHypotheses();
+
+  if (concurrent) {
+    // rule lookup for wider cells caches the best score of each label on first use.
+    // Do it now, while no other thread reads this cell
+    const ChartCellLabelSet &labels = cell.GetTargetLabelSet();
+    for (ChartCellLabelSet::const_iterator iter = labels.begin(); iter != labels.end(); ++iter) {
+      if (*iter) {
+        (*iter)->GetBestScore(&transOptList);
+      }
+    }
+  }
+}
+
+#ifdef WITH_THREADS
+/** decodes every stride-th cell of the current width, from startPos first.
+ * Keeps its own translation option list between widths */
+class ChartManager::CellTask : public Task
+{
+public:
+  CellTask(ChartManager &manager, size_t startPos, size_t stride)
+    : m_manager(manager)
+    , m_startPos(startPos)
+    , m_stride(stride)
+    , m_width(0)
+    , m_transOptList(StaticData::Instance().GetRuleLimit(), manager.m_source) {}
+
+  void SetWidth(size_t width) {
+    m_width = width;
+  }
+
+  virtual void Run() {
+    const size_t size = m_manager.m_source.GetSize();
+    for (size_t startPos = m_startPos; startPos + m_width <= size; startPos += m_stride) {
+      WordsRange range(startPos, startPos + m_width - 1);
+      m_manager.DecodeCell(range, m_transOptList, true);
+    }
+  }
+
+  virtual bool DeleteAfterExecution() {
+    return false;
+  }
+
+private:
+  ChartManager &m_manager;
+  size_t m_startPos, m_stride, m_width;
+  ChartTranslationOptionList m_transOptList;
+};
+
+/** cells of one width only depend on narrower cells, so decode them in
+ * parallel, one width at a time */
+void ChartManager::DecodeByWidth(ThreadPool &pool)
+{
+  const size_t size = m_source.GetSize();
+  const size_t numTasks = std::min(m_threadsPerSentence, size);
+
+  std::vector<CellTask*> tasks;
+  for (size_t i = 0; i < numTasks; ++i) {
+    tasks.push_back(new CellTask(*this, i, numTasks));
+  }
+
+  std::vector<Task*> batch;
+  for (size_t width = 1; width <= size; ++width) {
+    const size_t numCells = size - width + 1;
+    batch.clear();
+    for (size_t i = 0; i < numTasks && i < numCells; ++i) {
+      tasks[i]->SetWidth(width);
+      batch.push_back(tasks[i]);
+    }
+    if (batch.size() == 1) {
+      batch[0]->Run();
+    } else {
+      pool.RunAndWait(batch);
+    }
+  }
+
+  RemoveAllInColl(tasks);
+}
+#endif
+
 /** add specific translation options and hypotheses according to the XML override translation scheme.
  *  Doesn't seem to do anything about walls and zones.
  *  @todo check walls & zones. Check that the implementation doesn't leak, xml options sometimes does if you're not careful
@@ -304,10 +411,10 @@ void ChartManager::OutputSearchGraphMoses(std::ostream &outputSearchGraphStream)
 
 void ChartManager::OutputBest(OutputCollector *collector) const
 {
+  // write a line even without a translation, or later output waits forever
   const ChartHypothesis *bestHypo = GetBestHypothesis();
-  if (collector && bestHypo) {
+  if (collector) {
     const size_t translationId = m_source.GetTranslationId();
-    const ChartHypothesis *bestHypo = GetBestHypothesis();
     OutputBestHypo(collector, bestHypo, translationId);
   }
 }
@@ -34,12 +34,18 @@
 #include "moses/Syntax/KBestExtractor.h"
 
 #include <boost/shared_ptr.hpp>
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
 
 namespace Moses
 {
 
 class ChartHypothesis;
 class ChartSearchGraphWriter;
+#ifdef WITH_THREADS
+class ThreadPool;
+#endif
 
 /** Holds everything you need to decode 1 sentence with the hierachical/syntax decoder
  */
@@ -50,11 +56,20 @@ private:
   std::auto_ptr<SentenceStats> m_sentenceStats;
   clock_t m_start; /**< starting time, used for logging */
   unsigned m_hypothesisId; /* For handing out hypothesis ids to ChartHypothesis */
+#ifdef WITH_THREADS
+  boost::mutex m_hypothesisIdMutex;
+#endif
 
   ChartParser m_parser;
 
   ChartTranslationOptionList m_translationOptionList; /**< pre-computed list of translation options for the phrases in this sentence */
 
+  void DecodeCell(const WordsRange &range, ChartTranslationOptionList &transOptList, bool concurrent);
+#ifdef WITH_THREADS
+  class CellTask;
+  void DecodeByWidth(ThreadPool &pool);
+#endif
+
   /* auxilliary functions for SearchGraphs */
   void FindReachableHypotheses(
     const ChartHypothesis *hypo, std::map<unsigned,bool> &reachable , size_t* winners, size_t* losers) const;
@@ -135,6 +150,9 @@ public:
 
   //! contigious hypo id for each input sentence. For debugging purposes
   unsigned GetNextHypoId() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_hypothesisIdMutex);
+#endif
     return m_hypothesisId++;
   }
 
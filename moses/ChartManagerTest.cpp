@@ -0,0 +1,136 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2015 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#define BOOST_TEST_MODULE ChartManagerTest
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#include "moses/ChartManager.h"
+#include "moses/MockThreadLocalFeature.h"
+#include "moses/Parameter.h"
+#include "moses/Sentence.h"
+#include "moses/StaticData.h"
+
+using namespace Moses;
+using namespace MosesTest;
+using namespace std;
+
+namespace
+{
+
+/** hierarchical decoder with 4 threads per sentence, a tiny rule table and
+ * the usual glue rules */
+struct ConcurrentChartDecoder {
+  ConcurrentChartDecoder() {
+    m_dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directory(m_dir);
+    string rules = (m_dir / "rule-table").string();
+    string glue = (m_dir / "glue-grammar").string();
+    string config = (m_dir / "moses.ini").string();
+
+    ofstream rulesOut(rules.c_str());
+    rulesOut
+        << "a [X] ||| x [X] ||| 0.5 ||| ||| " << endl
+        << "b [X] ||| y [X] ||| 0.5 ||| ||| " << endl
+        << "a b [X] ||| x y [X] ||| 0.25 ||| ||| " << endl
+        << "a [X][X] b [X] ||| y [X][X] x [X] ||| 0.25 ||| 1-1 ||| " << endl;
+    rulesOut.close();
+    ofstream glueOut(glue.c_str());
+    glueOut
+        << "<s> [X] ||| <s> [S] ||| 1 ||| ||| " << endl
+        << "[X][S] </s> [X] ||| [X][S] </s> [S] ||| 1 ||| 0-0 ||| " << endl
+        << "[X][S] [X][X] [X] ||| [X][S] [X][X] [S] ||| 2.718 ||| 0-0 1-1 ||| " << endl;
+    glueOut.close();
+    ofstream configOut(config.c_str());
+    configOut
+        << "[search-algorithm]" << endl << "3" << endl
+        << "[input-factors]" << endl << "0" << endl
+        << "[mapping]" << endl << "0 T 0" << endl << "1 T 1" << endl
+        << "[max-chart-span]" << endl << "20" << endl << "1000" << endl
+        << "[non-terminals]" << endl << "X" << endl
+        << "[threads-per-sentence]" << endl << "4" << endl
+        << "[verbose]" << endl << "0" << endl
+        << "[feature]" << endl
+        << "UnknownWordPenalty" << endl
+        << "WordPenalty" << endl
+        << "PhraseDictionaryMemory name=TranslationModel0 num-features=1 path=" << rules
+        << " input-factor=0 output-factor=0" << endl
+        << "PhraseDictionaryMemory name=TranslationModel1 num-features=1 path=" << glue
+        << " input-factor=0 output-factor=0" << endl
+        << "[weight]" << endl
+        << "UnknownWordPenalty0= 1" << endl
+        << "WordPenalty0= -1" << endl
+        << "TranslationModel0= 0.2" << endl
+        << "TranslationModel1= 1" << endl;
+    configOut.close();
+
+    BOOST_REQUIRE(m_parameter.LoadParam(config));
+    BOOST_REQUIRE(StaticData::LoadDataStatic(&m_parameter, ""));
+    BOOST_REQUIRE(StaticData::Instance().GetSentenceThreadPool());
+  }
+
+  ~ConcurrentChartDecoder() {
+    boost::filesystem::remove_all(m_dir);
+  }
+
+  //! best translation and its score
+  string Decode(const string &text, size_t threads) {
+    vector<FactorType> factors(1, 0);
+    Sentence sentence;
+    istringstream in(text + "\n");
+    sentence.Read(in, factors);
+    ChartManager manager(sentence);
+    manager.SetThreadsPerSentence(threads);
+    manager.Decode();
+    const ChartHypothesis *best = manager.GetBestHypothesis();
+    BOOST_REQUIRE(best);
+    ostringstream out;
+    out << best->GetOutputPhrase() << "||| " << best->GetTotalScore();
+    return out.str();
+  }
+
+  boost::filesystem::path m_dir;
+  Parameter m_parameter;
+};
+
+BOOST_FIXTURE_TEST_CASE(decode_by_width, ConcurrentChartDecoder)
+{
+  // feature functions stay registered for the rest of the process
+  static MockThreadLocalFeature feature(false, false);
+  const string input("a b a b a b b a");
+
+  // a thread affine feature makes the cells decode serially
+  const string serial = Decode(input, 4);
+  BOOST_CHECK(feature.GetSourceContextCalls() > 0);
+  BOOST_CHECK_EQUAL(0, feature.GetSourceContextMissing());
+  BOOST_CHECK(feature.GetWhenAppliedCalls() > 0);
+  BOOST_CHECK_EQUAL(0, feature.GetWhenAppliedMissing());
+  BOOST_CHECK_EQUAL(serial, Decode(input, 1));
+
+  // cells of one width in parallel find the same translation
+  feature.SetConcurrent(true, true);
+  BOOST_CHECK_EQUAL(serial, Decode(input, 4));
+  BOOST_CHECK(feature.GetSourceContextMissing() > 0);
+}
+
+}
@@ -66,6 +66,9 @@ void ChartParserUnknown::Process(const Word &sourceWord, const WordsRange &range
   Word &newWord = unksrc->GetWord(0);
   newWord.SetIsOOV(true);
 
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_mutex);
+#endif
   m_unksrcs.push_back(unksrc);
 
   // hack. Once the OOV FF is a phrase table, get rid of this
@@ -176,6 +179,26 @@ ChartParser::~ChartParser()
 }
 
 void ChartParser::Create(const WordsRange &wordsRange, ChartParserCallback &to)
+{
+  Create(wordsRange, to, false);
+}
+
+bool ChartParser::SupportsConcurrentLookup() const
+{
+  for (size_t i = 0; i < m_ruleLookupManagers.size(); ++i) {
+    if (!m_ruleLookupManagers[i]->SupportsConcurrentLookup()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ChartParser::CreateConcurrent(const WordsRange &wordsRange, ChartParserCallback &to)
+{
+  Create(wordsRange, to, true);
+}
+
+void ChartParser::Create(const WordsRange &wordsRange, ChartParserCallback &to, bool concurrent)
 {
   assert(m_decodeGraphList.size() == m_ruleLookupManagers.size());
 
@@ -192,7 +215,11 @@ void ChartParser::Create(const WordsRange &wordsRange, ChartParserCallback &to)
     }
     if (maxSpan == 0 || wordsRange.GetNumWordsCovered() <= maxSpan) {
       const InputPath &inputPath = GetInputPath(wordsRange);
-      ruleLookupManager.GetChartRuleCollection(inputPath, last, to);
+      if (concurrent) {
+        ruleLookupManager.GetChartRuleCollectionConcurrent(inputPath, last, to);
+      } else {
+        ruleLookupManager.GetChartRuleCollection(inputPath, last, to);
+      }
     }
   }
 
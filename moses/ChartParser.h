@@ -27,6 +27,10 @@
 #include "StackVec.h"
 #include "InputPath.h"
 
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
+
 namespace Moses
 {
 
@@ -46,6 +50,7 @@ public:
   ChartParserUnknown();
   ~ChartParserUnknown();
 
+  //! thread-safe
   void Process(const Word &sourceWord, const WordsRange &range, ChartParserCallback &to);
 
   const std::vector<Phrase*> &GetUnknownSources() const {
@@ -55,6 +60,9 @@ public:
 private:
   std::vector<Phrase*> m_unksrcs;
   std::list<TargetPhraseCollection*> m_cacheTargetPhraseCollection;
+#ifdef WITH_THREADS
+  boost::mutex m_mutex; /**< guards m_unksrcs and m_cacheTargetPhraseCollection */
+#endif
 };
 
 class ChartParser
@@ -65,6 +73,14 @@ public:
 
   void Create(const WordsRange &range, ChartParserCallback &to);
 
+  //! true if every rule table can look up spans of equal width concurrently
+  bool SupportsConcurrentLookup() const;
+
+  /** like Create(), but can be called from several threads at once for spans
+   *  of equal width, once all narrower spans have been decoded.
+   *  Only if SupportsConcurrentLookup() */
+  void CreateConcurrent(const WordsRange &range, ChartParserCallback &to);
+
   //! the sentence being decoded
   //const Sentence &GetSentence() const;
   long GetTranslationId() const;
@@ -84,6 +100,7 @@ private:
   typedef std::vector< std::vector<InputPath*> > InputPathMatrix;
   InputPathMatrix	m_inputPathMatrix;
 
+  void Create(const WordsRange &range, ChartParserCallback &to, bool concurrent);
   void CreateInputPaths(const InputType &input);
   InputPath &GetInputPath(size_t startPos, size_t endPos);
 
@@ -23,6 +23,7 @@
 
 #include "ChartCellCollection.h"
 #include "InputType.h"
+#include "util/exception.hh"
 
 namespace Moses
 {
@@ -69,6 +70,22 @@ public:
     size_t lastPos,  // last position to consider if using lookahead
     ChartParserCallback &outColl) = 0;
 
+  //! whether GetChartRuleCollectionConcurrent() is implemented
+  virtual bool SupportsConcurrentLookup() const {
+    return false;
+  }
+
+  /** Like GetChartRuleCollection(), but keeps no state between spans. May
+   *  be called from several threads at once for spans of equal width, in
+   *  any order, once all narrower spans have been decoded.
+   */
+  virtual void GetChartRuleCollectionConcurrent(
+    const InputPath &inputPath,
+    size_t lastPos,
+    ChartParserCallback &outColl) const {
+    UTIL_THROW2("This rule table doesn't support concurrent rule lookup");
+  }
+
 private:
   //! Non-copyable: copy constructor and assignment operator not implemented.
   ChartRuleLookupManager(const ChartRuleLookupManager &);
@@ -0,0 +1,120 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace Moses
+{
+
+/** Priority queue with the interface of std::priority_queue, kept as a
+ * D-ary heap in a vector.
+ * - Compare has the same meaning as for std::priority_queue: top() is an
+ *   element that no other element compares greater than.
+ * - a wider heap is shallower, so pop() makes fewer, cache-friendlier
+ *   moves. D=4 suits the few hundred to few thousand entries of a cube
+ *   pruning queue.
+ * - ReplaceTop() swaps in a new top element with one sift-down, for the
+ *   usual cube pruning step of popping a cube and pushing it straight back
+ *   with its next-best score.
+ */
+template <class T, class Compare = std::less<T>, std::size_t D = 4>
+class DaryHeap
+{
+public:
+  explicit DaryHeap(const Compare &compare = Compare()) : m_compare(compare) {}
+
+  bool empty() const {
+    return m_heap.empty();
+  }
+  std::size_t size() const {
+    return m_heap.size();
+  }
+  const T &top() const {
+    return m_heap.front();
+  }
+
+  void push(const T &value) {
+    m_heap.push_back(value);
+    SiftUp(m_heap.size() - 1);
+  }
+
+  void pop() {
+    if (m_heap.size() > 1) {
+      m_heap.front() = m_heap.back();
+      m_heap.pop_back();
+      SiftDown(0);
+    } else {
+      m_heap.pop_back();
+    }
+  }
+
+  //! same as pop() followed by push(value), but cheaper
+  void ReplaceTop(const T &value) {
+    m_heap.front() = value;
+    SiftDown(0);
+  }
+
+  //! remove all elements, keeping the allocated space
+  void clear() {
+    m_heap.clear();
+  }
+
+  void reserve(std::size_t capacity) {
+    m_heap.reserve(capacity);
+  }
+
+private:
+  std::vector<T> m_heap;
+  Compare m_compare;
+
+  void SiftUp(std::size_t hole) {
+    T value = m_heap[hole];
+    while (hole > 0) {
+      std::size_t parent = (hole - 1) / D;
+      if (!m_compare(m_heap[parent], value)) break;
+      m_heap[hole] = m_heap[parent];
+      hole = parent;
+    }
+    m_heap[hole] = value;
+  }
+
+  void SiftDown(std::size_t hole) {
+    const std::size_t size = m_heap.size();
+    T value = m_heap[hole];
+    for (;;) {
+      std::size_t first = hole * D + 1;
+      if (first >= size) break;
+      std::size_t last = first + D < size ? first + D : size;
+      std::size_t best = first;
+      for (std::size_t child = first + 1; child < last; ++child) {
+        if (m_compare(m_heap[best], m_heap[child])) best = child;
+      }
+      if (!m_compare(value, m_heap[best])) break;
+      m_heap[hole] = m_heap[best];
+      hole = best;
+    }
+    m_heap[hole] = value;
+  }
+};
+
+}
@@ -0,0 +1,70 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <cstdlib>
+#include <queue>
+
+#include <boost/test/unit_test.hpp>
+
+#include "DaryHeap.h"
+
+using namespace Moses;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(dary_heap)
+
+// same pops as std::priority_queue, including after ReplaceTop
+BOOST_AUTO_TEST_CASE(matches_priority_queue)
+{
+  DaryHeap<int> heap;
+  priority_queue<int> reference;
+  srand(3);
+  for (size_t i = 0; i < 5000; ++i) {
+    int value = rand() % 1000;
+    switch (rand() % 3) {
+    case 0:
+      if (!heap.empty()) {
+        BOOST_REQUIRE_EQUAL(heap.top(), reference.top());
+        heap.pop();
+        reference.pop();
+        break;
+      }
+      // empty: push instead
+    case 1:
+      heap.push(value);
+      reference.push(value);
+      break;
+    case 2:
+      if (!heap.empty()) {
+        heap.ReplaceTop(value);
+        reference.pop();
+        reference.push(value);
+      }
+      break;
+    }
+    BOOST_REQUIRE_EQUAL(heap.size(), reference.size());
+  }
+  while (!heap.empty()) {
+    BOOST_REQUIRE_EQUAL(heap.top(), reference.top());
+    heap.pop();
+    reference.pop();
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -81,6 +81,12 @@ public:
   void EvaluateTranslationOptionListWithSourceContext(const InputType &input
       , const TranslationOptionList &translationOptionList) const {
   }
+  bool SupportsConcurrentSourceContextEvaluation() const {
+    return true;
+  }
+  bool SupportsConcurrentEvaluationWhenApplied() const {
+    return true;
+  }
 
   void EvaluateInIsolation(const Phrase &source
                            , const TargetPhrase &targetPhrase
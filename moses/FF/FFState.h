@@ -1,6 +1,7 @@
 #ifndef moses_FFState_h
 #define moses_FFState_h
 
+#include <cstddef>
 #include <vector>
 
 
@@ -12,6 +13,13 @@ class FFState
 public:
   virtual ~FFState();
   virtual int Compare(const FFState& other) const = 0;
+
+  /** hash of the state, used to speed up hypothesis recombination.
+   * States for which Compare() returns 0 must have the same hash.
+   * The default puts every state in the same bucket, leaving it to Compare() */
+  virtual size_t hash() const {
+    return 0;
+  }
 };
 
 class DummyState : public FFState
@@ -5,6 +5,7 @@
 #include "FeatureFunction.h"
 #include "moses/Hypothesis.h"
 #include "moses/Manager.h"
+#include "moses/StaticData.h"
 #include "moses/TranslationOption.h"
 #include "moses/Util.h"
 #include "moses/FF/DistortionScoreProducer.h"
@@ -43,6 +44,30 @@ void FeatureFunction::CallChangeSource(InputType *&input)
   }
 }
 
+bool FeatureFunction::AllSupportConcurrentSourceContextEvaluation()
+{
+  for (size_t i = 0; i < s_staticColl.size(); ++i) {
+    const FeatureFunction &ff = *s_staticColl[i];
+    if (!ff.SupportsConcurrentSourceContextEvaluation()) {
+      VERBOSE(2,"Feature " << ff.GetScoreProducerDescription() << " needs source context evaluation on the decoding thread" << endl);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FeatureFunction::AllSupportConcurrentEvaluationWhenApplied()
+{
+  for (size_t i = 0; i < s_staticColl.size(); ++i) {
+    const FeatureFunction &ff = *s_staticColl[i];
+    if (!ff.SupportsConcurrentEvaluationWhenApplied()) {
+      VERBOSE(2,"Feature " << ff.GetScoreProducerDescription() << " needs to be applied on the decoding thread" << endl);
+      return false;
+    }
+  }
+  return true;
+}
+
 FeatureFunction::
 FeatureFunction(const std::string& line)
   : m_tuneable(true)
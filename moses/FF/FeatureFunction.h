@@ -94,6 +94,28 @@ public:
     return m_requireSortingAfterSourceContext;
   }
 
+  /** whether EvaluateWithSourceContext() and
+   * EvaluateTranslationOptionListWithSourceContext() may run on other
+   * threads than InitializeForInput(), for different spans at the same time.
+   * Features known to be safe say so; everything else is scored on the
+   * decoding thread. */
+  virtual bool SupportsConcurrentSourceContextEvaluation() const {
+    return false;
+  }
+
+  //! whether all features in this run support SupportsConcurrentSourceContextEvaluation()
+  static bool AllSupportConcurrentSourceContextEvaluation();
+
+  /** whether EvaluateWhenApplied() may run on other threads than
+   * InitializeForInput(), for different hypotheses at the same time.
+   * Search only expands hypotheses in parallel if all features say so. */
+  virtual bool SupportsConcurrentEvaluationWhenApplied() const {
+    return false;
+  }
+
+  //! whether all features in this run support SupportsConcurrentEvaluationWhenApplied()
+  static bool AllSupportConcurrentEvaluationWhenApplied();
+
   virtual std::vector<float> DefaultWeights() const;
 
   //! Called before search and collecting of translation options
@@ -57,6 +57,12 @@ public:
   void EvaluateTranslationOptionListWithSourceContext(const InputType &input
       , const TranslationOptionList &translationOptionList) const {
   }
+  bool SupportsConcurrentSourceContextEvaluation() const {
+    return true;
+  }
+  bool SupportsConcurrentEvaluationWhenApplied() const {
+    return true;
+  }
 
   void EvaluateWhenApplied(const Hypothesis& hypo,
                            ScoreComponentCollection* accumulator) const {
@@ -44,6 +44,9 @@ public:
   }
 
   Scores GetProb(const Phrase& f, const Phrase& e) const;
+  bool SupportsConcurrentLookup() const {
+    return m_table->SupportsConcurrentLookup();
+  }
 
   virtual FFState* EvaluateWhenApplied(const Hypothesis& cur_hypo,
                                        const FFState* prev_state,
@@ -65,6 +68,12 @@ public:
   void EvaluateTranslationOptionListWithSourceContext(const InputType &input
       , const TranslationOptionList &translationOptionList) const {
   }
+  bool SupportsConcurrentSourceContextEvaluation() const {
+    return true;
+  }
+  bool SupportsConcurrentEvaluationWhenApplied() const {
+    return true;
+  }
 
   void EvaluateInIsolation(const Phrase &source
                            , const TargetPhrase &targetPhrase
@@ -45,6 +45,10 @@ public:
   };
   virtual void InitializeForInputPhrase(const Phrase&) {
   };
+  //! whether GetScore() may be called from any thread, several at a time
+  virtual bool SupportsConcurrentLookup() const {
+    return true;
+  }
   /*
   int GetNumScoreComponents() const {
     return m_NumScores;
@@ -124,6 +128,10 @@ public:
     ClearCache();
     auxCacheForSrcPhrase(f);
   }
+  //! the table is loaded per thread, and the cache isn't locked
+  virtual bool SupportsConcurrentLookup() const {
+    return false;
+  }
 public:
   static bool Create(std::istream& inFile, const std::string& outFileName);
 private:
@@ -21,6 +21,10 @@ OSMLM* ConstructOSMLM(const std::string &file)
       return new KenOSM<lm::ngram::ArrayTrieModel>(file);
     case lm::ngram::QUANT_ARRAY_TRIE:
       return new KenOSM<lm::ngram::QuantArrayTrieModel>(file);
+    case lm::ngram::BUCKET_PROBING:
+      return new KenOSM<lm::ngram::BucketProbingModel>(file);
+    case lm::ngram::REST_BUCKET_PROBING:
+      return new KenOSM<lm::ngram::RestBucketProbingModel>(file);
     default:
       UTIL_THROW2("Unrecognized kenlm model type " << model_type);
     }
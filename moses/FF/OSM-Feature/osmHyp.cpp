@@ -1,5 +1,6 @@
 #include "osmHyp.h"
 #include <sstream>
+#include <boost/functional/hash.hpp>
 
 using namespace std;
 using namespace lm::ngram;
@@ -40,6 +41,19 @@ int osmState::Compare(const FFState& otherBase) const
 }
 
 
+size_t osmState::hash() const
+{
+  // Compare() only looks at the length of the LM state
+  size_t seed = j;
+  boost::hash_combine(seed, E);
+  boost::hash_combine(seed, lmState.length);
+  for (map<int, string>::const_iterator iter = gap.begin(); iter != gap.end(); ++iter) {
+    boost::hash_combine(seed, iter->first);
+    boost::hash_combine(seed, iter->second);
+  }
+  return seed;
+}
+
 std::string osmState :: getName() const
 {
 
@@ -40,6 +40,12 @@ public:
   void EvaluateTranslationOptionListWithSourceContext(const InputType &input
       , const TranslationOptionList &translationOptionList) const {
   }
+  bool SupportsConcurrentSourceContextEvaluation() const {
+    return true;
+  }
+  bool SupportsConcurrentEvaluationWhenApplied() const {
+    return true;
+  }
   void SetParameter(const std::string& key, const std::string& value);
 
 protected:
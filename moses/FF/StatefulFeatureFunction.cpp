@@ -1,4 +1,6 @@
 #include "StatefulFeatureFunction.h"
+#include "moses/ChartHypothesis.h"
+#include "moses/Hypothesis.h"
 
 namespace Moses
 {
@@ -17,5 +19,23 @@ StatefulFeatureFunction::StatefulFeatureFunction(size_t numScoreComponents, cons
   m_statefulFFs.push_back(this);
 }
 
+void StatefulFeatureFunction::EvaluateWhenAppliedBatch(
+  const std::vector<Hypothesis*> &hypos,
+  int stateIdx) const
+{
+  for (std::vector<Hypothesis*>::const_iterator iter = hypos.begin(); iter != hypos.end(); ++iter) {
+    (*iter)->EvaluateWhenApplied(*this, stateIdx);
+  }
+}
+
+void StatefulFeatureFunction::EvaluateWhenAppliedBatch(
+  const std::vector<ChartHypothesis*> &hypos,
+  int featureID) const
+{
+  for (std::vector<ChartHypothesis*>::const_iterator iter = hypos.begin(); iter != hypos.end(); ++iter) {
+    (*iter)->EvaluateWhenApplied(*this, featureID);
+  }
+}
+
 }
 
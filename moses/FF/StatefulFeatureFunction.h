@@ -36,11 +36,32 @@ public:
     const FFState* prev_state,
     ScoreComponentCollection* accumulator) const = 0;
 
+  /**
+   * \brief Evaluate a batch of independent phrase-based hypotheses.
+   * Used by the batched stack search (search-algorithm 4). The result must be
+   * the same as calling Hypothesis::EvaluateWhenApplied(*this, stateIdx) on
+   * each, which is what the default does. Override to vectorise, prefetch
+   * or send grouped requests, eg. to a neural network or a remote LM.
+   */
+  virtual void EvaluateWhenAppliedBatch(
+    const std::vector<Hypothesis*> &hypos,
+    int stateIdx) const;
+
   virtual FFState* EvaluateWhenApplied(
     const ChartHypothesis& /* cur_hypo */,
     int /* featureID - used to index the state in the previous hypotheses */,
     ScoreComponentCollection* accumulator) const = 0;
 
+  /**
+   * \brief Evaluate a batch of independent chart hypotheses.
+   * Used by cube pruning for all neighbours of a popped item. The result must
+   * be the same as calling ChartHypothesis::EvaluateWhenApplied(*this,
+   * featureID) on each, which is what the default does.
+   */
+  virtual void EvaluateWhenAppliedBatch(
+    const std::vector<ChartHypothesis*> &hypos,
+    int featureID) const;
+
   virtual FFState* EvaluateWhenApplied(
     const Syntax::SHyperedge& /* cur_hypo */,
     int /* featureID - used to index the state in the previous hypotheses */,
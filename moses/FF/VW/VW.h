@@ -140,6 +140,11 @@ public:
                                  , ScoreComponentCollection *estimatedFutureScore = NULL) const {
   }
 
+  // the classifier and the target sentence are thread local, set up in InitializeForInput
+  bool SupportsConcurrentSourceContextEvaluation() const {
+    return false;
+  }
+
   void EvaluateTranslationOptionListWithSourceContext(const InputType &input
       , const TranslationOptionList &translationOptionList) const {
     Discriminative::Classifier &classifier = *m_tlsClassifier->GetStored();
@@ -39,6 +39,11 @@ public:
                                  , ScoreComponentCollection *estimatedFutureScore = NULL) const {}
   void EvaluateTranslationOptionListWithSourceContext(const InputType &input
       , const TranslationOptionList &translationOptionList) const {}
+
+  // source features are read from thread local storage set in InitializeForInput
+  bool SupportsConcurrentSourceContextEvaluation() const {
+    return false;
+  }
   void EvaluateWhenApplied(const Hypothesis& hypo,
                            ScoreComponentCollection* accumulator) const {}
   void EvaluateWhenApplied(const ChartHypothesis &hypo,
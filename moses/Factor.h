@@ -59,7 +59,17 @@ class Factor
   // Not implemented.  Shouldn't be called.
   Factor &operator=(const Factor &factor);
 
+  static const size_t IdChunkBits = 16;
+  static const size_t MaxIdChunks = 1 << 14;
+  //! id -> factor, in chunks of 2^IdChunkBits. Filled in by FactorCollection
+  static const Factor **s_idChunks[MaxIdChunks];
+
 public:
+  //! factor with this id. The id must come from a factor
+  static const Factor *FromId(size_t id) {
+    return s_idChunks[id >> IdChunkBits][id & ((1 << IdChunkBits) - 1)];
+  }
+
   //! original string representation of the factor
   StringPiece GetString() const {
     return m_string;
@@ -33,56 +33,140 @@ using namespace std;
 
 namespace Moses
 {
+const Factor **Factor::s_idChunks[Factor::MaxIdChunks];
+
 FactorCollection FactorCollection::s_instance;
 
+FactorCollection::ThreadCache &FactorCollection::GetThreadCache() const
+{
+#ifdef WITH_THREADS
+  ThreadCache *cache = m_threadCache.get();
+  if (cache == NULL) {
+    cache = new ThreadCache;
+    m_threadCache.reset(cache);
+  }
+  return *cache;
+#else
+  return m_threadCache;
+#endif
+}
+
+const Factor *FactorCollection::FindWithoutLock(const StringPiece &factorString, bool isNonTerminal, size_t hash, const Factor **&cacheEntry) const
+{
+  cacheEntry = &GetThreadCache().entries[hash & (ThreadCacheSize - 1)];
+  const Factor *cached = *cacheEntry;
+  // non-terminals get ids below moses_MaxNumNonterminals
+  if (cached != NULL
+      && (cached->GetId() < moses_MaxNumNonterminals) == isNonTerminal
+      && cached->GetString() == factorString) {
+    return cached;
+  }
+
+  if (m_frozen) {
+    const FrozenIndex &index = isNonTerminal ? m_frozenNonTerminals : m_frozenTerminals;
+    FrozenIndex::const_iterator i = index.find(factorString);
+    if (i != index.end()) {
+      *cacheEntry = i->second;
+      return i->second;
+    }
+  }
+  return NULL;
+}
+
 const Factor *FactorCollection::AddFactor(const StringPiece &factorString, bool isNonTerminal)
 {
+  const size_t hash = util::MurmurHashNative(factorString.data(), factorString.size());
+  const Factor **cacheEntry;
+  const Factor *ret = FindWithoutLock(factorString, isNonTerminal, hash, cacheEntry);
+  if (ret) return ret;
+
   FactorFriend to_ins;
   to_ins.in.m_string = factorString;
-  to_ins.in.m_id = (isNonTerminal) ? m_factorIdNonTerminal : m_factorId;
-  Set & set = (isNonTerminal) ? m_set : m_setNonTerminal;
+  Shard &shard = GetShard(hash);
+  Set & set = (isNonTerminal) ? shard.nonTerminals : shard.terminals;
   // If we're threaded, hope a read-only lock is sufficient.
 #ifdef WITH_THREADS
   {
     // read=lock scope
-    boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
+    boost::shared_lock<boost::shared_mutex> read_lock(shard.accessLock);
     Set::const_iterator i = set.find(to_ins);
-    if (i != set.end()) return &i->in;
+    if (i != set.end()) {
+      *cacheEntry = &i->in;
+      return &i->in;
+    }
   }
-  boost::unique_lock<boost::shared_mutex> lock(m_accessLock);
+  boost::unique_lock<boost::shared_mutex> lock(shard.accessLock);
 #endif // WITH_THREADS
-  std::pair<Set::iterator, bool> ret(set.insert(to_ins));
-  if (ret.second) {
-    ret.first->in.m_string.set(
-      memcpy(m_string_backing.Allocate(factorString.size()), factorString.data(), factorString.size()),
-      factorString.size());
-    if (isNonTerminal) {
-      m_factorIdNonTerminal++;
-      UTIL_THROW_IF2(m_factorIdNonTerminal >= moses_MaxNumNonterminals, "Number of non-terminals exceeds maximum size reserved. Adjust parameter moses_MaxNumNonterminals, then recompile");
-    } else {
-      m_factorId++;
+  Set::iterator i = set.find(to_ins);
+  if (i == set.end()) {
+    {
+#ifdef WITH_THREADS
+      boost::mutex::scoped_lock idLock(m_idLock);
+#endif
+      if (isNonTerminal) {
+        to_ins.in.m_id = m_factorIdNonTerminal++;
+        UTIL_THROW_IF2(m_factorIdNonTerminal >= moses_MaxNumNonterminals, "Number of non-terminals exceeds maximum size reserved. Adjust parameter moses_MaxNumNonterminals, then recompile");
+      } else {
+        to_ins.in.m_id = m_factorId++;
+      }
+      const size_t chunk = to_ins.in.m_id >> Factor::IdChunkBits;
+      UTIL_THROW_IF2(chunk >= Factor::MaxIdChunks, "Too many factors");
+      if (Factor::s_idChunks[chunk] == NULL) {
+        Factor::s_idChunks[chunk] = new const Factor*[1 << Factor::IdChunkBits];
+      }
     }
+    i = set.insert(to_ins).first;
+    i->in.m_string.set(
+      memcpy(shard.stringBacking.Allocate(factorString.size()), factorString.data(), factorString.size()),
+      factorString.size());
+    // only this thread has the id, and nobody looks it up before getting the factor
+    Factor::s_idChunks[i->in.m_id >> Factor::IdChunkBits][i->in.m_id & ((1 << Factor::IdChunkBits) - 1)] = &i->in;
   }
-  return &ret.first->in;
+  *cacheEntry = &i->in;
+  return &i->in;
 }
 
 const Factor *FactorCollection::GetFactor(const StringPiece &factorString, bool isNonTerminal)
 {
+  const size_t hash = util::MurmurHashNative(factorString.data(), factorString.size());
+  const Factor **cacheEntry;
+  const Factor *ret = FindWithoutLock(factorString, isNonTerminal, hash, cacheEntry);
+  if (ret) return ret;
+
   FactorFriend to_find;
   to_find.in.m_string = factorString;
-  to_find.in.m_id = (isNonTerminal) ? m_factorIdNonTerminal : m_factorId;
-  Set & set = (isNonTerminal) ? m_set : m_setNonTerminal;
+  const Shard &shard = GetShard(hash);
+  const Set & set = (isNonTerminal) ? shard.nonTerminals : shard.terminals;
   {
     // read=lock scope
 #ifdef WITH_THREADS
-    boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
+    boost::shared_lock<boost::shared_mutex> read_lock(shard.accessLock);
 #endif // WITH_THREADS
     Set::const_iterator i = set.find(to_find);
-    if (i != set.end()) return &i->in;
+    if (i != set.end()) {
+      *cacheEntry = &i->in;
+      return &i->in;
+    }
   }
   return NULL;
 }
 
+void FactorCollection::Freeze()
+{
+  m_frozenTerminals.clear();
+  m_frozenNonTerminals.clear();
+  for (size_t s = 0; s < NumShards; ++s) {
+    const Shard &shard = m_shards[s];
+    for (Set::const_iterator i = shard.terminals.begin(); i != shard.terminals.end(); ++i) {
+      m_frozenTerminals[i->in.GetString()] = &i->in;
+    }
+    for (Set::const_iterator i = shard.nonTerminals.begin(); i != shard.nonTerminals.end(); ++i) {
+      m_frozenNonTerminals[i->in.GetString()] = &i->in;
+    }
+  }
+  m_frozen = true;
+}
+
 
 FactorCollection::~FactorCollection() {}
 
@@ -91,11 +175,14 @@ TO_STRING_BODY(FactorCollection);
 // friend
 ostream& operator<<(ostream& out, const FactorCollection& factorCollection)
 {
+  for (size_t s = 0; s < FactorCollection::NumShards; ++s) {
+    const FactorCollection::Shard &shard = factorCollection.m_shards[s];
 #ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> lock(factorCollection.m_accessLock);
+    boost::shared_lock<boost::shared_mutex> lock(shard.accessLock);
 #endif
-  for (FactorCollection::Set::const_iterator i = factorCollection.m_set.begin(); i != factorCollection.m_set.end(); ++i) {
-    out << i->in;
+    for (FactorCollection::Set::const_iterator i = shard.nonTerminals.begin(); i != shard.nonTerminals.end(); ++i) {
+      out << i->in;
+    }
   }
   return out;
 }
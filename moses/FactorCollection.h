@@ -28,12 +28,16 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #endif
 
 #ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/tss.hpp>
 #endif
 
 #include "util/murmur_hash.hh"
+#include <boost/unordered_map.hpp>
 #include <boost/unordered_set.hpp>
 
+#include <algorithm>
 #include <functional>
 #include <string>
 
@@ -62,6 +66,15 @@ struct FactorFriend {
  * from being created on the stack, etc), their memory addresses can
  * be used as keys to uniquely identify them.
  * Only 1 FactorCollection object should be created.
+ *
+ * Lookups go through, in order:
+ *  1. a small per-thread cache of recently used factors (no locking)
+ *  2. the frozen index, built by Freeze() once the models are loaded
+ *     and read-only afterwards (no locking)
+ *  3. one of NumShards hash tables, each with its own reader-writer lock,
+ *     so threads interning different strings rarely touch the same lock.
+ * Factors are never deleted, so pointers handed out stay valid for the
+ * lifetime of the program.
  */
 class FactorCollection
 {
@@ -77,16 +90,49 @@ class FactorCollection
       return left.in.GetString() == right.in.GetString();
     }
   };
+  struct HashString : public std::unary_function<const StringPiece &, std::size_t> {
+    std::size_t operator()(const StringPiece &str) const {
+      return util::MurmurHashNative(str.data(), str.size());
+    }
+  };
   typedef boost::unordered_set<FactorFriend, HashFactor, EqualsFactor> Set;
-  Set m_set;
-  Set m_setNonTerminal;
+  typedef boost::unordered_map<StringPiece, const Factor*, HashString> FrozenIndex;
+
+  static const size_t NumShardBits = 6;
+  static const size_t NumShards = 1 << NumShardBits;
+  static const size_t ThreadCacheSize = 4096; /**< entries, must be a power of 2 */
+
+  //! one slice of the collection. Strings are assigned to shards by hash
+  struct Shard {
+    Set terminals;
+    Set nonTerminals;
+    util::Pool stringBacking;
+#ifdef WITH_THREADS
+    //reader-writer lock
+    mutable boost::shared_mutex accessLock;
+#endif
+  };
 
-  util::Pool m_string_backing;
+  //! direct-mapped cache of factors recently seen by one thread
+  struct ThreadCache {
+    const Factor *entries[ThreadCacheSize];
+    ThreadCache() {
+      std::fill(entries, entries + ThreadCacheSize, static_cast<const Factor*>(NULL));
+    }
+  };
+
+  Shard m_shards[NumShards];
+
+  FrozenIndex m_frozenTerminals, m_frozenNonTerminals;
+  bool m_frozen;
 
   static FactorCollection s_instance;
 #ifdef WITH_THREADS
-  //reader-writer lock
-  mutable boost::shared_mutex m_accessLock;
+  mutable boost::thread_specific_ptr<ThreadCache> m_threadCache;
+  //! guards the id counters
+  boost::mutex m_idLock;
+#else
+  mutable ThreadCache m_threadCache;
 #endif
 
   size_t m_factorIdNonTerminal; /**< unique, contiguous ids, starting from 0, for each non-terminal factor */
@@ -94,10 +140,22 @@ class FactorCollection
 
   //! constructor. only the 1 static variable can be created
   FactorCollection()
-    : m_factorIdNonTerminal(0)
+    : m_frozen(false)
+    , m_factorIdNonTerminal(0)
     , m_factorId(moses_MaxNumNonterminals) {
   }
 
+  Shard &GetShard(size_t hash) {
+    return m_shards[hash >> (sizeof(size_t) * 8 - NumShardBits)];
+  }
+
+  ThreadCache &GetThreadCache() const;
+
+  /** look for the factor without locking. On success the factor is returned,
+   * otherwise NULL and cacheEntry is where the factor should be remembered
+   * once found */
+  const Factor *FindWithoutLock(const StringPiece &factorString, bool isNonTerminal, size_t hash, const Factor **&cacheEntry) const;
+
 public:
   static FactorCollection& Instance() {
     return s_instance;
@@ -121,6 +179,18 @@ public:
     return AddFactor(factorString, isNonTerminal);
   }
 
+  /** index all factors created so far so that looking them up never takes
+   * a lock. Factors added later are still found, through the sharded tables.
+   * Not thread-safe: call once the models are loaded, before decoding threads
+   * start. Can be called again (eg. after models are reloaded) under the
+   * same condition.
+   */
+  void Freeze();
+
+  bool IsFrozen() const {
+    return m_frozen;
+  }
+
   TO_STRING();
 
 };
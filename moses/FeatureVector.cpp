@@ -24,6 +24,13 @@
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <stdint.h>
+
+#if defined __AVX__
+#include <immintrin.h>
+#elif defined __SSE__
+#include <xmmintrin.h>
+#endif
 
 #if defined __MINGW32__ && defined WITH_THREADS
 #include <boost/thread/locks.hpp>
@@ -45,11 +52,32 @@ FName::Id2Count FName::id2hopeCount;
 FName::Id2Count FName::id2fearCount;
 #ifdef WITH_THREADS
 boost::shared_mutex FName::m_idLock;
+boost::thread_specific_ptr<FName::Name2Id> FName::m_localIds;
+
+namespace
+{
+// sparse feature names often include words, so a long running thread would
+// otherwise end up with a copy of the whole vocabulary
+const size_t kMaxLocalIds = 1 << 16;
+}
 #endif
 
 void FName::init(const StringPiece &name)
 {
 #ifdef WITH_THREADS
+  // ids are never reassigned, so a thread can keep its own copy of the
+  // names it has seen, and look them up without a lock
+  Name2Id *localIds = m_localIds.get();
+  if (localIds == NULL) {
+    localIds = new Name2Id;
+    m_localIds.reset(localIds);
+  }
+  Name2Id::const_iterator local = FindStringPiece(*localIds, name);
+  if (local != localIds->end()) {
+    m_id = local->second;
+    return;
+  }
+
   //reader lock
   boost::shared_lock<boost::shared_mutex> lock(m_idLock);
 #endif
@@ -72,6 +100,12 @@ void FName::init(const StringPiece &name)
     }
     m_id = res.first->second;
   }
+#ifdef WITH_THREADS
+  if (localIds->size() >= kMaxLocalIds) {
+    localIds->clear();
+  }
+  (*localIds)[std::string(name.data(), name.size())] = m_id;
+#endif
 }
 
 size_t FName::getId(const string& name)
@@ -163,15 +197,150 @@ bool FName::operator!=(const FName& rhs) const
   return ! (*this == rhs);
 }
 
+FDenseVector::FDenseVector(size_t size)
+  : m_alloc(NULL), m_data(NULL), m_size(0), m_capacity(0)
+{
+  resize(size);
+}
+
+FDenseVector::FDenseVector(const FDenseVector &other)
+  : m_alloc(NULL), m_data(NULL), m_size(0), m_capacity(0)
+{
+  *this = other;
+}
+
+FDenseVector& FDenseVector::operator=(const FDenseVector &other)
+{
+  if (this == &other) {
+    return *this;
+  }
+  if (other.m_size > m_capacity) {
+    allocate(other.paddedSize());
+  } else if (other.m_size < m_size) {
+    std::fill(m_data + other.m_size, m_data + m_size, 0);
+  }
+  std::copy(other.m_data, other.m_data + other.m_size, m_data);
+  m_size = other.m_size;
+  return *this;
+}
+
+void FDenseVector::allocate(size_t capacity)
+{
+  // room to align the start to 32 bytes
+  FValue *alloc = new FValue[capacity + 32 / sizeof(FValue)];
+  delete [] m_alloc;
+  m_alloc = alloc;
+  m_data = reinterpret_cast<FValue*>((reinterpret_cast<uintptr_t>(alloc) + 31) & ~static_cast<uintptr_t>(31));
+  m_capacity = capacity;
+  std::fill(m_data, m_data + m_capacity, 0);
+}
+
+void FDenseVector::resize(size_t newSize)
+{
+  if (newSize > m_capacity) {
+    FDenseVector bigger;
+    bigger.allocate((newSize + Stride - 1) / Stride * Stride);
+    std::copy(m_data, m_data + m_size, bigger.m_data);
+    swap(*this, bigger);
+  } else if (newSize < m_size) {
+    std::fill(m_data + newSize, m_data + m_size, 0);
+  }
+  m_size = newSize;
+}
+
+void FDenseVector::zero()
+{
+  std::fill(m_data, m_data + m_size, 0);
+}
+
+FValue FDenseVector::sum() const
+{
+  FValue ret = 0;
+  for (size_t i = 0; i < m_size; ++i) {
+    ret += m_data[i];
+  }
+  return ret;
+}
+
+// The kernels run over whole strides. Both arrays are aligned, and the
+// padding is zero on both sides, so it stays zero.
+void FDenseVector::plusEquals(const FDenseVector &rhs)
+{
+  assert(rhs.m_size <= m_size);
+  const size_t n = rhs.paddedSize();
+  FValue *a = m_data;
+  const FValue *b = rhs.m_data;
+#if defined __AVX__
+  for (size_t i = 0; i < n; i += 8) {
+    _mm256_store_ps(a + i, _mm256_add_ps(_mm256_load_ps(a + i), _mm256_load_ps(b + i)));
+  }
+#elif defined __SSE__
+  for (size_t i = 0; i < n; i += 4) {
+    _mm_store_ps(a + i, _mm_add_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+  }
+#else
+  for (size_t i = 0; i < n; ++i) {
+    a[i] += b[i];
+  }
+#endif
+}
+
+void FDenseVector::minusEquals(const FDenseVector &rhs)
+{
+  assert(rhs.m_size <= m_size);
+  const size_t n = rhs.paddedSize();
+  FValue *a = m_data;
+  const FValue *b = rhs.m_data;
+#if defined __AVX__
+  for (size_t i = 0; i < n; i += 8) {
+    _mm256_store_ps(a + i, _mm256_sub_ps(_mm256_load_ps(a + i), _mm256_load_ps(b + i)));
+  }
+#elif defined __SSE__
+  for (size_t i = 0; i < n; i += 4) {
+    _mm_store_ps(a + i, _mm_sub_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+  }
+#else
+  for (size_t i = 0; i < n; ++i) {
+    a[i] -= b[i];
+  }
+#endif
+}
+
+FValue FDenseVector::dot(const FDenseVector &rhs) const
+{
+  const size_t n = std::min(paddedSize(), rhs.paddedSize());
+  const FValue *a = m_data;
+  const FValue *b = rhs.m_data;
+#if defined __AVX__
+  __m256 acc = _mm256_setzero_ps();
+  for (size_t i = 0; i < n; i += 8) {
+    acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_load_ps(a + i), _mm256_load_ps(b + i)));
+  }
+  __m128 acc4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+#elif defined __SSE__
+  __m128 acc4 = _mm_setzero_ps();
+  for (size_t i = 0; i < n; i += 4) {
+    acc4 = _mm_add_ps(acc4, _mm_mul_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+  }
+#endif
+#if defined __AVX__ || defined __SSE__
+  float lanes[4];
+  _mm_storeu_ps(lanes, acc4);
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+  FValue ret = 0;
+  for (size_t i = 0; i < n; ++i) {
+    ret += a[i] * b[i];
+  }
+  return ret;
+#endif
+}
+
 FVector::FVector(size_t coreFeatures) : m_coreFeatures(coreFeatures) {}
 
 void FVector::resize(size_t newsize)
 {
-  valarray<FValue> oldValues(m_coreFeatures);
   m_coreFeatures.resize(newsize);
-  for (size_t i = 0; i < min(m_coreFeatures.size(), oldValues.size()); ++i) {
-    m_coreFeatures[i] = oldValues[i];
-  }
 }
 
 void FVector::clear()
@@ -303,10 +472,45 @@ ostream& operator<<(ostream& out, const FVector& fv)
   return fv.print(out);
 }
 
+namespace
+{
+struct FNameLess {
+  bool operator()(const std::pair<FName, FValue> &lhs, const FName &rhs) const {
+    return lhs.first < rhs;
+  }
+};
+}
+
+FVector::const_iterator FVector::find(const FName& name) const
+{
+  const_iterator fi = lower_bound(m_features.begin(), m_features.end(), name, FNameLess());
+  if (fi != m_features.end() && fi->first == name) {
+    return fi;
+  }
+  return m_features.end();
+}
+
+FValue& FVector::getOrInsert(const FName& name)
+{
+  iterator fi = lower_bound(m_features.begin(), m_features.end(), name, FNameLess());
+  if (fi == m_features.end() || fi->first != name) {
+    fi = m_features.insert(fi, make_pair(name, FValue(0)));
+  }
+  return fi->second;
+}
+
+void FVector::erase(const FName& name)
+{
+  iterator fi = lower_bound(m_features.begin(), m_features.end(), name, FNameLess());
+  if (fi != m_features.end() && fi->first == name) {
+    m_features.erase(fi);
+  }
+}
+
 const FValue& FVector::get(const FName& name) const
 {
   static const FValue DEFAULT = 0;
-  const_iterator fi = m_features.find(name);
+  const_iterator fi = find(name);
   if (fi == m_features.end()) {
     return DEFAULT;
   } else {
@@ -316,7 +520,7 @@ const FValue& FVector::get(const FName& name) const
 
 FValue FVector::getBackoff(const FName& name, float backoff) const
 {
-  const_iterator fi = m_features.find(name);
+  const_iterator fi = find(name);
   if (fi == m_features.end()) {
     return backoff;
   } else {
@@ -352,7 +556,59 @@ void FVector::capMin(FValue minValue)
 
 void FVector::set(const FName& name, const FValue& value)
 {
-  m_features[name] = value;
+  getOrInsert(name) = value;
+}
+
+void FVector::sparseMerge(const FVector& rhs, bool subtract)
+{
+  if (rhs.m_features.empty()) {
+    return;
+  }
+
+  // count the names that are new to this vector
+  size_t added = 0;
+  const_iterator l = m_features.begin(), r = rhs.m_features.begin();
+  while (r != rhs.m_features.end()) {
+    if (l == m_features.end() || r->first < l->first) {
+      ++added;
+      ++r;
+    } else if (l->first < r->first) {
+      ++l;
+    } else {
+      ++l;
+      ++r;
+    }
+  }
+
+  if (added == 0) {
+    // in place
+    iterator out = m_features.begin();
+    for (r = rhs.m_features.begin(); r != rhs.m_features.end(); ++r) {
+      while (out->first < r->first) {
+        ++out;
+      }
+      out->second += subtract ? -r->second : r->second;
+    }
+    return;
+  }
+
+  FNValues merged;
+  merged.reserve(m_features.size() + added);
+  l = m_features.begin();
+  r = rhs.m_features.begin();
+  while (l != m_features.end() || r != rhs.m_features.end()) {
+    if (r == rhs.m_features.end() || (l != m_features.end() && l->first < r->first)) {
+      merged.push_back(*l++);
+    } else if (l == m_features.end() || r->first < l->first) {
+      merged.push_back(make_pair(r->first, subtract ? -r->second : r->second));
+      ++r;
+    } else {
+      merged.push_back(make_pair(l->first, l->second + (subtract ? -r->second : r->second)));
+      ++l;
+      ++r;
+    }
+  }
+  m_features.swap(merged);
 }
 
 void FVector::printCoreFeatures()
@@ -371,18 +627,15 @@ FVector& FVector::operator+= (const FVector& rhs)
 {
   if (rhs.m_coreFeatures.size() > m_coreFeatures.size())
     resize(rhs.m_coreFeatures.size());
-  for (const_iterator i = rhs.cbegin(); i != rhs.cend(); ++i)
-    set(i->first, get(i->first) + i->second);
-  for (size_t i = 0; i < rhs.m_coreFeatures.size(); ++i)
-    m_coreFeatures[i] += rhs.m_coreFeatures[i];
+  sparseMerge(rhs, false);
+  m_coreFeatures.plusEquals(rhs.m_coreFeatures);
   return *this;
 }
 
 // add only sparse features
 void FVector::sparsePlusEquals(const FVector& rhs)
 {
-  for (const_iterator i = rhs.cbegin(); i != rhs.cend(); ++i)
-    set(i->first, get(i->first) + i->second);
+  sparseMerge(rhs, false);
 }
 
 // add only core features
@@ -390,8 +643,7 @@ void FVector::corePlusEquals(const FVector& rhs)
 {
   if (rhs.m_coreFeatures.size() > m_coreFeatures.size())
     resize(rhs.m_coreFeatures.size());
-  for (size_t i = 0; i < rhs.m_coreFeatures.size(); ++i)
-    m_coreFeatures[i] += rhs.m_coreFeatures[i];
+  m_coreFeatures.plusEquals(rhs.m_coreFeatures);
 }
 
 // assign only core features
@@ -452,7 +704,7 @@ size_t FVector::pruneSparseFeatures(size_t threshold)
   }
 
   for (size_t i = 0; i < toErase.size(); ++i)
-    m_features.erase(toErase[i]);
+    erase(toErase[i]);
 
   return count;
 }
@@ -472,7 +724,7 @@ size_t FVector::pruneZeroWeightFeatures()
   }
 
   for (size_t i = 0; i < toErase.size(); ++i)
-    m_features.erase(toErase[i]);
+    erase(toErase[i]);
 
   return count;
 }
@@ -549,13 +801,8 @@ FVector& FVector::operator-= (const FVector& rhs)
 {
   if (rhs.m_coreFeatures.size() > m_coreFeatures.size())
     resize(rhs.m_coreFeatures.size());
-  for (const_iterator i = rhs.cbegin(); i != rhs.cend(); ++i)
-    set(i->first, get(i->first) -(i->second));
-  for (size_t i = 0; i < m_coreFeatures.size(); ++i) {
-    if (i < rhs.m_coreFeatures.size()) {
-      m_coreFeatures[i] -= rhs.m_coreFeatures[i];
-    }
-  }
+  sparseMerge(rhs, true);
+  m_coreFeatures.minusEquals(rhs.m_coreFeatures);
   return *this;
 }
 
@@ -609,7 +856,9 @@ FVector& FVector::operator*= (const FValue& rhs)
   for (iterator i = begin(); i != end(); ++i) {
     i->second *= rhs;
   }
-  m_coreFeatures *= rhs;
+  for (size_t i = 0; i < m_coreFeatures.size(); ++i) {
+    m_coreFeatures[i] *= rhs;
+  }
   return *this;
 }
 
@@ -618,7 +867,9 @@ FVector& FVector::operator/= (const FValue& rhs)
   for (iterator i = begin(); i != end(); ++i) {
     i->second /= rhs;
   }
-  m_coreFeatures /= rhs;
+  for (size_t i = 0; i < m_coreFeatures.size(); ++i) {
+    m_coreFeatures[i] /= rhs;
+  }
   return *this;
 }
 
@@ -727,7 +978,7 @@ size_t FVector::l1regularize(float lambda)
 
   // erase features that have become zero
   for (size_t i = 0; i < toErase.size(); ++i)
-    m_features.erase(toErase[i]);
+    erase(toErase[i]);
   numberPruned -= size();
   return numberPruned;
 }
@@ -777,7 +1028,7 @@ size_t FVector::sparseL1regularize(float lambda)
 
   // erase features that have become zero
   for (size_t i = 0; i < toErase.size(); ++i)
-    m_features.erase(toErase[i]);
+    erase(toErase[i]);
   numberPruned -= size();
   return numberPruned;
 }
@@ -807,12 +1058,19 @@ FValue FVector::inner_product(const FVector& rhs) const
 {
   assert(m_coreFeatures.size() == rhs.m_coreFeatures.size());
   FValue product = 0.0;
-  for (const_iterator i = cbegin(); i != cend(); ++i) {
-    product += ((i->second)*(rhs.get(i->first)));
-  }
-  for (size_t i = 0; i < m_coreFeatures.size(); ++i) {
-    product += m_coreFeatures[i]*rhs.m_coreFeatures[i];
+  const_iterator l = m_features.begin(), r = rhs.m_features.begin();
+  while (l != m_features.end() && r != rhs.m_features.end()) {
+    if (l->first < r->first) {
+      ++l;
+    } else if (r->first < l->first) {
+      ++r;
+    } else {
+      product += l->second * r->second;
+      ++l;
+      ++r;
+    }
   }
+  product += m_coreFeatures.dot(rhs.m_coreFeatures);
   return product;
 }
 
@@ -830,11 +1088,11 @@ void FVector::merge(const FVector &other)
   }
 
   // sparse
-  FNVmap::const_iterator iter;
+  const_iterator iter;
   for (iter = other.m_features.begin(); iter != other.m_features.end(); ++iter) {
     const FName  &otherKey = iter->first;
     const FValue otherVal = iter->second;
-    m_features[otherKey] = otherVal;
+    set(otherKey, otherVal);
   }
 }
 
@@ -22,11 +22,11 @@
 #ifndef FEATUREVECTOR_H
 #define FEATUREVECTOR_H
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <sstream>
 #include <string>
-#include <valarray>
 #include <vector>
 
 #include <boost/functional/hash.hpp>
@@ -37,11 +37,11 @@
 #include <boost/serialization/split_member.hpp>
 #include <boost/serialization/string.hpp>
 #include <boost/serialization/vector.hpp>
-#include <boost/serialization/valarray.hpp>
 #endif
 
 #ifdef WITH_THREADS
 #include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/tss.hpp>
 #endif
 
 #include "util/exception.hh"
@@ -87,6 +87,10 @@ struct FName {
 
   bool operator==(const FName& rhs) const ;
   bool operator!=(const FName& rhs) const ;
+  //! by id, which is the order of sparse features in an FVector
+  bool operator<(const FName& rhs) const {
+    return m_id < rhs.m_id;
+  }
 
   static size_t getId(const std::string& name);
   static size_t getHopeIdCount(const std::string& name);
@@ -101,6 +105,8 @@ private:
 #ifdef WITH_THREADS
   //reader-writer lock
   static boost::shared_mutex m_idLock;
+  //names this thread has seen recently, so it only takes m_idLock for new ones
+  static boost::thread_specific_ptr<Name2Id> m_localIds;
 #endif
 };
 
@@ -119,10 +125,85 @@ struct FNameHash
   }
 };
 
+/**
+ * Dense (core) features of an FVector.
+ *
+ * Values are stored in a 32-byte aligned array, padded with zeros to a
+ * multiple of Stride, so that the add and dot product kernels can run over
+ * whole SIMD registers without handling a tail. The padding is always zero.
+ * Assigning a vector that fits reuses the existing array.
+ **/
+class FDenseVector
+{
+public:
+  static const size_t Stride = 8;
+
+  explicit FDenseVector(size_t size = 0);
+  FDenseVector(const FDenseVector &other);
+  ~FDenseVector() {
+    delete [] m_alloc;
+  }
+
+  FDenseVector& operator=(const FDenseVector &other);
+
+  size_t size() const {
+    return m_size;
+  }
+  //! size rounded up to a multiple of Stride
+  size_t paddedSize() const {
+    return (m_size + Stride - 1) / Stride * Stride;
+  }
+
+  //! change size, keeping existing values. New values are 0
+  void resize(size_t newSize);
+  //! set all values to 0, keeping the size
+  void zero();
+
+  FValue& operator[](size_t index) {
+    return m_data[index];
+  }
+  FValue operator[](size_t index) const {
+    return m_data[index];
+  }
+  const FValue *data() const {
+    return m_data;
+  }
+
+  FValue sum() const;
+
+  //! element-wise. rhs must be no longer than this
+  void plusEquals(const FDenseVector &rhs);
+  void minusEquals(const FDenseVector &rhs);
+  //! over the shorter of the two vectors
+  FValue dot(const FDenseVector &rhs) const;
+
+private:
+  friend void swap(FDenseVector &first, FDenseVector &second);
+
+  void allocate(size_t capacity);
+
+  FValue *m_alloc; /**< as allocated */
+  FValue *m_data; /**< m_alloc, aligned */
+  size_t m_size;
+  size_t m_capacity; /**< multiple of Stride, all zero past m_size */
+};
+
+inline void swap(FDenseVector &first, FDenseVector &second)
+{
+  std::swap(first.m_alloc, second.m_alloc);
+  std::swap(first.m_data, second.m_data);
+  std::swap(first.m_size, second.m_size);
+  std::swap(first.m_capacity, second.m_capacity);
+}
+
 class ProxyFVector;
 
 /**
  * A sparse feature (or weight) vector.
+ *
+ * Sparse features are kept as (name, value) pairs sorted by name id, so
+ * that sums and inner products are linear merges. Setting a single feature
+ * is a binary search, plus an insertion if it is new.
  **/
 class FVector
 {
@@ -141,10 +222,10 @@ public:
   **/
   void resize(size_t newsize);
 
-  typedef boost::unordered_map<FName,FValue,FNameHash, FNameEquals> FNVmap;
-  /** Iterators */
-  typedef FNVmap::iterator iterator;
-  typedef FNVmap::const_iterator const_iterator;
+  typedef std::vector<std::pair<FName, FValue> > FNValues;
+  /** Iterators, in order of name id */
+  typedef FNValues::iterator iterator;
+  typedef FNValues::const_iterator const_iterator;
   iterator begin() {
     return m_features.begin();
   }
@@ -152,14 +233,14 @@ public:
     return m_features.end();
   }
   const_iterator cbegin() const {
-    return m_features.cbegin();
+    return m_features.begin();
   }
   const_iterator cend() const {
-    return m_features.cend();
+    return m_features.end();
   }
 
   bool hasNonDefaultValue(FName name) const {
-    return m_features.find(name) != m_features.end();
+    return find(name) != m_features.end();
   }
   void clear();
 
@@ -184,7 +265,7 @@ public:
     return m_coreFeatures.size();
   }
 
-  const std::valarray<FValue> &getCoreFeatures() const {
+  const FDenseVector &getCoreFeatures() const {
     return m_coreFeatures;
   }
 
@@ -271,9 +352,15 @@ private:
   const FValue& get(const FName& name) const;
   FValue getBackoff(const FName& name, float backoff) const;
   void set(const FName& name, const FValue& value);
+  //! value of name, added as 0 if not present
+  FValue& getOrInsert(const FName& name);
+  const_iterator find(const FName& name) const;
+  void erase(const FName& name);
+  //! add (or subtract) the sparse features of rhs
+  void sparseMerge(const FVector& rhs, bool subtract);
 
-  FNVmap m_features;
-  std::valarray<FValue> m_coreFeatures;
+  FNValues m_features;
+  FDenseVector m_coreFeatures;
 
 #ifdef MPI_ENABLE
   //serialization
@@ -287,9 +374,10 @@ private:
       names.push_back(ostr.str());
       values.push_back(i->second);
     }
+    std::vector<FValue> coreValues(m_coreFeatures.data(), m_coreFeatures.data() + m_coreFeatures.size());
     ar << names;
     ar << values;
-    ar << m_coreFeatures;
+    ar << coreValues;
   }
 
   template<class Archive>
@@ -297,9 +385,14 @@ private:
     clear();
     std::vector<std::string> names;
     std::vector<FValue> values;
+    std::vector<FValue> coreValues;
     ar >> names;
     ar >> values;
-    ar >> m_coreFeatures;
+    ar >> coreValues;
+    m_coreFeatures.resize(coreValues.size());
+    for (size_t i = 0; i < coreValues.size(); ++i) {
+      m_coreFeatures[i] = coreValues[i];
+    }
     UTIL_THROW_IF2(names.size() != values.size(), "Error");
     for (size_t i = 0; i < names.size(); ++i) {
       set(FName(names[i]), values[i]);
@@ -363,19 +456,19 @@ public:
   }
 
   /*operator FValue&() {
-   return m_fv->m_features[m_name];
+   return m_fv->getOrInsert(m_name);
    }*/
 
   FValue operator++() {
-    return ++m_fv->m_features[m_name];
+    return ++m_fv->getOrInsert(m_name);
   }
 
   FValue operator +=(FValue lhs) {
-    return (m_fv->m_features[m_name] += lhs);
+    return (m_fv->getOrInsert(m_name) += lhs);
   }
 
   FValue operator -=(FValue lhs) {
-    return (m_fv->m_features[m_name] -= lhs);
+    return (m_fv->getOrInsert(m_name) -= lhs);
   }
 
 private:
@@ -306,6 +306,79 @@ BOOST_AUTO_TEST_CASE(ip)
   BOOST_CHECK_CLOSE((FValue)p1, 1.1*0.5 + -0.1*0.25 + 2.2*2.4, TOL);
 }
 
+BOOST_AUTO_TEST_CASE(core_long)
+{
+  // longer than one stride, and not a multiple of it
+  FVector f1(19);
+  FVector f2(11);
+  for (size_t i = 0; i < 19; ++i) {
+    f1[i] = 0.5 * i;
+  }
+  for (size_t i = 0; i < 11; ++i) {
+    f2[i] = 1 - 0.25 * i;
+  }
+
+  FVector sum = f2 + f1;
+  BOOST_CHECK_EQUAL(sum.coreSize(), 19);
+  BOOST_CHECK_CLOSE((FValue)sum[10], 5 + 1 - 2.5, TOL);
+  BOOST_CHECK_CLOSE((FValue)sum[18], 9, TOL);
+
+  FVector diff = f1 - f2;
+  BOOST_CHECK_CLOSE((FValue)diff[3], 1.5 - 0.25, TOL);
+  BOOST_CHECK_CLOSE((FValue)diff[18], 9, TOL);
+
+  FValue expected = 0;
+  for (size_t i = 0; i < 11; ++i) {
+    expected += 0.5 * i * (1 - 0.25 * i);
+  }
+  FVector f3(f2);
+  f3.resize(19);
+  BOOST_CHECK_CLOSE(f1.inner_product(f3), expected, TOL);
+
+  // assigning a shorter vector must not leave old values behind
+  f1 = f2;
+  BOOST_CHECK_EQUAL(f1.coreSize(), 11);
+  f1.resize(19);
+  BOOST_CHECK_EQUAL((FValue)f1[18], 0);
+  BOOST_CHECK_CLOSE(f1.sum(), f2.sum(), TOL);
+}
+
+BOOST_AUTO_TEST_CASE(sparse_merge)
+{
+  FVector f1, f2;
+  FName n1("m1");
+  FName n2("m2");
+  FName n3("m3");
+  FName n4("m4");
+  // set out of id order
+  f1[n3] = 3;
+  f1[n1] = 1;
+  f2[n2] = 0.5;
+  f2[n3] = -1;
+  f2[n4] = 2;
+
+  // names both in f1 and f2, and only in one of them
+  f1 += f2;
+  BOOST_CHECK_EQUAL(f1.size(), 4);
+  BOOST_CHECK_CLOSE((FValue)f1[n1], 1, TOL);
+  BOOST_CHECK_CLOSE((FValue)f1[n2], 0.5, TOL);
+  BOOST_CHECK_CLOSE((FValue)f1[n3], 2, TOL);
+  BOOST_CHECK_CLOSE((FValue)f1[n4], 2, TOL);
+
+  // all names already in f1
+  f1 -= f2;
+  BOOST_CHECK_EQUAL(f1.size(), 4);
+  BOOST_CHECK_CLOSE((FValue)f1[n3], 3, TOL);
+  BOOST_CHECK_EQUAL((FValue)f1[n4], 0);
+
+  for (FVector::const_iterator i = f1.cbegin(); i + 1 != f1.cend(); ++i) {
+    BOOST_CHECK(i->first < (i + 1)->first);
+  }
+
+  f1[n2] = 4;
+  BOOST_CHECK_CLOSE(f1.inner_product(f2), 4 * 0.5 - 3, TOL);
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
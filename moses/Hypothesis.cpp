@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <limits>
 #include <vector>
 #include <algorithm>
+#include <boost/functional/hash.hpp>
 
 #include "TranslationOption.h"
 #include "TranslationOptionCollection.h"
@@ -42,10 +43,6 @@ using namespace std;
 namespace Moses
 {
 
-#ifdef USE_HYPO_POOL
-ObjectPool<Hypothesis> Hypothesis::s_objectPool("Hypothesis", 300000);
-#endif
-
 Hypothesis::Hypothesis(Manager& manager, InputType const& source, const TranslationOption &initialTransOpt)
   : m_prevHypo(NULL)
   , m_sourceCompleted(source.GetSize(), manager.GetSource().m_sourceCompleted)
@@ -57,6 +54,7 @@ Hypothesis::Hypothesis(Manager& manager, InputType const& source, const Translat
   , m_wordDeleted(false)
   , m_totalScore(0.0f)
   , m_futureScore(0.0f)
+  , m_scoreBreakdown(NULL)
   , m_ffStates(StatefulFeatureFunction::GetStatefulFeatureFunctions().size())
   , m_arcList(NULL)
   , m_transOpt(initialTransOpt)
@@ -86,6 +84,7 @@ Hypothesis::Hypothesis(const Hypothesis &prevHypo, const TranslationOption &tran
   , m_wordDeleted(false)
   , m_totalScore(0.0f)
   , m_futureScore(0.0f)
+  , m_scoreBreakdown(NULL)
   , m_ffStates(prevHypo.m_ffStates.size())
   , m_arcList(NULL)
   , m_transOpt(transOpt)
@@ -112,13 +111,32 @@ Hypothesis::~Hypothesis()
   if (m_arcList) {
     ArcList::iterator iter;
     for (iter = m_arcList->begin() ; iter != m_arcList->end() ; ++iter) {
-      FREEHYPO(*iter);
+      m_manager.GetHypothesisPool().freeObject(*iter);
     }
     m_arcList->clear();
 
-    delete m_arcList;
+    m_manager.GetArcListPool().freeObject(m_arcList);
     m_arcList = NULL;
   }
+
+  if (m_scoreBreakdown) {
+    m_manager.GetScoreBreakdownPool().freeObject(m_scoreBreakdown);
+    m_scoreBreakdown = NULL;
+  }
+}
+
+void Hypothesis::Free(Hypothesis *hypo)
+{
+  hypo->m_manager.GetHypothesisPool().freeObject(hypo);
+}
+
+void Hypothesis::CreateScoreBreakdown() const
+{
+  m_scoreBreakdown = m_manager.GetScoreBreakdownPool().get();
+  m_scoreBreakdown->PlusEquals(m_currScoreBreakdown);
+  if (m_prevHypo) {
+    m_scoreBreakdown->PlusEquals(m_prevHypo->GetScoreBreakdown());
+  }
 }
 
 void Hypothesis::AddArc(Hypothesis *loserHypo)
@@ -128,7 +146,7 @@ void Hypothesis::AddArc(Hypothesis *loserHypo)
       this->m_arcList = loserHypo->m_arcList;  // take ownership, we'll delete
       loserHypo->m_arcList = 0;                // prevent a double deletion
     } else {
-      this->m_arcList = new ArcList();
+      this->m_arcList = m_manager.GetArcListPool().get();
     }
   } else {
     if (loserHypo->m_arcList) {  // both have an arc list: merge. delete loser
@@ -136,7 +154,8 @@ void Hypothesis::AddArc(Hypothesis *loserHypo)
       size_t add_size = loserHypo->m_arcList->size();
       this->m_arcList->resize(my_size + add_size, 0);
       std::memcpy(&(*m_arcList)[0] + my_size, &(*loserHypo->m_arcList)[0], add_size * sizeof(Hypothesis *));
-      delete loserHypo->m_arcList;
+      loserHypo->m_arcList->clear();
+      m_manager.GetArcListPool().freeObject(loserHypo->m_arcList);
       loserHypo->m_arcList = 0;
     } else { // loserHypo doesn't have any arcs
       // DO NOTHING
@@ -159,12 +178,8 @@ Hypothesis* Hypothesis::CreateNext(const TranslationOption &transOpt) const
 Hypothesis* Hypothesis::Create(const Hypothesis &prevHypo, const TranslationOption &transOpt)
 {
 
-#ifdef USE_HYPO_POOL
-  Hypothesis *ptr = s_objectPool.getPtr();
+  Hypothesis *ptr = prevHypo.GetManager().GetHypothesisPool().getPtr();
   return new(ptr) Hypothesis(prevHypo, transOpt);
-#else
-  return new Hypothesis(prevHypo, transOpt);
-#endif
 }
 /***
  * return the subclass of Hypothesis most appropriate to the given target phrase
@@ -172,12 +187,8 @@ Hypothesis* Hypothesis::Create(const Hypothesis &prevHypo, const TranslationOpti
 
 Hypothesis* Hypothesis::Create(Manager& manager, InputType const& m_source, const TranslationOption &initialTransOpt)
 {
-#ifdef USE_HYPO_POOL
-  Hypothesis *ptr = s_objectPool.getPtr();
+  Hypothesis *ptr = manager.GetHypothesisPool().getPtr();
   return new(ptr) Hypothesis(manager, m_source, initialTransOpt);
-#else
-  return new Hypothesis(manager, m_source, initialTransOpt);
-#endif
 }
 
 /** check, if two hypothesis can be recombined.
@@ -206,6 +217,19 @@ int Hypothesis::RecombineCompare(const Hypothesis &compare) const
   return 0;
 }
 
+size_t Hypothesis::RecombineHash() const
+{
+  size_t seed = m_sourceCompleted.hash();
+  for (unsigned i = 0; i < m_ffStates.size(); ++i) {
+    if (m_ffStates[i]) {
+      boost::hash_combine(seed, m_ffStates[i]->hash());
+    } else {
+      boost::hash_combine(seed, 0);
+    }
+  }
+  return seed;
+}
+
 void Hypothesis::EvaluateWhenApplied(const StatefulFeatureFunction &sfff,
                                      int state_idx)
 {
@@ -226,10 +250,30 @@ void Hypothesis::EvaluateWhenApplied(const StatelessFeatureFunction& slff)
   }
 }
 
+void Hypothesis::EvaluateTotalScore(const SquareMatrix &futureScore)
+{
+  EvaluateTotalScore(futureScore.CalcFutureScore( m_sourceCompleted ));
+}
+
+void Hypothesis::EvaluateTotalScore(float futureScore)
+{
+  // FUTURE COST
+  m_futureScore = futureScore;
+
+  // TOTAL
+  m_totalScore = m_currScoreBreakdown.GetWeightedScore() + m_futureScore;
+  if (m_prevHypo) m_totalScore += m_prevHypo->GetScore();
+}
+
 /***
  * calculate the logarithm of our total translation score (sum up components)
  */
 void Hypothesis::EvaluateWhenApplied(const SquareMatrix &futureScore)
+{
+  EvaluateWhenApplied(futureScore.CalcFutureScore( m_sourceCompleted ));
+}
+
+void Hypothesis::EvaluateWhenApplied(float futureScore)
 {
   IFVERBOSE(2) {
     m_manager.GetSentenceStats().StartTimeOtherScore();
@@ -265,12 +309,7 @@ void Hypothesis::EvaluateWhenApplied(const SquareMatrix &futureScore)
     m_manager.GetSentenceStats().StartTimeEstimateScore();
   }
 
-  // FUTURE COST
-  m_futureScore = futureScore.CalcFutureScore( m_sourceCompleted );
-
-  // TOTAL
-  m_totalScore = m_currScoreBreakdown.GetWeightedScore() + m_futureScore;
-  if (m_prevHypo) m_totalScore += m_prevHypo->GetScore();
+  EvaluateTotalScore(futureScore);
 
   IFVERBOSE(2) {
     m_manager.GetSentenceStats().StopTimeEstimateScore();
@@ -67,8 +67,6 @@ class Hypothesis
   friend std::ostream& operator<<(std::ostream&, const Hypothesis&);
 
 protected:
-  static ObjectPool<Hypothesis> s_objectPool;
-
   const Hypothesis* m_prevHypo; /*! backpointer to previous hypothesis (from which this one was created) */
 //	const Phrase			&m_targetPhrase; /*! target phrase being created at the current decoding step */
   WordsBitmap				m_sourceCompleted; /*! keeps track of which words have been translated so far */
@@ -80,12 +78,12 @@ protected:
   bool							m_wordDeleted;
   float							m_totalScore;  /*! score so far */
   float							m_futureScore; /*! estimated future cost to translate rest of sentence */
-  /*! sum of scores of this hypothesis, and previous hypotheses. Lazily initialised.  */
-  mutable boost::scoped_ptr<ScoreComponentCollection> m_scoreBreakdown;
+  /*! sum of scores of this hypothesis, and previous hypotheses. Lazily initialised from the manager's pool.  */
+  mutable ScoreComponentCollection *m_scoreBreakdown;
   ScoreComponentCollection m_currScoreBreakdown; /*! scores for this hypothesis only */
   std::vector<const FFState*> m_ffStates;
   const Hypothesis 	*m_winningHypo;
-  ArcList 					*m_arcList; /*! all arcs that end at the same trellis point as this hypothesis */
+  ArcList 					*m_arcList; /*! all arcs that end at the same trellis point as this hypothesis. From the manager's pool */
   const TranslationOption &m_transOpt;
   Manager& m_manager;
 
@@ -96,13 +94,14 @@ protected:
   /*! used when creating a new hypothesis using a translation option (phrase translation) */
   Hypothesis(const Hypothesis &prevHypo, const TranslationOption &transOpt);
 
-public:
-  static ObjectPool<Hypothesis> &GetObjectPool() {
-    return s_objectPool;
-  }
+  void CreateScoreBreakdown() const;
 
+public:
   ~Hypothesis();
 
+  /** return hypothesis to its manager's pool. Use FREEHYPO */
+  static void Free(Hypothesis *hypo);
+
   /** return the subclass of Hypothesis most appropriate to the given translation option */
   static Hypothesis* Create(const Hypothesis &prevHypo, const TranslationOption &transOpt);
 
@@ -143,6 +142,9 @@ public:
   }
 
   void EvaluateWhenApplied(const SquareMatrix &futureScore);
+  /** same, with the future score of this hypothesis' coverage already known.
+   * All extensions of a hypothesis over the same span share it */
+  void EvaluateWhenApplied(float futureScore);
 
   int GetId()const {
     return m_id;
@@ -194,6 +196,8 @@ public:
   }
 
   int RecombineCompare(const Hypothesis &compare) const;
+  //! hash over coverage and feature states, equal for recombinable hypotheses
+  size_t RecombineHash() const;
 
   void GetOutputPhrase(Phrase &out) const;
 
@@ -233,14 +237,10 @@ public:
     return m_arcList;
   }
   const ScoreComponentCollection& GetScoreBreakdown() const {
-    if (!m_scoreBreakdown.get()) {
-      m_scoreBreakdown.reset(new ScoreComponentCollection());
-      m_scoreBreakdown->PlusEquals(m_currScoreBreakdown);
-      if (m_prevHypo) {
-        m_scoreBreakdown->PlusEquals(m_prevHypo->GetScoreBreakdown());
-      }
+    if (!m_scoreBreakdown) {
+      CreateScoreBreakdown();
     }
-    return *(m_scoreBreakdown.get());
+    return *m_scoreBreakdown;
   }
   float GetTotalScore() const {
     return m_totalScore;
@@ -258,6 +258,9 @@ public:
   // Added by oliver.wilson@ed.ac.uk for async lm stuff.
   void EvaluateWhenApplied(const StatefulFeatureFunction &sfff, int state_idx);
   void EvaluateWhenApplied(const StatelessFeatureFunction &slff);
+  //! set future and total score once all feature functions have been applied
+  void EvaluateTotalScore(const SquareMatrix &futureScore);
+  void EvaluateTotalScore(float futureScore);
 
   //! target span that trans opt would populate if applied to this hypo. Used for alignment check
   size_t GetNextStartPos(const TranslationOption &transOpt) const;
@@ -295,17 +298,7 @@ struct CompareHypothesisTotalScore {
   }
 };
 
-#ifdef USE_HYPO_POOL
-
-#define FREEHYPO(hypo) \
-{ \
-	ObjectPool<Hypothesis> &pool = Hypothesis::GetObjectPool(); \
-	pool.freeObject(hypo); \
-} \
- 
-#else
-#define FREEHYPO(hypo) delete hypo
-#endif
+#define FREEHYPO(hypo) Hypothesis::Free(hypo)
 
 /** defines less-than relation on hypotheses.
 * The particular order is not important for us, we need just to figure out
@@ -324,5 +317,22 @@ public:
   }
 };
 
+//! hash and equality for recombination in a RecombinationTable
+class HypothesisRecombinationHasher
+{
+public:
+  size_t operator()(const Hypothesis* hypo) const {
+    return hypo->RecombineHash();
+  }
+};
+
+class HypothesisRecombinationEqual
+{
+public:
+  bool operator()(const Hypothesis* hypoA, const Hypothesis* hypoB) const {
+    return hypoA->RecombineCompare(*hypoB) == 0;
+  }
+};
+
 }
 #endif
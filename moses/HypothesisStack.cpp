@@ -6,8 +6,9 @@ namespace Moses
 HypothesisStack::~HypothesisStack()
 {
   // delete all hypos
-  while (m_hypos.begin() != m_hypos.end()) {
-    Remove(m_hypos.begin());
+  for (iterator iter = m_hypos.begin(); iter != m_hypos.end(); ) {
+    iterator iterRemove = iter++;
+    Remove(iterRemove);
   }
 }
 
@@ -251,7 +251,7 @@ void HypothesisStackCubePruning::SetBitmapAccessor(const WordsBitmap &newBitmap
     , HypothesisStackCubePruning &stack
     , const WordsRange &/*range*/
     , BitmapContainer &bitmapContainer
-    , const SquareMatrix &futureScore
+    , float futureScore
     , const TranslationOptionList &transOptList)
 {
   _BMType::iterator bcExists = m_bitmapAccessor.find(newBitmap);
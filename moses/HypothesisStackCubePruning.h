@@ -119,7 +119,7 @@ public:
                          , HypothesisStackCubePruning &stack
                          , const WordsRange &range
                          , BitmapContainer &bitmapContainer
-                         , const SquareMatrix &futureScore
+                         , float futureScore
                          , const TranslationOptionList &transOptList);
 
   /** pruning, if too large.
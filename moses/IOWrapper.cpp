@@ -90,6 +90,8 @@ IOWrapper::IOWrapper()
 
   ,m_surpressSingleBestOutput(false)
 
+  ,m_reorderWindow(10000)
+
   ,spe_src(NULL)
   ,spe_trg(NULL)
   ,spe_aln(NULL)
@@ -98,6 +100,9 @@ IOWrapper::IOWrapper()
 
   m_inputFactorOrder = &staticData.GetInputFactorOrder();
 
+  staticData.GetParameter().SetParameter(m_reorderWindow, "threads-reorder-window", (size_t) 10000);
+  m_nextUnfinished = staticData.GetStartTranslationId();
+
   size_t nBestSize = staticData.GetNBestSize();
   string nBestFilePath = staticData.GetNBestFilePath();
 
@@ -219,6 +224,18 @@ IOWrapper::~IOWrapper()
 {
   if (m_inputFile != NULL)
     delete m_inputFile;
+
+  // collectors write out what they still buffer, so go before the streams
+  delete m_singleBestOutputCollector;
+  delete m_nBestOutputCollector;
+  delete m_unknownsCollector;
+  delete m_alignmentInfoCollector;
+  delete m_searchGraphOutputCollector;
+  delete m_detailedTranslationCollector;
+  delete m_wordGraphCollector;
+  delete m_latticeSamplesCollector;
+  delete m_detailTreeFragmentsOutputCollector;
+
   if (m_nBestStream != NULL && !m_surpressSingleBestOutput) {
     // outputting n-best to file, rather than stdout. need to close file and delete obj
     delete m_nBestStream;
@@ -230,16 +247,39 @@ IOWrapper::~IOWrapper()
   delete m_outputSearchGraphStream;
   delete m_outputWordGraphStream;
   delete m_latticeSamplesStream;
+}
 
-  delete m_singleBestOutputCollector;
-  delete m_nBestOutputCollector;
-  delete m_alignmentInfoCollector;
-  delete m_searchGraphOutputCollector;
-  delete m_detailedTranslationCollector;
-  delete m_wordGraphCollector;
-  delete m_latticeSamplesCollector;
-  delete m_detailTreeFragmentsOutputCollector;
+void IOWrapper::WaitForReorderWindow(long translationId)
+{
+#ifdef WITH_THREADS
+  if (m_reorderWindow == 0) {
+    return;
+  }
+  boost::mutex::scoped_lock lock(m_windowMutex);
+  while (translationId >= m_nextUnfinished + (long) m_reorderWindow) {
+    m_windowMoved.wait(lock);
+  }
+#endif
+}
 
+void IOWrapper::FinishTranslation(long translationId)
+{
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_windowMutex);
+#endif
+  if (translationId != m_nextUnfinished) {
+    m_finished.insert(translationId);
+    return;
+  }
+  ++m_nextUnfinished;
+  std::set<long>::iterator iter;
+  while ((iter = m_finished.begin()) != m_finished.end() && *iter == m_nextUnfinished) {
+    m_finished.erase(iter);
+    ++m_nextUnfinished;
+  }
+#ifdef WITH_THREADS
+  m_windowMoved.notify_one();
+#endif
 }
 
 InputType*
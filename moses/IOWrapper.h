@@ -37,8 +37,14 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <cassert>
 #include <fstream>
 #include <ostream>
+#include <set>
 #include <vector>
 
+#ifdef WITH_THREADS
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#endif
+
 #include "moses/TypeDef.h"
 #include "moses/Sentence.h"
 #include "moses/TabbedSentence.h"
@@ -99,6 +105,15 @@ protected:
 
   bool m_surpressSingleBestOutput;
 
+  // bounds how far reading runs ahead of output, see WaitForReorderWindow()
+  size_t m_reorderWindow; /**< 0 = unlimited */
+  long m_nextUnfinished; /**< all translations before this one are output */
+  std::set<long> m_finished; /**< output, but after m_nextUnfinished */
+#ifdef WITH_THREADS
+  boost::mutex m_windowMutex;
+  boost::condition_variable m_windowMoved;
+#endif
+
 
 public:
   IOWrapper();
@@ -107,6 +122,14 @@ public:
   Moses::InputType* GetInput(Moses::InputType *inputType);
   bool ReadInput(Moses::InputTypeEnum inputType, Moses::InputType*& source);
 
+  /** block until translationId is less than threads-reorder-window ahead of
+   * the oldest translation that hasn't been output yet. This bounds the
+   * output held back by the collectors while one slow sentence holds up
+   * the rest. Call from the reading thread before submitting a sentence */
+  void WaitForReorderWindow(long translationId);
+  //! all output of translationId has been passed to the collectors
+  void FinishTranslation(long translationId);
+
   Moses::OutputCollector *GetSingleBestOutputCollector() {
     return m_singleBestOutputCollector;
   }
@@ -40,7 +40,7 @@ namespace Moses
 {
 
 /** Constructs a new backward language model. */
-template <class Model> BackwardLanguageModel<Model>::BackwardLanguageModel(const std::string &line, const std::string &file, FactorType factorType, bool lazy) : LanguageModelKen<Model>(line,file,factorType,lazy)
+template <class Model> BackwardLanguageModel<Model>::BackwardLanguageModel(const std::string &line, const std::string &file, FactorType factorType, bool lazy) : LanguageModelKen<Model>(line,file,factorType,lazy ? util::LAZY : util::POPULATE_OR_READ)
 {
   //
   // This space intentionally left blank
@@ -300,6 +300,10 @@ LanguageModel *ConstructBackwardLM(const std::string &line, const std::string &f
       return new BackwardLanguageModel<lm::ngram::ArrayTrieModel>(line, file, factorType, lazy);
     case lm::ngram::QUANT_ARRAY_TRIE:
       return new BackwardLanguageModel<lm::ngram::QuantArrayTrieModel>(line, file, factorType, lazy);
+    case lm::ngram::BUCKET_PROBING:
+      return new BackwardLanguageModel<lm::ngram::BucketProbingModel>(line, file, factorType, lazy);
+    case lm::ngram::REST_BUCKET_PROBING:
+      return new BackwardLanguageModel<lm::ngram::RestBucketProbingModel>(line, file, factorType, lazy);
     default:
       UTIL_THROW2("Unrecognized kenlm model type " << model_type);
     }
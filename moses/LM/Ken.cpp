@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <iostream>
 #include <memory>
 #include <stdlib.h>
+#include <boost/functional/hash.hpp>
 #include <boost/shared_ptr.hpp>
 
 #include "lm/binary_format.hh"
@@ -59,6 +60,9 @@ struct KenLMState : public FFState {
     if (state.length > other.state.length) return 1;
     return std::memcmp(state.words, other.state.words, sizeof(lm::WordIndex) * state.length);
   }
+  size_t hash() const {
+    return lm::ngram::hash_value(state);
+  }
 };
 
 ///*
@@ -67,7 +71,7 @@ struct KenLMState : public FFState {
 //template <class Model> class LanguageModelKen : public LanguageModel
 //{
 //public:
-//  LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, bool lazy);
+//  LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, util::LoadMethod loadMethod);
 //
 //  const FFState *EmptyHypothesisState(const InputType &/*input*/) const {
 //    KenLMState *ret = new KenLMState();
@@ -140,7 +144,7 @@ private:
 
 } // namespace
 
-template <class Model> LanguageModelKen<Model>::LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, bool lazy)
+template <class Model> LanguageModelKen<Model>::LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, util::LoadMethod loadMethod)
   :LanguageModel(line)
   ,m_factorType(factorType)
 {
@@ -154,7 +158,7 @@ template <class Model> LanguageModelKen<Model>::LanguageModelKen(const std::stri
   FactorCollection &collection = FactorCollection::Instance();
   MappingBuilder builder(collection, m_lmIdLookup);
   config.enumerate_vocab = &builder;
-  config.load_method = lazy ? util::LAZY : util::POPULATE_OR_READ;
+  config.load_method = loadMethod;
 
   m_ngram.reset(new Model(file.c_str(), config));
 
@@ -285,6 +289,57 @@ template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(con
   return ret.release();
 }
 
+template <class Model> void LanguageModelKen<Model>::Prefetch(const Hypothesis &hypo, const FFState *ps) const
+{
+  if (!hypo.GetCurrTargetLength()) return;
+
+  const std::size_t begin = hypo.GetCurrTargetWordsRange().GetStartPos();
+  const std::size_t end = hypo.GetCurrTargetWordsRange().GetEndPos() + 1;
+  const std::size_t adjust_end = std::min(end, begin + m_ngram->Order() - 1);
+
+  // The first word is scored with the previous state, later ones with the
+  // state that scoring produces.  That state's context is a prefix of the
+  // preceding words, so prefetching with all of them covers it.
+  m_ngram->Prefetch(static_cast<const KenLMState&>(*ps).state, TranslateID(hypo.GetWord(begin)));
+  lm::WordIndex context[KENLM_MAX_ORDER - 1];
+  for (std::size_t position = begin + 1; position < adjust_end; ++position) {
+    lm::WordIndex *context_end = context;
+    for (int previous = position - 1; context_end != context + m_ngram->Order() - 1; --previous) {
+      if (previous < 0) {
+        *context_end++ = m_ngram->GetVocabulary().BeginSentence();
+        break;
+      }
+      *context_end++ = TranslateID(hypo.GetWord(previous));
+    }
+    m_ngram->Prefetch(context, context_end, TranslateID(hypo.GetWord(position)));
+  }
+
+  if (hypo.IsSourceCompleted()) {
+    const lm::WordIndex *last = LastIDs(hypo, context);
+    m_ngram->Prefetch(context, last, m_ngram->GetVocabulary().EndSentence());
+  }
+}
+
+template <class Model> void LanguageModelKen<Model>::EvaluateWhenAppliedBatch(const std::vector<Hypothesis*> &hypos, int stateIdx) const
+{
+  // Prefetch for a group of hypotheses, then score them while the loads are
+  // in flight.  The group is small enough that the prefetched lines are
+  // still in cache when scoring gets to them.
+  const std::size_t kGroupSize = 16;
+  for (std::size_t groupBegin = 0; groupBegin < hypos.size(); groupBegin += kGroupSize) {
+    const std::size_t groupEnd = std::min(hypos.size(), groupBegin + kGroupSize);
+    for (std::size_t i = groupBegin; i < groupEnd; ++i) {
+      const Hypothesis &hypo = *hypos[i];
+      if (hypo.GetPrevHypo()) {
+        Prefetch(hypo, hypo.GetPrevHypo()->GetFFState(stateIdx));
+      }
+    }
+    for (std::size_t i = groupBegin; i < groupEnd; ++i) {
+      hypos[i]->EvaluateWhenApplied(*this, stateIdx);
+    }
+  }
+}
+
 class LanguageModelChartStateKenLM : public FFState
 {
 public:
@@ -302,6 +357,17 @@ public:
     int ret = m_state.Compare(other.m_state);
     return ret;
   }
+  size_t hash() const {
+    // Left::Compare ignores the full flag of empty left states, so don't hash it
+    const lm::ngram::Left &left = m_state.left;
+    size_t seed = lm::ngram::hash_value(m_state.right);
+    boost::hash_combine(seed, left.length);
+    if (left.length) {
+      boost::hash_combine(seed, left.pointers[left.length - 1]);
+      boost::hash_combine(seed, left.full);
+    }
+    return seed;
+  }
 
 private:
   lm::ngram::ChartState m_state;
@@ -359,6 +425,55 @@ template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(con
   return newState;
 }
 
+template <class Model> void LanguageModelKen<Model>::Prefetch(const ChartHypothesis &hypo, int featureID) const
+{
+  const TargetPhrase &target = hypo.GetCurrTargetPhrase();
+  const AlignmentInfo::NonTermIndexMap &nonTermIndexMap =
+    target.GetAlignNonTerm().GetNonTermIndexMap();
+  const std::size_t maxContext = m_ngram->Order() - 1;
+
+  lm::WordIndex context[KENLM_MAX_ORDER - 1];
+  for (std::size_t phrasePos = 0; phrasePos < target.GetSize(); ++phrasePos) {
+    const Word &word = target.GetWord(phrasePos);
+    if (word.IsNonTerminal() || word.GetFactor(m_factorType) == m_beginSentenceFactor) continue;
+
+    const lm::WordIndex id = TranslateID(word);
+    lm::WordIndex *context_end = context;
+    std::size_t previous = phrasePos;
+    while (previous > 0 && context_end != context + maxContext) {
+      const Word &before = target.GetWord(--previous);
+      if (before.IsNonTerminal()) {
+        if (context_end == context) {
+          const ChartHypothesis *prevHypo = hypo.GetPrevHypo(nonTermIndexMap[previous]);
+          const lm::ngram::ChartState &prevState = static_cast<const LanguageModelChartStateKenLM*>(prevHypo->GetFFState(featureID))->GetChartState();
+          m_ngram->Prefetch(prevState.right, id);
+        }
+        break;
+      }
+      *context_end++ = before.GetFactor(m_factorType) == m_beginSentenceFactor ?
+                       m_ngram->GetVocabulary().BeginSentence() : TranslateID(before);
+    }
+    if (context_end != context) {
+      m_ngram->Prefetch(context, context_end, id);
+    }
+  }
+}
+
+template <class Model> void LanguageModelKen<Model>::EvaluateWhenAppliedBatch(const std::vector<ChartHypothesis*> &hypos, int featureID) const
+{
+  // As for phrase-based hypotheses: prefetch for a group, then score it.
+  const std::size_t kGroupSize = 16;
+  for (std::size_t groupBegin = 0; groupBegin < hypos.size(); groupBegin += kGroupSize) {
+    const std::size_t groupEnd = std::min(hypos.size(), groupBegin + kGroupSize);
+    for (std::size_t i = groupBegin; i < groupEnd; ++i) {
+      Prefetch(*hypos[i], featureID);
+    }
+    for (std::size_t i = groupBegin; i < groupEnd; ++i) {
+      hypos[i]->EvaluateWhenApplied(*this, featureID);
+    }
+  }
+}
+
 template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(const Syntax::SHyperedge& hyperedge, int featureID, ScoreComponentCollection *accumulator) const
 {
   LanguageModelChartStateKenLM *newState = new LanguageModelChartStateKenLM();
@@ -442,7 +557,7 @@ LanguageModel *ConstructKenLM(const std::string &line)
 {
   FactorType factorType = 0;
   string filePath;
-  bool lazy = false;
+  util::LoadMethod loadMethod = util::POPULATE_OR_READ;
 
   vector<string> toks = Tokenize(line);
   for (size_t i = 1; i < toks.size(); ++i) {
@@ -457,38 +572,58 @@ LanguageModel *ConstructKenLM(const std::string &line)
     } else if (args[0] == "path") {
       filePath = args[1];
     } else if (args[0] == "lazyken") {
-      lazy = Scan<bool>(args[1]);
+      loadMethod = Scan<bool>(args[1]) ? util::LAZY : util::POPULATE_OR_READ;
+    } else if (args[0] == "load") {
+      if (args[1] == "lazy") {
+        loadMethod = util::LAZY;
+      } else if (args[1] == "populate") {
+        loadMethod = util::POPULATE_OR_READ;
+      } else if (args[1] == "read") {
+        loadMethod = util::READ;
+      } else if (args[1] == "parallel") {
+        loadMethod = util::PARALLEL_READ;
+      } else if (args[1] == "huge") {
+        loadMethod = util::HUGE_READ;
+      } else if (args[1] == "interleave") {
+        loadMethod = util::NUMA_INTERLEAVE_READ;
+      } else {
+        UTIL_THROW2("Unknown KenLM load method " << args[1] << ". Use lazy, populate, read, parallel, huge or interleave");
+      }
     } else if (args[0] == "name") {
       // that's ok. do nothing, passes onto LM constructor
     }
   }
 
-  return ConstructKenLM(line, filePath, factorType, lazy);
+  return ConstructKenLM(line, filePath, factorType, loadMethod);
 }
 
-LanguageModel *ConstructKenLM(const std::string &line, const std::string &file, FactorType factorType, bool lazy)
+LanguageModel *ConstructKenLM(const std::string &line, const std::string &file, FactorType factorType, util::LoadMethod loadMethod)
 {
   lm::ngram::ModelType model_type;
   if (lm::ngram::RecognizeBinary(file.c_str(), model_type)) {
 
     switch(model_type) {
     case lm::ngram::PROBING:
-      return new LanguageModelKen<lm::ngram::ProbingModel>(line, file, factorType, lazy);
+      return new LanguageModelKen<lm::ngram::ProbingModel>(line, file, factorType, loadMethod);
     case lm::ngram::REST_PROBING:
-      return new LanguageModelKen<lm::ngram::RestProbingModel>(line, file, factorType, lazy);
+      return new LanguageModelKen<lm::ngram::RestProbingModel>(line, file, factorType, loadMethod);
     case lm::ngram::TRIE:
-      return new LanguageModelKen<lm::ngram::TrieModel>(line, file, factorType, lazy);
+      return new LanguageModelKen<lm::ngram::TrieModel>(line, file, factorType, loadMethod);
     case lm::ngram::QUANT_TRIE:
-      return new LanguageModelKen<lm::ngram::QuantTrieModel>(line, file, factorType, lazy);
+      return new LanguageModelKen<lm::ngram::QuantTrieModel>(line, file, factorType, loadMethod);
     case lm::ngram::ARRAY_TRIE:
-      return new LanguageModelKen<lm::ngram::ArrayTrieModel>(line, file, factorType, lazy);
+      return new LanguageModelKen<lm::ngram::ArrayTrieModel>(line, file, factorType, loadMethod);
     case lm::ngram::QUANT_ARRAY_TRIE:
-      return new LanguageModelKen<lm::ngram::QuantArrayTrieModel>(line, file, factorType, lazy);
+      return new LanguageModelKen<lm::ngram::QuantArrayTrieModel>(line, file, factorType, loadMethod);
+    case lm::ngram::BUCKET_PROBING:
+      return new LanguageModelKen<lm::ngram::BucketProbingModel>(line, file, factorType, loadMethod);
+    case lm::ngram::REST_BUCKET_PROBING:
+      return new LanguageModelKen<lm::ngram::RestBucketProbingModel>(line, file, factorType, loadMethod);
     default:
       UTIL_THROW2("Unrecognized kenlm model type " << model_type);
     }
   } else {
-    return new LanguageModelKen<lm::ngram::ProbingModel>(line, file, factorType, lazy);
+    return new LanguageModelKen<lm::ngram::ProbingModel>(line, file, factorType, loadMethod);
   }
 }
 
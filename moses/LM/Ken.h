@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <boost/shared_ptr.hpp>
 
 #include "lm/word_index.hh"
+#include "util/mmap.hh"
 
 #include "moses/LM/Base.h"
 #include "moses/Hypothesis.h"
@@ -41,7 +42,7 @@ class FFState;
 LanguageModel *ConstructKenLM(const std::string &line);
 
 //! This will also load. Returns a templated KenLM class
-LanguageModel *ConstructKenLM(const std::string &line, const std::string &file, FactorType factorType, bool lazy);
+LanguageModel *ConstructKenLM(const std::string &line, const std::string &file, FactorType factorType, util::LoadMethod loadMethod);
 
 /*
  * An implementation of single factor LM using Kenneth's code.
@@ -49,7 +50,7 @@ LanguageModel *ConstructKenLM(const std::string &line, const std::string &file,
 template <class Model> class LanguageModelKen : public LanguageModel
 {
 public:
-  LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, bool lazy);
+  LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, util::LoadMethod loadMethod);
 
   virtual const FFState *EmptyHypothesisState(const InputType &/*input*/) const;
 
@@ -57,8 +58,12 @@ public:
 
   virtual FFState *EvaluateWhenApplied(const Hypothesis &hypo, const FFState *ps, ScoreComponentCollection *out) const;
 
+  virtual void EvaluateWhenAppliedBatch(const std::vector<Hypothesis*> &hypos, int stateIdx) const;
+
   virtual FFState *EvaluateWhenApplied(const ChartHypothesis& cur_hypo, int featureID, ScoreComponentCollection *accumulator) const;
 
+  virtual void EvaluateWhenAppliedBatch(const std::vector<ChartHypothesis*> &hypos, int featureID) const;
+
   virtual FFState *EvaluateWhenApplied(const Syntax::SHyperedge& hyperedge, int featureID, ScoreComponentCollection *accumulator) const;
 
   virtual void IncrementalCallback(Incremental::Manager &manager) const;
@@ -66,6 +71,11 @@ public:
 
   virtual bool IsUseable(const FactorMask &mask) const;
 
+  // queries only read the model and the vocabulary mapping
+  bool SupportsConcurrentEvaluationWhenApplied() const {
+    return true;
+  }
+
 protected:
   boost::shared_ptr<Model> m_ngram;
 
@@ -74,7 +84,7 @@ protected:
   FactorType m_factorType;
 
   lm::WordIndex TranslateID(const Word &word) const {
-    std::size_t factor = word.GetFactor(m_factorType)->GetId();
+    std::size_t factor = word.GetFactorId(m_factorType);
     return (factor >= m_lmIdLookup.size() ? 0 : m_lmIdLookup[factor]);
   }
 
@@ -96,6 +106,14 @@ private:
     }
   }
 
+  // Issue prefetches for the n-grams EvaluateWhenApplied(hypo, ps, ...) will look up.
+  void Prefetch(const Hypothesis &hypo, const FFState *ps) const;
+
+  // Same for EvaluateWhenApplied(chart hypo, featureID, ...).  Terminals are
+  // prefetched with the words before them in the rule, or with the right
+  // state of the non-terminal they follow.
+  void Prefetch(const ChartHypothesis &hypo, int featureID) const;
+
   std::vector<lm::WordIndex> m_lmIdLookup;
 
 };
@@ -61,6 +61,9 @@ namespace Moses
 {
 Manager::Manager(InputType const& source)
   :BaseManager(source)
+  ,m_arcListPool("ArcList", 100)
+  ,m_scoreBreakdownPool("ScoreComponentCollection", 1000)
+  ,m_hypothesisPool("Hypothesis", 1000)
   ,m_transOptColl(source.CreateTranslationOptionCollection())
   ,interrupted_flag(0)
   ,m_hypoId(0)
@@ -76,7 +79,11 @@ Manager::~Manager()
 {
   delete m_transOptColl;
   delete m_search;
-  // this is a comment ...
+  // release all hypotheses (and with them their feature states) before
+  // the feature functions clean up after the sentence
+  m_hypothesisPool.cleanUp();
+  m_scoreBreakdownPool.cleanUp();
+  m_arcListPool.cleanUp();
 
   StaticData::Instance().CleanUpAfterSentenceProcessing(m_source);
 }
@@ -107,6 +114,7 @@ void Manager::Decode()
   IFVERBOSE(1) {
     GetSentenceStats().StartTimeCollectOpts();
   }
+  m_transOptColl->SetThreadsPerSentence(m_threadsPerSentence);
   m_transOptColl->CreateTranslationOptions();
 
   // some reporting on how long this took
@@ -117,6 +125,13 @@ void Manager::Decode()
               << __FILE__ << ":" << __LINE__ << endl);
   }
 
+  // with several threads per sentence, the search may create hypotheses concurrently
+  if (m_threadsPerSentence > 1) {
+    m_hypothesisPool.setThreadSafe(true);
+    m_scoreBreakdownPool.setThreadSafe(true);
+    m_arcListPool.setThreadSafe(true);
+  }
+
   // search for best translation with the specified algorithm
   Timer searchTime;
   searchTime.start();
@@ -818,7 +833,7 @@ size_t Manager::OutputFeatureValuesForSLF(size_t index, bool zeros, const Hypoth
   //   // cout << "m_scores.cbegin() ?= m_scores.cend()\t" <<  (m_scores.cbegin() == m_scores.cend()) << endl;
 
 
-  //   // for(FVector::FNVmap::const_iterator i = m_scores.cbegin(); i != m_scores.cend(); i++) {
+  //   // for(FVector::const_iterator i = m_scores.cbegin(); i != m_scores.cend(); i++) {
   //   //   std::cout<<prefix << "\t" << (i->first) << "\t" << (i->second) << std::endl;
   //   // }
   //   for(int i=0, n=v.size(); i<n; i+=1) {
@@ -1443,6 +1458,9 @@ const Hypothesis *Manager::GetBestHypothesis() const
 
 int Manager::GetNextHypoId()
 {
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_hypoIdMutex);
+#endif
   return m_hypoId++;
 }
 
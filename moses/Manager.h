@@ -35,6 +35,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Search.h"
 #include "SearchCubePruning.h"
 #include "BaseManager.h"
+#include "ObjectPool.h"
+
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
 
 namespace Moses
 {
@@ -112,6 +117,14 @@ private:
 
 protected:
   // data
+  // per-sentence storage for hypotheses and their arc lists and score breakdowns.
+  // Freed all at once with the manager. Only shared between threads that
+  // work on the same sentence, see -threads-per-sentence
+  // The hypothesis pool must be declared last, so it is destroyed first
+  ObjectPool<ArcList> m_arcListPool;
+  ObjectPool<ScoreComponentCollection> m_scoreBreakdownPool;
+  ObjectPool<Hypothesis> m_hypothesisPool;
+
   TranslationOptionCollection *m_transOptColl; /**< pre-computed list of translation options for the phrases in this sentence */
   Search *m_search;
 
@@ -119,6 +132,9 @@ protected:
   size_t interrupted_flag;
   std::auto_ptr<SentenceStats> m_sentenceStats;
   int m_hypoId; //used to number the hypos as they are created.
+#ifdef WITH_THREADS
+  boost::mutex m_hypoIdMutex;
+#endif
 
   void GetConnectedGraph(
     std::map< int, bool >* pConnected,
@@ -167,6 +183,16 @@ public:
   void GetWordGraph(long translationId, std::ostream &outputWordGraphStream) const;
   int GetNextHypoId();
 
+  ObjectPool<Hypothesis> &GetHypothesisPool() {
+    return m_hypothesisPool;
+  }
+  ObjectPool<ArcList> &GetArcListPool() {
+    return m_arcListPool;
+  }
+  ObjectPool<ScoreComponentCollection> &GetScoreBreakdownPool() {
+    return m_scoreBreakdownPool;
+  }
+
   void OutputLatticeMBRNBest(std::ostream& out, const std::vector<LatticeMBRSolution>& solutions,long translationId) const;
   void OutputBestHypo(const std::vector<Moses::Word>&  mbrBestHypo, long /*translationId*/,
                       char reportSegmentation, bool reportAllFactors, std::ostream& out) const;
@@ -0,0 +1,131 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2015 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef _MOCK_THREAD_LOCAL_FEATURE_
+#define _MOCK_THREAD_LOCAL_FEATURE_
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "moses/FF/StatelessFeatureFunction.h"
+#include "moses/ChartHypothesis.h"
+#include "moses/ChartManager.h"
+#include "moses/Hypothesis.h"
+
+namespace MosesTest
+{
+
+//
+// Keeps the input in thread local storage from InitializeForInput(), like
+// the VW features do, and counts the calls that can't see it.
+//
+
+class MockThreadLocalFeature : public Moses::StatelessFeatureFunction
+{
+public:
+  MockThreadLocalFeature(bool concurrentSourceContext, bool concurrentWhenApplied)
+    : StatelessFeatureFunction(0, "ThreadLocalInput")
+    , m_concurrentSourceContext(concurrentSourceContext)
+    , m_concurrentWhenApplied(concurrentWhenApplied)
+    , m_sourceContextCalls(0)
+    , m_sourceContextMissing(0)
+    , m_whenAppliedCalls(0)
+    , m_whenAppliedMissing(0) {}
+
+  bool IsUseable(const Moses::FactorMask &mask) const {
+    return true;
+  }
+
+  void SetConcurrent(bool concurrentSourceContext, bool concurrentWhenApplied) {
+    m_concurrentSourceContext = concurrentSourceContext;
+    m_concurrentWhenApplied = concurrentWhenApplied;
+  }
+
+  bool SupportsConcurrentSourceContextEvaluation() const {
+    return m_concurrentSourceContext;
+  }
+  bool SupportsConcurrentEvaluationWhenApplied() const {
+    return m_concurrentWhenApplied;
+  }
+
+  void InitializeForInput(Moses::InputType const& source) {
+    m_input.reset(new const Moses::InputType*(&source));
+  }
+
+  void EvaluateWithSourceContext(const Moses::InputType &input
+                                 , const Moses::InputPath &inputPath
+                                 , const Moses::TargetPhrase &targetPhrase
+                                 , const Moses::StackVec *stackVec
+                                 , Moses::ScoreComponentCollection &scoreBreakdown
+                                 , Moses::ScoreComponentCollection *estimatedFutureScore = NULL) const {
+    Count(input, m_sourceContextCalls, m_sourceContextMissing);
+  }
+
+  void EvaluateTranslationOptionListWithSourceContext(const Moses::InputType &input
+      , const Moses::TranslationOptionList &translationOptionList) const {
+    Count(input, m_sourceContextCalls, m_sourceContextMissing);
+  }
+
+  void EvaluateInIsolation(const Moses::Phrase &source
+                           , const Moses::TargetPhrase &targetPhrase
+                           , Moses::ScoreComponentCollection &scoreBreakdown
+                           , Moses::ScoreComponentCollection &estimatedFutureScore) const {
+  }
+
+  void EvaluateWhenApplied(const Moses::Hypothesis &hypo, Moses::ScoreComponentCollection*) const {
+    Count(hypo.GetInput(), m_whenAppliedCalls, m_whenAppliedMissing);
+  }
+  void EvaluateWhenApplied(const Moses::ChartHypothesis &hypo, Moses::ScoreComponentCollection*) const {
+    Count(hypo.GetManager().GetSource(), m_whenAppliedCalls, m_whenAppliedMissing);
+  }
+
+  size_t GetSourceContextCalls() const {
+    return m_sourceContextCalls;
+  }
+  size_t GetSourceContextMissing() const {
+    return m_sourceContextMissing;
+  }
+  size_t GetWhenAppliedCalls() const {
+    return m_whenAppliedCalls;
+  }
+  size_t GetWhenAppliedMissing() const {
+    return m_whenAppliedMissing;
+  }
+
+private:
+  void Count(const Moses::InputType &input, size_t &calls, size_t &missing) const {
+    bool isMissing = m_input.get() == NULL || *m_input != &input;
+    // slow enough that the pool's workers get to take some tasks, even on one core
+    boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    boost::mutex::scoped_lock lock(m_mutex);
+    ++calls;
+    if (isMissing) ++missing;
+  }
+
+  bool m_concurrentSourceContext, m_concurrentWhenApplied;
+  boost::thread_specific_ptr<const Moses::InputType*> m_input;
+  mutable boost::mutex m_mutex;
+  mutable size_t m_sourceContextCalls, m_sourceContextMissing;
+  mutable size_t m_whenAppliedCalls, m_whenAppliedMissing;
+};
+
+}
+
+#endif
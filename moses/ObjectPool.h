@@ -15,6 +15,11 @@
 #include <iterator>
 #include "Util.h"
 
+#ifdef WITH_THREADS
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#endif
+
 /***
  * template class for pool of objects
  * - useful if many small objects are frequently created and destroyed
@@ -33,6 +38,10 @@ private:
   std::vector<size_t> dataSize;
   std::deque<Object*> freeObj;
   int mode;
+#ifdef WITH_THREADS
+  bool threadSafe;
+  boost::mutex mutex;
+#endif
 public:
   static const int cleanUpOnDestruction=1;
   static const int hasTrivialDestructor=2;
@@ -47,9 +56,20 @@ public:
   //            note: looks like memory leak, but is not
   ObjectPool(std::string name_="T",size_t N_=100000,int m=cleanUpOnDestruction)
     : name(name_),idx(0),dIdx(0),N(N_),mode(m) {
+#ifdef WITH_THREADS
+    threadSafe=false;
+#endif
     allocate();
   }
 
+  // make getPtr/get/freeObject safe to call from several threads at once.
+  // the other functions still need exclusive access
+  void setThreadSafe(bool threadSafe_) {
+#ifdef WITH_THREADS
+    threadSafe=threadSafe_;
+#endif
+  }
+
   // main accesss functions:
   // get pointer to object via default or copy constructor
   Object* get() {
@@ -63,9 +83,17 @@ public:
   // WARNING: use only if you know what you are doing !
   // useful for non-default constructors, you have to use placement new
   Object* getPtr() {
+#ifdef WITH_THREADS
+    boost::unique_lock<boost::mutex> lock(mutex,boost::defer_lock);
+    if(threadSafe) lock.lock();
+#endif
     if(freeObj.size()) {
       Object* rv=freeObj.back();
       freeObj.pop_back();
+#ifdef WITH_THREADS
+      // the destructor may return other objects to this pool
+      if(lock.owns_lock()) lock.unlock();
+#endif
       rv->~Object();
       return rv;
     }
@@ -81,6 +109,10 @@ public:
   //       otherwise 'destroyObjects' would have to check the freeObj-stack
   //       before each destructor call
   void freeObject(Object* x) {
+#ifdef WITH_THREADS
+    boost::unique_lock<boost::mutex> lock(mutex,boost::defer_lock);
+    if(threadSafe) lock.lock();
+#endif
     freeObj.push_back(x);
   }
   template<class fwiter> void freeObjects(fwiter b,fwiter e) {
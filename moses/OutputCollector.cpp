@@ -0,0 +1,149 @@
+/***********************************************************************
+  Moses - factored phrase-based language decoder
+  Copyright (C) 2014- University of Edinburgh
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***********************************************************************/
+
+#include "OutputCollector.h"
+#include "StaticData.h"
+
+#ifdef WITH_THREADS
+#include <boost/bind.hpp>
+#endif
+
+namespace Moses
+{
+
+OutputCollector::OutputCollector(std::ostream* outStream, std::ostream* debugStream)
+  : m_nextOutput(0)
+  , m_outStream(outStream)
+  , m_debugStream(debugStream)
+  , m_isHoldingOutputStream(false)
+  , m_isHoldingDebugStream(false)
+#ifdef WITH_THREADS
+  , m_useWriter(StaticData::Instance().ThreadCount() > 1)
+  , m_stopping(false)
+#endif
+{
+#ifdef WITH_THREADS
+  if (m_useWriter) {
+    m_writer = boost::thread(boost::bind(&OutputCollector::WriterLoop, this));
+  }
+#endif
+}
+
+OutputCollector::~OutputCollector()
+{
+#ifdef WITH_THREADS
+  if (m_useWriter) {
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      m_stopping = true;
+    }
+    m_bufferFilled.notify_one();
+    m_writer.join();
+  }
+#endif
+  if (m_isHoldingOutputStream)
+    delete m_outStream;
+  if (m_isHoldingDebugStream)
+    delete m_debugStream;
+}
+
+void OutputCollector::Write(int sourceId,const std::string& output,const std::string& debug)
+{
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_mutex);
+  // don't let the writer fall too far behind
+  while (m_bufferedOutput.size() + m_bufferedDebug.size() > MaxBufferedBytes) {
+    m_bufferDrained.wait(lock);
+  }
+#endif
+  if (sourceId == m_nextOutput) {
+    //This is the one we were expecting
+    Emit(output, debug);
+    ++m_nextOutput;
+    //see if there's any more
+    std::map<int,std::string>::iterator iter;
+    while ((iter = m_outputs.find(m_nextOutput)) != m_outputs.end()) {
+      ++m_nextOutput;
+      std::map<int,std::string>::iterator debugIter = m_debugs.find(iter->first);
+      if (debugIter != m_debugs.end()) {
+        Emit(iter->second, debugIter->second);
+        m_debugs.erase(debugIter);
+      } else {
+        Emit(iter->second, "");
+      }
+      m_outputs.erase(iter);
+    }
+  } else {
+    //save for later
+    m_outputs[sourceId] = output;
+    m_debugs[sourceId] = debug;
+  }
+}
+
+void OutputCollector::Emit(const std::string& output, const std::string& debug)
+{
+#ifdef WITH_THREADS
+  // caller holds m_mutex
+  if (m_useWriter) {
+    bool wasEmpty = m_bufferedOutput.empty() && m_bufferedDebug.empty();
+    m_bufferedOutput += output;
+    m_bufferedDebug += debug;
+    if (wasEmpty) {
+      m_bufferFilled.notify_one();
+    }
+    return;
+  }
+#endif
+  *m_outStream << output << std::flush;
+  *m_debugStream << debug << std::flush;
+}
+
+#ifdef WITH_THREADS
+void OutputCollector::WriterLoop()
+{
+  std::string output, debug;
+  boost::mutex::scoped_lock lock(m_mutex);
+  while (true) {
+    while (m_bufferedOutput.empty() && m_bufferedDebug.empty() && !m_stopping) {
+      m_bufferFilled.wait(lock);
+    }
+    if (m_bufferedOutput.empty() && m_bufferedDebug.empty()) {
+      // stopping, and everything is written
+      break;
+    }
+    output.swap(m_bufferedOutput);
+    debug.swap(m_bufferedDebug);
+    m_bufferDrained.notify_all();
+
+    lock.unlock();
+    // one large write for everything that became ready meanwhile
+    m_outStream->write(output.data(), output.size());
+    m_outStream->flush();
+    if (!debug.empty()) {
+      m_debugStream->write(debug.data(), debug.size());
+      m_debugStream->flush();
+    }
+    output.clear();
+    debug.clear();
+    lock.lock();
+  }
+}
+#endif
+
+}  // namespace Moses
@@ -22,7 +22,9 @@
 #define moses_OutputCollector_h
 
 #ifdef WITH_THREADS
+#include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #endif
 
 #ifdef BOOST_HAS_PTHREADS
@@ -37,21 +39,24 @@
 namespace Moses
 {
 /**
-* Makes sure output goes in the correct order when multi-threading
+* Makes sure output goes in the correct order when multi-threading.
+*
+* With several decoding threads, output that is ready to go out is appended
+* to a buffer, and a dedicated writer thread writes the whole buffer at once,
+* so workers never wait for the disk. If the writer falls more than
+* MaxBufferedBytes behind, workers wait for it. With one decoding thread,
+* output is written as soon as it is next in line.
+* How far translations can run ahead of the oldest unfinished one, and so
+* how much output is held back here, is limited by the reader
+* (see IOWrapper::WaitForReorderWindow()).
 **/
 class OutputCollector
 {
 public:
-  OutputCollector(std::ostream* outStream= &std::cout, std::ostream* debugStream=&std::cerr) :
-    m_nextOutput(0),m_outStream(outStream),m_debugStream(debugStream),
-    m_isHoldingOutputStream(false), m_isHoldingDebugStream(false) {}
-
-  ~OutputCollector() {
-    if (m_isHoldingOutputStream)
-      delete m_outStream;
-    if (m_isHoldingDebugStream)
-      delete m_debugStream;
-  }
+  OutputCollector(std::ostream* outStream= &std::cout, std::ostream* debugStream=&std::cerr);
+
+  //! writes out everything still buffered
+  ~OutputCollector();
 
   void HoldOutputStream() {
     m_isHoldingOutputStream = true;
@@ -68,33 +73,8 @@ public:
   /**
     * Write or cache the output, as appropriate.
     **/
-  void Write(int sourceId,const std::string& output,const std::string& debug="") {
-#ifdef WITH_THREADS
-    boost::mutex::scoped_lock lock(m_mutex);
-#endif
-    if (sourceId == m_nextOutput) {
-      //This is the one we were expecting
-      *m_outStream << output << std::flush;
-      *m_debugStream << debug << std::flush;
-      ++m_nextOutput;
-      //see if there's any more
-      std::map<int,std::string>::iterator iter;
-      while ((iter = m_outputs.find(m_nextOutput)) != m_outputs.end()) {
-        *m_outStream << iter->second << std::flush;
-        ++m_nextOutput;
-        std::map<int,std::string>::iterator debugIter = m_debugs.find(iter->first);
-        m_outputs.erase(iter);
-        if (debugIter != m_debugs.end()) {
-          *m_debugStream << debugIter->second << std::flush;
-          m_debugs.erase(debugIter);
-        }
-      }
-    } else {
-      //save for later
-      m_outputs[sourceId] = output;
-      m_debugs[sourceId] = debug;
-    }
-  }
+  void Write(int sourceId,const std::string& output,const std::string& debug="");
+
 private:
   std::map<int,std::string> m_outputs;
   std::map<int,std::string> m_debugs;
@@ -103,8 +83,23 @@ private:
   std::ostream* m_debugStream;
   bool m_isHoldingOutputStream;
   bool m_isHoldingDebugStream;
+
+  //! send output that is next in line
+  void Emit(const std::string& output, const std::string& debug);
+
 #ifdef WITH_THREADS
+  static const size_t MaxBufferedBytes = 64 * 1024 * 1024;
+
   boost::mutex m_mutex;
+  bool m_useWriter; /**< more than one decoding thread */
+  std::string m_bufferedOutput; /**< in order, not yet written */
+  std::string m_bufferedDebug;
+  bool m_stopping;
+  boost::condition_variable m_bufferFilled; /**< signals the writer */
+  boost::condition_variable m_bufferDrained; /**< signals waiting workers */
+  boost::thread m_writer;
+
+  void WriterLoop();
 #endif
 };
 
@@ -67,6 +67,9 @@ Parameter::Parameter()
   AddParam("stack", "s", "maximum stack size for histogram pruning. 0 = unlimited stack size");
   AddParam("stack-diversity", "sd", "minimum number of hypothesis of each coverage in stack (default 0)");
   AddParam("threads","th", "number of threads to use in decoding (defaults to single-threaded)");
+  AddParam("threads-longest-first", "with multiple threads, translate the longest queued input first (default false)");
+  AddParam("threads-per-sentence", "number of threads working on each sentence: chart cells of equal width, or the hypotheses of one stack in normal phrase-based search, are decoded in parallel, and phrase-based translation options are collected per start position in parallel (default 1)");
+  AddParam("threads-reorder-window", "with multiple threads, maximum number of sentences read ahead of the oldest one not yet output. 0 = unlimited (default 10000)");
   AddParam("translation-details", "T", "for each best hypothesis, report translation details to the given file");
   AddParam("tree-translation-details", "Ttree", "for each hypothesis, report translation details with tree fragment info to given file");
   //DIMw
@@ -120,7 +123,7 @@ Parameter::Parameter()
   AddParam("output-hypo-score", "Output the hypo score to stdout with the output string. For search error analysis. Default is false");
   AddParam("unknown-lhs", "file containing target lhs of unknown words. 1 per line: LHS prob");
   AddParam("cube-pruning-lazy-scoring", "cbls", "Don't fully score a hypothesis until it is popped");
-  AddParam("search-algorithm", "Which search algorithm to use. 0=normal stack, 1=cube pruning, 2=cube growing, 4=stack with batched lm requests (default = 0)");
+  AddParam("search-algorithm", "Which search algorithm to use. 0=normal stack, 1=cube pruning, 2=cube growing, 4=stack with batched feature evaluation (default = 0)");
   AddParam("link-param-count", "Number of parameters on word links when using confusion networks or lattices (default = 1)");
   AddParam("description", "Source language, target language, description");
 
@@ -135,8 +135,7 @@ public:
     return ptr[factorType];
   }
   inline void SetFactor(size_t pos, FactorType factorType, const Factor *factor) {
-    Word &ptr = m_words[pos];
-    ptr[factorType] = factor;
+    m_words[pos].SetFactor(factorType, factor);
   }
 
   size_t GetNumTerminals() const;
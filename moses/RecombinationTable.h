@@ -0,0 +1,229 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_RecombinationTable_h
+#define moses_RecombinationTable_h
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace Moses
+{
+
+/** Open-addressing hash set of pointers, used to find recombinable
+ * hypotheses in a stack.
+ * - Hasher(T) must give equal hashes for items that Equal(T, T) says can
+ *   be recombined. Full hashes are stored, so Equal is only called when the
+ *   hashes match.
+ * - linear probing with tombstones: erase() never moves other entries, so
+ *   iterators to other entries stay valid. insert() may rehash and
+ *   invalidate all iterators.
+ * - iteration order is unspecified
+ */
+template <class T, class Hasher, class Equal>
+class RecombinationTable
+{
+  enum SlotState { Empty = 0, Full, Deleted };
+
+  struct Slot {
+    T value;
+    size_t hash;
+    char state;
+    Slot() : value(), hash(0), state(Empty) {}
+  };
+
+  typedef std::vector<Slot> Slots;
+
+public:
+  class iterator
+  {
+    friend class RecombinationTable;
+    const Slot *m_slot, *m_end;
+
+    iterator(const Slot *slot, const Slot *end) : m_slot(slot), m_end(end) {
+      SkipFree();
+    }
+    void SkipFree() {
+      while (m_slot != m_end && m_slot->state != Full) {
+        ++m_slot;
+      }
+    }
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const T* pointer;
+    typedef const T& reference;
+
+    iterator() : m_slot(NULL), m_end(NULL) {}
+
+    reference operator*() const {
+      return m_slot->value;
+    }
+    pointer operator->() const {
+      return &m_slot->value;
+    }
+    iterator &operator++() {
+      ++m_slot;
+      SkipFree();
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator ret = *this;
+      ++*this;
+      return ret;
+    }
+    bool operator==(const iterator &other) const {
+      return m_slot == other.m_slot;
+    }
+    bool operator!=(const iterator &other) const {
+      return m_slot != other.m_slot;
+    }
+  };
+  // like std::set, elements can't be modified through an iterator
+  typedef iterator const_iterator;
+
+  explicit RecombinationTable(size_t initialCapacity = 32)
+    : m_slots(RoundUpPowerOfTwo(initialCapacity))
+    , m_size(0)
+    , m_deleted(0) {
+  }
+
+  iterator begin() const {
+    return iterator(Begin(), End());
+  }
+  iterator end() const {
+    return iterator(End(), End());
+  }
+  size_t size() const {
+    return m_size;
+  }
+  bool empty() const {
+    return m_size == 0;
+  }
+
+  /** add item, unless an equivalent one is already present.
+   * Returns an iterator to the new or existing item, and whether the
+   * item was added */
+  std::pair<iterator, bool> insert(const T &value) {
+    // keep load (including tombstones) at most 1/2
+    if ((m_size + m_deleted + 1) * 2 > m_slots.size()) {
+      Rehash(m_size * 4 >= m_slots.size() ? m_slots.size() * 2 : m_slots.size());
+    }
+
+    const size_t hash = m_hasher(value);
+    const size_t mask = m_slots.size() - 1;
+    Slot *tombstone = NULL;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+      Slot &slot = m_slots[i];
+      if (slot.state == Empty) {
+        Slot &target = tombstone ? *tombstone : slot;
+        if (tombstone) {
+          --m_deleted;
+        }
+        target.value = value;
+        target.hash = hash;
+        target.state = Full;
+        ++m_size;
+        return std::make_pair(iterator(&target, End()), true);
+      } else if (slot.state == Deleted) {
+        if (tombstone == NULL) {
+          tombstone = &slot;
+        }
+      } else if (slot.hash == hash && m_equal(slot.value, value)) {
+        return std::make_pair(iterator(&slot, End()), false);
+      }
+    }
+  }
+
+  //! find equivalent item, or end()
+  iterator find(const T &value) const {
+    const size_t hash = m_hasher(value);
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+      const Slot &slot = m_slots[i];
+      if (slot.state == Empty) {
+        return end();
+      } else if (slot.state == Full && slot.hash == hash && m_equal(slot.value, value)) {
+        return iterator(&slot, End());
+      }
+    }
+  }
+
+  void erase(const iterator &iter) {
+    Slot &slot = const_cast<Slot&>(*iter.m_slot);
+    slot.state = Deleted;
+    slot.value = T();
+    --m_size;
+    ++m_deleted;
+    if (m_size == 0) {
+      // no live iterators other than end(), so tombstones can go
+      clear();
+    }
+  }
+
+  void clear() {
+    for (size_t i = 0; i < m_slots.size(); ++i) {
+      m_slots[i] = Slot();
+    }
+    m_size = 0;
+    m_deleted = 0;
+  }
+
+private:
+  Slots m_slots; /**< size is always a power of 2 */
+  size_t m_size; /**< number of Full slots */
+  size_t m_deleted; /**< number of Deleted slots */
+  Hasher m_hasher;
+  Equal m_equal;
+
+  const Slot *Begin() const {
+    return &m_slots[0];
+  }
+  const Slot *End() const {
+    return &m_slots[0] + m_slots.size();
+  }
+
+  static size_t RoundUpPowerOfTwo(size_t n) {
+    size_t ret = 2;
+    while (ret < n) ret <<= 1;
+    return ret;
+  }
+
+  void Rehash(size_t capacity) {
+    Slots old(capacity);
+    old.swap(m_slots);
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = 0; i < old.size(); ++i) {
+      if (old[i].state != Full) continue;
+      size_t pos = old[i].hash & mask;
+      while (m_slots[pos].state == Full) {
+        pos = (pos + 1) & mask;
+      }
+      m_slots[pos] = old[i];
+    }
+    m_deleted = 0;
+  }
+};
+
+}
+
+#endif
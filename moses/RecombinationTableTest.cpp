@@ -0,0 +1,107 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <set>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "RecombinationTable.h"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+// items recombine if they are equal mod 100. The weak hash forces collisions.
+struct ModHasher {
+  size_t operator()(const int *i) const {
+    return (*i % 100) % 7;
+  }
+};
+
+struct ModEqual {
+  bool operator()(const int *a, const int *b) const {
+    return *a % 100 == *b % 100;
+  }
+};
+
+typedef RecombinationTable<const int*, ModHasher, ModEqual> Table;
+
+}
+
+BOOST_AUTO_TEST_SUITE(recombination_table)
+
+BOOST_AUTO_TEST_CASE(insert_find_erase)
+{
+  vector<int> values;
+  for (int i = 0; i < 300; ++i) values.push_back(i);
+
+  Table table(4);
+  for (size_t i = 0; i < 100; ++i) {
+    BOOST_CHECK(table.insert(&values[i]).second);
+  }
+  BOOST_CHECK_EQUAL(table.size(), 100);
+
+  // 100..199 recombine with 0..99
+  for (size_t i = 100; i < 200; ++i) {
+    pair<Table::iterator, bool> ret = table.insert(&values[i]);
+    BOOST_CHECK(!ret.second);
+    BOOST_CHECK_EQUAL(**ret.first, values[i - 100]);
+  }
+  BOOST_CHECK_EQUAL(table.size(), 100);
+
+  // erase the even ones while iterating
+  for (Table::iterator iter = table.begin(); iter != table.end(); ) {
+    Table::iterator iterRemove = iter++;
+    if (**iterRemove % 2 == 0) table.erase(iterRemove);
+  }
+  BOOST_CHECK_EQUAL(table.size(), 50);
+  BOOST_CHECK(table.find(&values[202]) == table.end());
+  BOOST_CHECK(table.find(&values[203]) != table.end());
+
+  // reinsert into tombstones
+  BOOST_CHECK(table.insert(&values[202]).second);
+  BOOST_CHECK_EQUAL(**table.find(&values[2]), 202);
+
+  set<int> seen;
+  for (Table::const_iterator iter = table.begin(); iter != table.end(); ++iter) {
+    BOOST_CHECK(seen.insert(**iter).second);
+  }
+  BOOST_CHECK_EQUAL(seen.size(), table.size());
+}
+
+BOOST_AUTO_TEST_CASE(erase_all)
+{
+  int a = 1, b = 2;
+  Table table;
+  table.insert(&a);
+  table.insert(&b);
+  for (Table::iterator iter = table.begin(); iter != table.end(); ) {
+    Table::iterator iterRemove = iter++;
+    table.erase(iterRemove);
+  }
+  BOOST_CHECK(table.empty());
+  BOOST_CHECK(table.begin() == table.end());
+  BOOST_CHECK(table.insert(&a).second);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
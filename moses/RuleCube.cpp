@@ -68,36 +68,46 @@ RuleCubeItem *RuleCube::Pop(ChartManager &manager)
 // create new RuleCube for neighboring principle rules
 void RuleCube::CreateNeighbors(const RuleCubeItem &item, ChartManager &manager)
 {
+  m_neighbors.clear();
+
   // create neighbor along translation dimension
   const TranslationDimension &translationDimension =
     item.GetTranslationDimension();
   if (translationDimension.HasMoreTranslations()) {
-    CreateNeighbor(item, -1, manager);
+    CreateNeighbor(item, -1);
   }
 
   // create neighbors along all hypothesis dimensions
   for (size_t i = 0; i < item.GetHypothesisDimensions().size(); ++i) {
     const HypothesisDimension &dimension = item.GetHypothesisDimensions()[i];
     if (dimension.HasMoreHypo()) {
-      CreateNeighbor(item, i, manager);
+      CreateNeighbor(item, i);
     }
   }
+
+  // score the new neighbors together, so that feature functions can
+  // prefetch for all of them before scoring any
+  std::vector<RuleCubeItem*>::const_iterator iter;
+  if (StaticData::Instance().GetCubePruningLazyScoring()) {
+    for (iter = m_neighbors.begin(); iter != m_neighbors.end(); ++iter) {
+      (*iter)->EstimateScore();
+    }
+  } else if (!m_neighbors.empty()) {
+    RuleCubeItem::CreateHypotheses(m_neighbors, m_transOpt, manager);
+  }
+  for (iter = m_neighbors.begin(); iter != m_neighbors.end(); ++iter) {
+    m_queue.push(*iter);
+  }
 }
 
-void RuleCube::CreateNeighbor(const RuleCubeItem &item, int dimensionIndex,
-                              ChartManager &manager)
+void RuleCube::CreateNeighbor(const RuleCubeItem &item, int dimensionIndex)
 {
   RuleCubeItem *newItem = new RuleCubeItem(item, dimensionIndex);
   std::pair<ItemSet::iterator, bool> result = m_covered.insert(newItem);
   if (!result.second) {
     delete newItem;  // already seen it
   } else {
-    if (StaticData::Instance().GetCubePruningLazyScoring()) {
-      newItem->EstimateScore();
-    } else {
-      newItem->CreateHypothesis(m_transOpt, manager);
-    }
-    m_queue.push(newItem);
+    m_neighbors.push_back(newItem);
   }
 }
 
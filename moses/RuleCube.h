@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include "DaryHeap.h"
 #include "RuleCubeItem.h"
 
 #include <boost/functional/hash.hpp>
@@ -28,7 +29,6 @@
 #include <boost/version.hpp>
 
 #include "util/exception.hh"
-#include <queue>
 #include <set>
 #include <vector>
 
@@ -117,20 +117,18 @@ private:
           RuleCubeItemEqualityPred
           > ItemSet;
 
-  typedef std::priority_queue<RuleCubeItem*,
-          std::vector<RuleCubeItem*>,
-          RuleCubeItemScoreOrderer
-          > Queue;
+  typedef DaryHeap<RuleCubeItem*, RuleCubeItemScoreOrderer> Queue;
 
   RuleCube(const RuleCube &);  // Not implemented
   RuleCube &operator=(const RuleCube &);  // Not implemented
 
   void CreateNeighbors(const RuleCubeItem &, ChartManager &);
-  void CreateNeighbor(const RuleCubeItem &, int, ChartManager &);
+  void CreateNeighbor(const RuleCubeItem &, int);
 
   const ChartTranslationOptions &m_transOpt;
   ItemSet m_covered;
   Queue m_queue;
+  std::vector<RuleCubeItem*> m_neighbors; /**< new neighbours of the last popped item, to be scored together */
 };
 
 }
@@ -83,6 +83,24 @@ void RuleCubeItem::CreateHypothesis(const ChartTranslationOptions &transOpt,
   m_score = m_hypothesis->GetTotalScore();
 }
 
+void RuleCubeItem::CreateHypotheses(const std::vector<RuleCubeItem*> &items,
+                                    const ChartTranslationOptions &transOpt,
+                                    ChartManager &manager)
+{
+  std::vector<ChartHypothesis*> hypos;
+  hypos.reserve(items.size());
+  std::vector<RuleCubeItem*>::const_iterator iter;
+  for (iter = items.begin(); iter != items.end(); ++iter) {
+    RuleCubeItem &item = **iter;
+    item.m_hypothesis = new ChartHypothesis(transOpt, item, manager);
+    hypos.push_back(item.m_hypothesis);
+  }
+  ChartHypothesis::EvaluateWhenAppliedBatch(hypos);
+  for (iter = items.begin(); iter != items.end(); ++iter) {
+    (*iter)->m_score = (*iter)->m_hypothesis->GetTotalScore();
+  }
+}
+
 ChartHypothesis *RuleCubeItem::ReleaseHypothesis()
 {
   UTIL_THROW_IF2(m_hypothesis == NULL, "Hypothesis is NULL");
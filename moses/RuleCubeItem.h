@@ -133,6 +133,10 @@ public:
 
   void CreateHypothesis(const ChartTranslationOptions &, ChartManager &);
 
+  //! same as CreateHypothesis() on each item, but scored as one batch
+  static void CreateHypotheses(const std::vector<RuleCubeItem*> &,
+                               const ChartTranslationOptions &, ChartManager &);
+
   ChartHypothesis *ReleaseHypothesis();
 
   bool operator<(const RuleCubeItem &) const;
@@ -43,9 +43,9 @@ void RuleCubeQueue::Add(RuleCube *ruleCube)
 
 ChartHypothesis *RuleCubeQueue::Pop()
 {
-  // pop the most promising rule cube
+  // take the most promising rule cube. It stays at the top of the queue
+  // until its new score is known
   RuleCube *cube = m_queue.top();
-  m_queue.pop();
 
   // pop the most promising item from the cube and get the corresponding
   // hypothesis
@@ -55,10 +55,11 @@ ChartHypothesis *RuleCubeQueue::Pop()
   }
   ChartHypothesis *hypo = item->ReleaseHypothesis();
 
-  // if the cube contains more items then push it back onto the queue
+  // if the cube contains more items then put it back in place on the queue
   if (!cube->IsEmpty()) {
-    m_queue.push(cube);
+    m_queue.ReplaceTop(cube);
   } else {
+    m_queue.pop();
     delete cube;
   }
 
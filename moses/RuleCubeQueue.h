@@ -21,9 +21,9 @@
 
 #pragma once
 
+#include "DaryHeap.h"
 #include "RuleCube.h"
 
-#include <queue>
 #include <vector>
 
 namespace Moses
@@ -56,8 +56,7 @@ public:
   }
 
 private:
-  typedef std::priority_queue<RuleCube*, std::vector<RuleCube*>,
-          RuleCubeOrderer > Queue;
+  typedef DaryHeap<RuleCube*, RuleCubeOrderer> Queue;
 
   Queue m_queue;
   ChartManager &m_manager;
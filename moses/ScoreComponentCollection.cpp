@@ -84,7 +84,7 @@ void ScoreComponentCollection::MultiplyEquals(float scalar)
 void ScoreComponentCollection::MultiplyEquals(const FeatureFunction* sp, float scalar)
 {
   std::string prefix = sp->GetScoreProducerDescription() + FName::SEP;
-  for(FVector::FNVmap::const_iterator i = m_scores.cbegin(); i != m_scores.cend(); i++) {
+  for(FVector::const_iterator i = m_scores.cbegin(); i != m_scores.cend(); i++) {
     std::stringstream name;
     name << i->first;
     if (name.str().substr( 0, prefix.length() ).compare( prefix ) == 0)
@@ -97,7 +97,7 @@ size_t ScoreComponentCollection::GetNumberWeights(const FeatureFunction* sp)
 {
   std::string prefix = sp->GetScoreProducerDescription() + FName::SEP;
   size_t weights = 0;
-  for(FVector::FNVmap::const_iterator i = m_scores.cbegin(); i != m_scores.cend(); i++) {
+  for(FVector::const_iterator i = m_scores.cbegin(); i != m_scores.cend(); i++) {
     std::stringstream name;
     name << i->first;
     if (name.str().substr( 0, prefix.length() ).compare( prefix ) == 0)
@@ -282,7 +282,7 @@ FVector ScoreComponentCollection::GetVectorForProducer(const FeatureFunction* sp
 {
   FVector fv(s_denseVectorSize);
   std::string prefix = sp->GetScoreProducerDescription() + FName::SEP;
-  for(FVector::FNVmap::const_iterator i = m_scores.cbegin(); i != m_scores.cend(); i++) {
+  for(FVector::const_iterator i = m_scores.cbegin(); i != m_scores.cend(); i++) {
     std::stringstream name;
     name << i->first;
     if (name.str().substr( 0, prefix.length() ).compare( prefix ) == 0)
@@ -343,7 +343,7 @@ void ScoreComponentCollection::OutputFeatureScores( std::ostream& out
 
   // sparse features
   const FVector scores = GetVectorForProducer( ff );
-  for(FVector::FNVmap::const_iterator i = scores.cbegin(); i != scores.cend(); i++) {
+  for(FVector::const_iterator i = scores.cbegin(); i != scores.cend(); i++) {
     out << " " << i->first << "= " << i->second;
   }
 }
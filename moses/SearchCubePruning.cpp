@@ -42,6 +42,7 @@ SearchCubePruning::SearchCubePruning(Manager& manager, const InputType &source,
   ,m_source(source)
   ,m_hypoStackColl(source.GetSize() + 1)
   ,m_transOptColl(transOptColl)
+  ,m_futureScoreCache(transOptColl.GetFutureScore())
 {
   const StaticData &staticData = StaticData::Instance();
 
@@ -221,10 +222,10 @@ void SearchCubePruning::CreateForwardTodos(const WordsBitmap &bitmap, const Word
 
   size_t numCovered = newBitmap.GetNumWordsCovered();
   const TranslationOptionList &transOptList = m_transOptColl.GetTranslationOptionList(range);
-  const SquareMatrix &futureScore = m_transOptColl.GetFutureScore();
 
   if (transOptList.size() > 0) {
     HypothesisStackCubePruning &newStack = *static_cast<HypothesisStackCubePruning*>(m_hypoStackColl[numCovered]);
+    const float futureScore = m_futureScoreCache.Get(newBitmap);
     newStack.SetBitmapAccessor(newBitmap, newStack, range, bitmapContainer, futureScore, transOptList);
   }
 }
@@ -2,6 +2,8 @@
 #include "Timer.h"
 #include "SearchNormal.h"
 #include "SentenceStats.h"
+#include "ThreadPool.h"
+#include "moses/FF/FeatureFunction.h"
 
 using namespace std;
 
@@ -19,6 +21,7 @@ SearchNormal::SearchNormal(Manager& manager, const InputType &source, const Tran
   ,m_hypoStackColl(source.GetSize() + 1)
   ,interrupted_flag(0)
   ,m_transOptColl(transOptColl)
+  ,m_futureScoreCache(transOptColl.GetFutureScore())
 {
   VERBOSE(1, "Translating: " << m_source << endl);
   const StaticData &staticData = StaticData::Instance();
@@ -56,6 +59,15 @@ void SearchNormal::Decode()
   Hypothesis *hypo = Hypothesis::Create(m_manager,m_source, m_initialTransOpt);
   m_hypoStackColl[0]->AddPrune(hypo);
 
+#ifdef WITH_THREADS
+  // features that keep per-input state in InitializeForInput(), e.g. in
+  // thread local storage, only see it on this thread
+  ThreadPool *pool = staticData.GetSentenceThreadPool();
+  if (pool && (m_manager.GetThreadsPerSentence() <= 1 || !FeatureFunction::AllSupportConcurrentEvaluationWhenApplied())) {
+    pool = NULL;
+  }
+#endif
+
   // go through each stack
   std::vector < HypothesisStack* >::iterator iterStack;
   for (iterStack = m_hypoStackColl.begin() ; iterStack != m_hypoStackColl.end() ; ++iterStack) {
@@ -80,11 +92,21 @@ void SearchNormal::Decode()
       stats.StopTimeStack();
     }
 
-    // go through each hypothesis on the stack and try to expand it
-    HypothesisStackNormal::const_iterator iterHypo;
-    for (iterHypo = sourceHypoColl.begin() ; iterHypo != sourceHypoColl.end() ; ++iterHypo) {
-      Hypothesis &hypothesis = **iterHypo;
-      ProcessOneHypothesis(hypothesis); // expand the hypothesis
+    bool expandedConcurrently = false;
+#ifdef WITH_THREADS
+    if (pool && sourceHypoColl.size() > 1) {
+      ExpandStackConcurrently(sourceHypoColl, *pool);
+      expandedConcurrently = true;
+    }
+#endif
+
+    if (!expandedConcurrently) {
+      // go through each hypothesis on the stack and try to expand it
+      HypothesisStackNormal::const_iterator iterHypo;
+      for (iterHypo = sourceHypoColl.begin() ; iterHypo != sourceHypoColl.end() ; ++iterHypo) {
+        Hypothesis &hypothesis = **iterHypo;
+        ProcessOneHypothesis(hypothesis); // expand the hypothesis
+      }
     }
     // some logging
     IFVERBOSE(2) {
@@ -99,20 +121,89 @@ void SearchNormal::Decode()
 }
 
 
+#ifdef WITH_THREADS
+/** expands a slice of the current stack, keeping the new hypotheses
+ * until they are added to the stacks by the thread running the search */
+class SearchNormal::ExpandTask : public Task
+{
+public:
+  ExpandTask(SearchNormal &search, const std::vector<const Hypothesis*> &hypos, size_t begin, size_t end)
+    : m_search(search)
+    , m_hypos(hypos)
+    , m_begin(begin)
+    , m_end(end)
+    , m_futureScores(search.m_transOptColl.GetFutureScore()) {}
+
+  virtual void Run() {
+    for (size_t i = m_begin; i < m_end; ++i) {
+      m_search.ProcessOneHypothesis(*m_hypos[i], &m_expanded, &m_futureScores);
+    }
+  }
+
+  virtual bool DeleteAfterExecution() {
+    return false;
+  }
+
+  const std::vector<Hypothesis*> &GetExpanded() const {
+    return m_expanded;
+  }
+
+private:
+  SearchNormal &m_search;
+  const std::vector<const Hypothesis*> &m_hypos;
+  size_t m_begin, m_end;
+  std::vector<Hypothesis*> m_expanded;
+  FutureScoreCache m_futureScores;
+};
+
+/** Expansions of different hypotheses don't depend on each other until they
+ * are added to the stacks. So slices of the stack are expanded in parallel,
+ * and the new hypotheses are then added in the order serial expansion would
+ * add them. The only difference is that early discarding sees the stacks as
+ * they were before this stack was expanded.
+ */
+void SearchNormal::ExpandStackConcurrently(const HypothesisStackNormal &sourceHypoColl, ThreadPool &pool)
+{
+  const std::vector<const Hypothesis*> hypos(sourceHypoColl.begin(), sourceHypoColl.end());
+
+  // several small slices per thread, so that threads that finish early can take more
+  const size_t sliceSize = std::max<size_t>(1, hypos.size() / (m_manager.GetThreadsPerSentence() * 4));
+  std::vector<ExpandTask*> tasks;
+  for (size_t begin = 0; begin < hypos.size(); begin += sliceSize) {
+    tasks.push_back(new ExpandTask(*this, hypos, begin, std::min(begin + sliceSize, hypos.size())));
+  }
+  pool.RunAndWait(std::vector<Task*>(tasks.begin(), tasks.end()));
+
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    const std::vector<Hypothesis*> &expanded = tasks[i]->GetExpanded();
+    for (size_t j = 0; j < expanded.size(); ++j) {
+      AddHypothesis(expanded[j]);
+    }
+  }
+  RemoveAllInColl(tasks);
+}
+#endif
+
 /** Find all translation options to expand one hypothesis, trigger expansion
  * this is mostly a check for overlap with already covered words, and for
  * violation of reordering limits.
  * \param hypothesis hypothesis to be expanded upon
+ * \param expanded if not NULL, store new hypotheses here instead of adding them to the stacks
+ * \param futureScores if not NULL, use these instead of the search's cached future scores
  */
-void SearchNormal::ProcessOneHypothesis(const Hypothesis &hypothesis)
+void SearchNormal::ProcessOneHypothesis(const Hypothesis &hypothesis, std::vector<Hypothesis*> *expanded, FutureScoreCache *futureScores)
 {
+  if (!futureScores) {
+    futureScores = &m_futureScoreCache;
+  }
+
   // since we check for reordering limits, its good to have that limit handy
   int maxDistortion = StaticData::Instance().GetMaxDistortion();
   bool isWordLattice = StaticData::Instance().GetInputType() == WordLatticeInput;
 
   // no limit of reordering: only check for overlap
   if (maxDistortion < 0) {
-    const WordsBitmap hypoBitmap	= hypothesis.GetWordsBitmap();
+    const WordsBitmap &hypoBitmap	= hypothesis.GetWordsBitmap();
     const size_t hypoFirstGapPos	= hypoBitmap.GetFirstGapPos()
                                     , sourceSize			= m_source.GetSize();
 
@@ -133,7 +224,7 @@ void SearchNormal::ProcessOneHypothesis(const Hypothesis &hypothesis)
         }
 
         //TODO: does this method include incompatible WordLattice hypotheses?
-        ExpandAllHypotheses(hypothesis, startPos, endPos);
+        ExpandAllHypotheses(hypothesis, startPos, endPos, expanded, *futureScores);
       }
     }
 
@@ -142,7 +233,7 @@ void SearchNormal::ProcessOneHypothesis(const Hypothesis &hypothesis)
 
   // if there are reordering limits, make sure it is not violated
   // the coverage bitmap is handy here (and the position of the first gap)
-  const WordsBitmap hypoBitmap = hypothesis.GetWordsBitmap();
+  const WordsBitmap &hypoBitmap = hypothesis.GetWordsBitmap();
   const size_t	hypoFirstGapPos	= hypoBitmap.GetFirstGapPos()
                                   , sourceSize			= m_source.GetSize();
 
@@ -207,7 +298,7 @@ void SearchNormal::ProcessOneHypothesis(const Hypothesis &hypothesis)
 
       // any length extension is okay if starting at left-most edge
       if (leftMostEdge) {
-        ExpandAllHypotheses(hypothesis, startPos, endPos);
+        ExpandAllHypotheses(hypothesis, startPos, endPos, expanded, *futureScores);
       }
       // starting somewhere other than left-most edge, use caution
       else {
@@ -227,7 +318,7 @@ void SearchNormal::ProcessOneHypothesis(const Hypothesis &hypothesis)
         }
 
         // everything is fine, we're good to go
-        ExpandAllHypotheses(hypothesis, startPos, endPos);
+        ExpandAllHypotheses(hypothesis, startPos, endPos, expanded, *futureScores);
 
       }
     }
@@ -240,10 +331,16 @@ void SearchNormal::ProcessOneHypothesis(const Hypothesis &hypothesis)
  * \param hypothesis hypothesis to be expanded upon
  * \param startPos first word position of span covered
  * \param endPos last word position of span covered
+ * \param expanded if not NULL, store new hypotheses here instead of adding them to the stacks
+ * \param futureScores future scores of coverages seen so far
  */
 
-void SearchNormal::ExpandAllHypotheses(const Hypothesis &hypothesis, size_t startPos, size_t endPos)
+void SearchNormal::ExpandAllHypotheses(const Hypothesis &hypothesis, size_t startPos, size_t endPos, std::vector<Hypothesis*> *expanded, FutureScoreCache &futureScores)
 {
+  // all extensions cover the same words, so they share one future score.
+  // Other hypotheses may have reached the same coverage before
+  const float futureScore = futureScores.Get( hypothesis.GetWordsBitmap(), startPos, endPos );
+
   // early discarding: check if hypothesis is too bad to build
   // this idea is explained in (Moore&Quirk, MT Summit 2007)
   float expectedScore = 0.0f;
@@ -252,14 +349,21 @@ void SearchNormal::ExpandAllHypotheses(const Hypothesis &hypothesis, size_t star
     expectedScore = hypothesis.GetScore();
 
     // add new future score estimate
-    expectedScore += m_transOptColl.GetFutureScore().CalcFutureScore( hypothesis.GetWordsBitmap(), startPos, endPos );
+    expectedScore += futureScore;
   }
 
   // loop through all translation options
   const TranslationOptionList &transOptList = m_transOptColl.GetTranslationOptionList(WordsRange(startPos, endPos));
   TranslationOptionList::const_iterator iter;
   for (iter = transOptList.begin() ; iter != transOptList.end() ; ++iter) {
-    ExpandHypothesis(hypothesis, **iter, expectedScore);
+    if (expanded) {
+      Hypothesis *newHypo = CreateHypothesis(hypothesis, **iter, expectedScore, futureScore);
+      if (newHypo != NULL) {
+        expanded->push_back(newHypo);
+      }
+    } else {
+      ExpandHypothesis(hypothesis, **iter, expectedScore, futureScore);
+    }
   }
 }
 
@@ -271,8 +375,22 @@ void SearchNormal::ExpandAllHypotheses(const Hypothesis &hypothesis, size_t star
  *        that is applied to create the new hypothesis
  * \param expectedScore base score for early discarding
  *        (base hypothesis score plus future score estimation)
+ * \param futureScore future score estimate of the new hypothesis' coverage
  */
-void SearchNormal::ExpandHypothesis(const Hypothesis &hypothesis, const TranslationOption &transOpt, float expectedScore)
+void SearchNormal::ExpandHypothesis(const Hypothesis &hypothesis, const TranslationOption &transOpt, float expectedScore, float futureScore)
+{
+  Hypothesis *newHypo = CreateHypothesis(hypothesis, transOpt, expectedScore, futureScore);
+  if (newHypo != NULL) {
+    AddHypothesis(newHypo);
+  }
+}
+
+/**
+ * Create and score the extension of a hypothesis with a translation option.
+ * Only reads the stacks, so several threads may create hypotheses at once.
+ * \return the new hypothesis, or NULL if early discarding rejected it
+ */
+Hypothesis *SearchNormal::CreateHypothesis(const Hypothesis &hypothesis, const TranslationOption &transOpt, float expectedScore, float futureScore)
 {
   const StaticData &staticData = StaticData::Instance();
   SentenceStats &stats = m_manager.GetSentenceStats();
@@ -287,8 +405,8 @@ void SearchNormal::ExpandHypothesis(const Hypothesis &hypothesis, const Translat
     IFVERBOSE(2) {
       stats.StopTimeBuildHyp();
     }
-    if (newHypo==NULL) return;
-    newHypo->EvaluateWhenApplied(m_transOptColl.GetFutureScore());
+    if (newHypo==NULL) return NULL;
+    newHypo->EvaluateWhenApplied(futureScore);
   } else
     // early discarding: check if hypothesis is too bad to build
   {
@@ -310,7 +428,7 @@ void SearchNormal::ExpandHypothesis(const Hypothesis &hypothesis, const Translat
       IFVERBOSE(2) {
         stats.AddNotBuilt();
       }
-      return;
+      return NULL;
     }
 
     // build the hypothesis without scoring
@@ -318,7 +436,7 @@ void SearchNormal::ExpandHypothesis(const Hypothesis &hypothesis, const Translat
       stats.StartTimeBuildHyp();
     }
     newHypo = hypothesis.CreateNext(transOpt);
-    if (newHypo==NULL) return;
+    if (newHypo==NULL) return NULL;
     IFVERBOSE(2) {
       stats.StopTimeBuildHyp();
     }
@@ -329,11 +447,19 @@ void SearchNormal::ExpandHypothesis(const Hypothesis &hypothesis, const Translat
         stats.AddEarlyDiscarded();
       }
       FREEHYPO( newHypo );
-      return;
+      return NULL;
     }
 
   }
 
+  return newHypo;
+}
+
+//! add a new hypothesis to the stack for its number of translated words
+void SearchNormal::AddHypothesis(Hypothesis *newHypo)
+{
+  SentenceStats &stats = m_manager.GetSentenceStats();
+
   // logging for the curious
   IFVERBOSE(3) {
     newHypo->PrintHypothesis();
@@ -4,6 +4,7 @@
 #include <vector>
 #include "Search.h"
 #include "HypothesisStackNormal.h"
+#include "SquareMatrix.h"
 #include "TranslationOptionCollection.h"
 #include "Timer.h"
 
@@ -13,6 +14,9 @@ namespace Moses
 class Manager;
 class InputType;
 class TranslationOptionCollection;
+#ifdef WITH_THREADS
+class ThreadPool;
+#endif
 
 /** Functions and variables you need to decoder an input using the phrase-based decoder (NO cube-pruning)
  *  Instantiated by the Manager class
@@ -26,11 +30,22 @@ protected:
   size_t interrupted_flag; /**< flag indicating that decoder ran out of time (see switch -time-out) */
   HypothesisStackNormal* actual_hypoStack; /**actual (full expanded) stack of hypotheses*/
   const TranslationOptionCollection &m_transOptColl; /**< pre-computed list of translation options for the phrases in this sentence */
+  FutureScoreCache m_futureScoreCache; /**< future scores of the coverages of new hypotheses */
+
+  // functions for creating hypotheses.
+  // If expanded is given, new hypotheses are stored there rather than added to
+  // the stacks, and several threads may expand hypotheses at once, each with
+  // its own futureScores
+  void ProcessOneHypothesis(const Hypothesis &hypothesis, std::vector<Hypothesis*> *expanded = NULL, FutureScoreCache *futureScores = NULL);
+  void ExpandAllHypotheses(const Hypothesis &hypothesis, size_t startPos, size_t endPos, std::vector<Hypothesis*> *expanded, FutureScoreCache &futureScores);
+  virtual void ExpandHypothesis(const Hypothesis &hypothesis,const TranslationOption &transOpt, float expectedScore, float futureScore);
+  Hypothesis *CreateHypothesis(const Hypothesis &hypothesis, const TranslationOption &transOpt, float expectedScore, float futureScore);
+  void AddHypothesis(Hypothesis *hypo);
 
-  // functions for creating hypotheses
-  void ProcessOneHypothesis(const Hypothesis &hypothesis);
-  void ExpandAllHypotheses(const Hypothesis &hypothesis, size_t startPos, size_t endPos);
-  virtual void ExpandHypothesis(const Hypothesis &hypothesis,const TranslationOption &transOpt, float expectedScore);
+#ifdef WITH_THREADS
+  class ExpandTask;
+  void ExpandStackConcurrently(const HypothesisStackNormal &sourceHypoColl, ThreadPool &pool);
+#endif
 
 public:
   SearchNormal(Manager& manager, const InputType &source, const TranslationOptionCollection &transOptColl);
@@ -106,7 +106,7 @@ void SearchNormalBatch::Decode()
 void
 SearchNormalBatch::
 ExpandHypothesis(const Hypothesis &hypothesis,
-                 const TranslationOption &transOpt, float expectedScore)
+                 const TranslationOption &transOpt, float expectedScore, float /* futureScore */)
 {
   // Check if the number of partial hypotheses exceeds the batch size.
   if (m_partial_hypos.size() >= m_batch_size) {
@@ -146,21 +146,28 @@ ExpandHypothesis(const Hypothesis &hypothesis,
 
 void SearchNormalBatch::EvalAndMergePartialHypos()
 {
+  SentenceStats &stats = m_manager.GetSentenceStats();
+  IFVERBOSE(2) {
+    stats.StartTimeOtherScore();
+  }
+
+  // Evaluate with other ffs. Each stateful feature gets the whole batch at
+  // once, so that it can overlap the work for independent hypotheses.
+  std::map<int, StatefulFeatureFunction*>::iterator sfff_iter;
+  for (sfff_iter = m_stateful_ffs.begin();
+       sfff_iter != m_stateful_ffs.end();
+       ++sfff_iter) {
+    const StatefulFeatureFunction &ff = *(sfff_iter->second);
+    int state_idx = sfff_iter->first;
+    ff.EvaluateWhenAppliedBatch(m_partial_hypos, state_idx);
+  }
+
   std::vector<Hypothesis*>::iterator partial_hypo_iter;
   for (partial_hypo_iter = m_partial_hypos.begin();
        partial_hypo_iter != m_partial_hypos.end();
        ++partial_hypo_iter) {
     Hypothesis* hypo = *partial_hypo_iter;
 
-    // Evaluate with other ffs.
-    std::map<int, StatefulFeatureFunction*>::iterator sfff_iter;
-    for (sfff_iter = m_stateful_ffs.begin();
-         sfff_iter != m_stateful_ffs.end();
-         ++sfff_iter) {
-      const StatefulFeatureFunction &ff = *(sfff_iter->second);
-      int state_idx = sfff_iter->first;
-      hypo->EvaluateWhenApplied(ff, state_idx);
-    }
     std::vector<const StatelessFeatureFunction*>::iterator slff_iter;
     for (slff_iter = m_stateless_ffs.begin();
          slff_iter != m_stateless_ffs.end();
@@ -168,6 +175,9 @@ void SearchNormalBatch::EvalAndMergePartialHypos()
       hypo->EvaluateWhenApplied(**slff_iter);
     }
   }
+  IFVERBOSE(2) {
+    stats.StopTimeOtherScore();
+  }
 
   // Wait for all requests from the distributed LM to come back.
   std::map<int, LanguageModel*>::iterator dlm_iter;
@@ -192,6 +202,7 @@ void SearchNormalBatch::EvalAndMergePartialHypos()
       LanguageModel &lm = *(dlm_iter->second);
       hypo->EvaluateWhenApplied(lm, (*dlm_iter).first);
     }
+    hypo->EvaluateTotalScore(m_transOptColl.GetFutureScore());
 
     // Put completed hypothesis onto its stack.
     size_t wordsTranslated = hypo->GetWordsBitmap().GetNumWordsCovered();
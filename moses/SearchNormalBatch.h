@@ -12,8 +12,11 @@ class InputType;
 class TranslationOptionCollection;
 
 /** Implements the phrase-based stack decoding algorithm (no cube pruning) with a twist...
- *  Language model requests are batched together, duplicate requests are removed, and requests are sent together.
- *  Useful for distributed LM where network latency is an issue.
+ *  New hypotheses are built without scoring and collected, up to the end of each
+ *  stack. Each stateful feature function then evaluates the whole batch through
+ *  StatefulFeatureFunction::EvaluateWhenAppliedBatch(), which lets it prefetch,
+ *  vectorise or group remote requests (eg. KenLM prefetches its hash tables).
+ *  Distributed LMs can also use the older IssueRequestsFor()/sync() hooks.
  */
 class SearchNormalBatch: public SearchNormal
 {
@@ -28,7 +31,7 @@ protected:
   int m_max_stack_size;
 
   // functions for creating hypotheses
-  void ExpandHypothesis(const Hypothesis &hypothesis,const TranslationOption &transOpt, float expectedScore);
+  void ExpandHypothesis(const Hypothesis &hypothesis,const TranslationOption &transOpt, float expectedScore, float futureScore);
   void EvalAndMergePartialHypos();
 
 public:
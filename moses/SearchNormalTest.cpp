@@ -0,0 +1,107 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2015 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#define BOOST_TEST_MODULE SearchNormalTest
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#include "moses/Manager.h"
+#include "moses/MockThreadLocalFeature.h"
+#include "moses/Parameter.h"
+#include "moses/Sentence.h"
+#include "moses/StaticData.h"
+
+using namespace Moses;
+using namespace MosesTest;
+using namespace std;
+
+namespace
+{
+
+/** phrase-based decoder with 4 threads per sentence and a tiny phrase table */
+struct ConcurrentDecoder {
+  ConcurrentDecoder() {
+    m_dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directory(m_dir);
+    string table = (m_dir / "phrase-table").string();
+    string config = (m_dir / "moses.ini").string();
+
+    ofstream tableOut(table.c_str());
+    tableOut
+        << "a ||| x ||| 0.5" << endl
+        << "b ||| y ||| 0.5" << endl
+        << "a b ||| x y ||| 0.25" << endl;
+    tableOut.close();
+    ofstream configOut(config.c_str());
+    configOut
+        << "[input-factors]" << endl << "0" << endl
+        << "[mapping]" << endl << "0 T 0" << endl
+        << "[distortion-limit]" << endl << "6" << endl
+        << "[threads-per-sentence]" << endl << "4" << endl
+        << "[verbose]" << endl << "0" << endl
+        << "[feature]" << endl
+        << "UnknownWordPenalty" << endl
+        << "WordPenalty" << endl
+        << "Distortion" << endl
+        << "PhraseDictionaryMemory name=TranslationModel0 num-features=1 path=" << table
+        << " input-factor=0 output-factor=0" << endl
+        << "[weight]" << endl
+        << "UnknownWordPenalty0= 1" << endl
+        << "WordPenalty0= -1" << endl
+        << "Distortion0= 0.3" << endl
+        << "TranslationModel0= 0.2" << endl;
+    configOut.close();
+
+    BOOST_REQUIRE(m_parameter.LoadParam(config));
+    BOOST_REQUIRE(StaticData::LoadDataStatic(&m_parameter, ""));
+    BOOST_REQUIRE(StaticData::Instance().GetSentenceThreadPool());
+  }
+
+  ~ConcurrentDecoder() {
+    boost::filesystem::remove_all(m_dir);
+  }
+
+  void Decode(const string &text) {
+    vector<FactorType> factors(1, 0);
+    Sentence sentence;
+    istringstream in(text + "\n");
+    sentence.Read(in, factors);
+    Manager manager(sentence);
+    manager.Decode();
+  }
+
+  boost::filesystem::path m_dir;
+  Parameter m_parameter;
+};
+
+BOOST_FIXTURE_TEST_CASE(thread_local_input_state, ConcurrentDecoder)
+{
+  // feature functions stay registered for the rest of the process.
+  // Options are collected concurrently, only hypotheses are thread affine
+  static MockThreadLocalFeature feature(true, false);
+  Decode("a b a b a b b a");
+  BOOST_CHECK(feature.GetWhenAppliedCalls() > 0);
+  BOOST_CHECK_EQUAL(0, feature.GetWhenAppliedMissing());
+}
+
+}
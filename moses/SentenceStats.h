@@ -33,6 +33,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "InputType.h"
 #include "Util.h" //Join()
 
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
+
 namespace Moses
 {
 
@@ -142,80 +146,155 @@ public:
   }
 
   void AddRecombination(const Hypothesis& worseHypo, const Hypothesis& betterHypo) {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_recombinationInfos.push_back(RecombinationInfo(worseHypo.GetWordsBitmap().GetNumWordsCovered(),
                                    betterHypo.GetTotalScore(), worseHypo.GetTotalScore()));
   }
   void AddCreated() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_numHyposCreated++;
   }
   void AddPopped() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_numHyposPopped++;
   }
   void AddPruning() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_numHyposPruned++;
   }
   void AddEarlyDiscarded() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_numHyposEarlyDiscarded++;
   }
   void AddNotBuilt() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_numHyposNotBuilt++;
   }
   void AddDiscarded() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_numHyposDiscarded++;
   }
 
   void StartTimeCollectOpts() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeCollectOpts.start();
   }
   void StopTimeCollectOpts() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeCollectOpts.stop();
   }
   void StartTimeBuildHyp() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeBuildHyp.start();
   }
   void StopTimeBuildHyp() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeBuildHyp.stop();
   }
   void StartTimeCalcLM() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeCalcLM.start();
   }
   void StopTimeCalcLM() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeCalcLM.stop();
   }
   void StartTimeOtherScore() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeOtherScore.start();
   }
   void StopTimeOtherScore() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeOtherScore.stop();
   }
   void StartTimeEstimateScore() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeEstimateScore.start();
   }
   void StopTimeEstimateScore() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeEstimateScore.stop();
   }
   void StartTimeSetupCubes() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeSetupCubes.start();
   }
   void StopTimeSetupCubes() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeSetupCubes.stop();
   }
   void StartTimeManageCubes() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeManageCubes.start();
   }
   void StopTimeManageCubes() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeManageCubes.stop();
   }
   void StartTimeStack() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeStack.start();
   }
   void StopTimeStack() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeStack.stop();
   }
   void StartTimeTotal() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeTotal.start();
   }
   void StopTimeTotal() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
     m_timeTotal.stop();
   }
 
@@ -231,6 +310,11 @@ protected:
   // since clock seconds aren't reliable in a multi-threaded environment -Jon
   // (see Manager.cpp for some initial work moving in this direction)
   std::vector<RecombinationInfo> m_recombinationInfos;
+#ifdef WITH_THREADS
+  /** guards counters and timers, which several threads decoding one sentence
+   * may update. Timers then measure the time any thread spent in a section */
+  boost::mutex m_mutex;
+#endif
   unsigned int m_numHyposCreated;
   unsigned int m_numHyposPopped;
   unsigned int m_numHyposPruned;
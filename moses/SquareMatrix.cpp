@@ -34,30 +34,18 @@ namespace Moses
 /**
  * Calculare future score estimate for a given coverage bitmap
  *
+ * Jumps from gap to gap, rather than testing every position.
+ *
  * /param bitmap coverage bitmap
  */
 
 float SquareMatrix::CalcFutureScore( WordsBitmap const &bitmap ) const
 {
-  const size_t notInGap= numeric_limits<size_t>::max();
-  size_t startGap = notInGap;
   float futureScore = 0.0f;
-  for(size_t currPos = 0 ; currPos < bitmap.GetSize() ; currPos++) {
-    // start of a new gap?
-    if(bitmap.GetValue(currPos) == false && startGap == notInGap) {
-      startGap = currPos;
-    }
-    // end of a gap?
-    else if(bitmap.GetValue(currPos) == true && startGap != notInGap) {
-      futureScore += GetScore(startGap, currPos - 1);
-      startGap = notInGap;
-    }
-  }
-  // coverage ending with gap?
-  if (startGap != notInGap) {
-    futureScore += GetScore(startGap, bitmap.GetSize() - 1);
+  size_t startGap, endGap;
+  for (size_t pos = 0; bitmap.GetGapFrom(pos, startGap, endGap); pos = endGap + 1) {
+    futureScore += GetScore(startGap, endGap);
   }
-
   return futureScore;
 }
 
@@ -67,9 +55,8 @@ float SquareMatrix::CalcFutureScore( WordsBitmap const &bitmap ) const
  * to compute future score estimates for hypotheses that we may want
  * build, but first want to check.
  *
- * Note: this function is implemented a bit more complex than
- * the basic one (w/o additional phrase) for speed reasons,
- * which is probably overkill.
+ * Gaps are summed in the same order as CalcFutureScore(bitmap) would for
+ * the bitmap with the span covered, so the two give exactly the same score.
  *
  * /param bitmap coverage bitmap
  * /param startPos start of the span that is added to the coverage
@@ -78,42 +65,37 @@ float SquareMatrix::CalcFutureScore( WordsBitmap const &bitmap ) const
 
 float SquareMatrix::CalcFutureScore( WordsBitmap const &bitmap, size_t startPos, size_t endPos ) const
 {
-  const size_t notInGap= numeric_limits<size_t>::max();
   float futureScore = 0.0f;
-  size_t startGap = bitmap.GetFirstGapPos();
-  if (startGap == NOT_FOUND) return futureScore; // everything filled
-
-  // start loop at first gap
-  size_t startLoop = startGap+1;
-  if (startPos == startGap) { // unless covered by phrase
-    startGap = notInGap;
-    startLoop = endPos+1; // -> postpone start
-  }
-
-  size_t lastCovered = bitmap.GetLastPos();
-  if (endPos > lastCovered || lastCovered == NOT_FOUND) lastCovered = endPos;
-
-  for(size_t currPos = startLoop; currPos <= lastCovered ; currPos++) {
-    // start of a new gap?
-    if(startGap == notInGap && bitmap.GetValue(currPos) == false && (currPos < startPos || currPos > endPos)) {
-      startGap = currPos;
+  size_t startGap, endGap;
+  for (size_t pos = 0; bitmap.GetGapFrom(pos, startGap, endGap); pos = endGap + 1) {
+    if (endGap < startPos || startGap > endPos) {
+      futureScore += GetScore(startGap, endGap);
+    } else {
+      // the span splits this gap
+      if (startGap < startPos) {
+        futureScore += GetScore(startGap, startPos - 1);
+      }
+      if (endGap > endPos) {
+        futureScore += GetScore(endPos + 1, endGap);
+      }
     }
-    // end of a gap?
-    else if(startGap != notInGap && (bitmap.GetValue(currPos) == true || (startPos <= currPos && currPos <= endPos))) {
-      futureScore += GetScore(startGap, currPos - 1);
-      startGap = notInGap;
-    }
-  }
-  // coverage ending with gap?
-  if (lastCovered != bitmap.GetSize() - 1) {
-    futureScore += GetScore(lastCovered+1, bitmap.GetSize() - 1);
   }
-
   return futureScore;
 }
 
 TO_STRING_BODY(SquareMatrix);
 
+float FutureScoreCache::Get(const WordsBitmap &bitmap)
+{
+  Scores::const_iterator found = m_scores.find(bitmap);
+  if (found != m_scores.end()) {
+    return found->second;
+  }
+  const float futureScore = m_futureScore.CalcFutureScore(bitmap);
+  m_scores.insert(Scores::value_type(bitmap, futureScore));
+  return futureScore;
+}
+
 }
 
 
@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define moses_SquareMatrix_h
 
 #include <iostream>
+#include <boost/unordered_map.hpp>
 #include "TypeDef.h"
 #include "Util.h"
 #include "WordsBitmap.h"
@@ -67,6 +68,48 @@ public:
   TO_STRING();
 };
 
+/** Future scores of the coverages seen while decoding one sentence.
+ * Different hypotheses often reach the same coverage, e.g. by translating
+ * the same words in another order, so each coverage is only scored once.
+ * Not thread safe; one per search (or per thread)
+ */
+class FutureScoreCache
+{
+protected:
+  struct BitmapHash {
+    size_t operator()(const WordsBitmap &bitmap) const {
+      return bitmap.hash();
+    }
+  };
+  struct BitmapEqual {
+    bool operator()(const WordsBitmap &a, const WordsBitmap &b) const {
+      return a.Compare(b) == 0;
+    }
+  };
+  typedef boost::unordered_map<WordsBitmap, float, BitmapHash, BitmapEqual> Scores;
+
+  const SquareMatrix &m_futureScore;
+  Scores m_scores;
+
+public:
+  FutureScoreCache(const SquareMatrix &futureScore)
+    :m_futureScore(futureScore) {
+  }
+
+  //! same as SquareMatrix::CalcFutureScore(bitmap)
+  float Get(const WordsBitmap &bitmap);
+  //! future score of bitmap with [startPos, endPos] covered as well
+  float Get(const WordsBitmap &bitmap, size_t startPos, size_t endPos) {
+    WordsBitmap covered(bitmap);
+    covered.SetValue(startPos, endPos, true);
+    return Get(covered);
+  }
+
+  void Clear() {
+    m_scores.clear();
+  }
+};
+
 inline std::ostream& operator<<(std::ostream &out, const SquareMatrix &matrix)
 {
   for (size_t endPos = 0 ; endPos < matrix.GetSize() ; endPos++) {
@@ -0,0 +1,73 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2015 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include "SquareMatrix.h"
+
+using namespace Moses;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(square_matrix)
+
+namespace
+{
+
+// a different score for every span
+void Fill(SquareMatrix &matrix)
+{
+  for (size_t startPos = 0; startPos < matrix.GetSize(); ++startPos) {
+    for (size_t endPos = startPos; endPos < matrix.GetSize(); ++endPos) {
+      matrix.SetScore(startPos, endPos, -1.0f - 0.1f * startPos - 0.37f * (endPos - startPos));
+    }
+  }
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(future_score_cache)
+{
+  SquareMatrix matrix(8);
+  Fill(matrix);
+  FutureScoreCache cache(matrix);
+
+  WordsBitmap empty(8);
+  BOOST_CHECK_EQUAL(cache.Get(empty), matrix.CalcFutureScore(empty));
+
+  // 1-2 then 5 and 5 then 1-2 reach the same coverage
+  WordsBitmap first(8), second(8);
+  first.SetValue(1, 2, true);
+  second.SetValue(5, true);
+  const float score = cache.Get(first, 5, 5);
+  BOOST_CHECK_EQUAL(score, matrix.CalcFutureScore(first, 5, 5));
+  BOOST_CHECK_EQUAL(score, cache.Get(second, 1, 2));
+
+  // once cached, a query doesn't look at the matrix any more
+  matrix.SetScore(0, 0, 0.0f);
+  BOOST_CHECK_EQUAL(score, cache.Get(second, 1, 2));
+  cache.Clear();
+  BOOST_CHECK_EQUAL(matrix.CalcFutureScore(first, 5, 5), cache.Get(second, 1, 2));
+  BOOST_CHECK(score != cache.Get(second, 1, 2));
+
+  WordsBitmap full(8);
+  full.SetValue(0, 7, true);
+  BOOST_CHECK_EQUAL(0.0f, cache.Get(full));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
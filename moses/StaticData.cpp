@@ -37,6 +37,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Util.h"
 #include "FactorCollection.h"
 #include "Timer.h"
+#include "ThreadPool.h"
 #include "TranslationOption.h"
 #include "DecodeGraph.h"
 #include "InputFileStream.h"
@@ -443,6 +444,19 @@ bool StaticData::LoadData(Parameter *parameter)
     }
   }
 
+  m_parameter->SetParameter(m_threadsLongestFirst, "threads-longest-first", false);
+
+  m_parameter->SetParameter<size_t>(m_threadsPerSentence, "threads-per-sentence", 1);
+  if (m_threadsPerSentence > 1) {
+#ifdef WITH_THREADS
+    // the thread decoding the sentence works too
+    m_sentenceThreadPool.reset(new ThreadPool(m_threadsPerSentence - 1));
+#else
+    std::cerr << "Error: -threads-per-sentence " << m_threadsPerSentence << " but moses not built with thread support";
+    return false;
+#endif
+  }
+
   m_parameter->SetParameter<long>(m_startTranslationId, "start-translation-id", 0);
 
   // use of xml in input
@@ -530,6 +544,10 @@ bool StaticData::LoadData(Parameter *parameter)
       return false;
     }
   }
+
+  // models are loaded, so the vocabulary known so far can be looked up
+  // without locking while decoding
+  FactorCollection::Instance().Freeze();
   return true;
 }
 
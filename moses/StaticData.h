@@ -35,6 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifdef WITH_THREADS
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/shared_ptr.hpp>
 #endif
 
 #include "Parameter.h"
@@ -49,6 +50,9 @@ namespace Moses
 class InputType;
 class DecodeGraph;
 class DecodeStep;
+#ifdef WITH_THREADS
+class ThreadPool;
+#endif
 
 class DynamicCacheBasedLanguageModel;
 class PhraseDictionaryDynamicCacheBased;
@@ -196,6 +200,11 @@ protected:
   WordAlignmentSort m_wordAlignmentSort;
 
   int m_threadCount;
+  bool m_threadsLongestFirst;
+  size_t m_threadsPerSentence;
+#ifdef WITH_THREADS
+  boost::shared_ptr<ThreadPool> m_sentenceThreadPool; /**< extra threads for work on one sentence */
+#endif
   long m_startTranslationId;
 
   // alternate weight settings
@@ -623,6 +632,19 @@ public:
   int ThreadCount() const {
     return m_threadCount;
   }
+  bool ThreadsLongestFirst() const {
+    return m_threadsLongestFirst;
+  }
+  size_t GetThreadsPerSentence() const {
+    return m_threadsPerSentence;
+  }
+#ifdef WITH_THREADS
+  /** threads that help decoding a single sentence, shared by all sentences.
+   * NULL unless -threads-per-sentence is more than 1 */
+  ThreadPool *GetSentenceThreadPool() const {
+    return m_sentenceThreadPool.get();
+  }
+#endif
 
   long GetStartTranslationId() const {
     return m_startTranslationId;
@@ -1,11 +1,12 @@
 #pragma once
 
-#include <queue>
 #include <vector>
 #include <utility>
 
 #include <boost/unordered_set.hpp>
 
+#include "moses/DaryHeap.h"
+
 #include "SHyperedge.h"
 #include "SHyperedgeBundle.h"
 
@@ -46,8 +47,7 @@ private:
     }
   };
 
-  typedef std::priority_queue<QueueItem, std::vector<QueueItem>,
-          QueueItemOrderer> Queue;
+  typedef DaryHeap<QueueItem, QueueItemOrderer> Queue;
 
   SHyperedge *CreateHyperedge(const std::vector<int> &);
   void CreateNeighbour(const std::vector<int> &);
@@ -16,17 +16,18 @@ CubeQueue::~CubeQueue()
 
 SHyperedge *CubeQueue::Pop()
 {
-  // pop the most promising cube
+  // take the most promising cube.  It stays at the top of the queue until
+  // its new score is known.
   Cube *cube = m_queue.top();
-  m_queue.pop();
 
   // pop the most promising hyperedge from the cube
   SHyperedge *hyperedge = cube->Pop();
 
-  // if the cube contains more items then push it back onto the queue
+  // if the cube contains more items then put it back in place on the queue
   if (!cube->IsEmpty()) {
-    m_queue.push(cube);
+    m_queue.ReplaceTop(cube);
   } else {
+    m_queue.pop();
     delete cube;
   }
 
@@ -1,8 +1,9 @@
 #pragma once
 
-#include <queue>
 #include <vector>
 
+#include "moses/DaryHeap.h"
+
 #include "Cube.h"
 #include "SHyperedge.h"
 #include "SHyperedgeBundle.h"
@@ -35,7 +36,7 @@ private:
     }
   };
 
-  typedef std::priority_queue<Cube*, std::vector<Cube*>, CubeOrderer> Queue;
+  typedef DaryHeap<Cube*, CubeOrderer> Queue;
 
   Queue m_queue;
 };
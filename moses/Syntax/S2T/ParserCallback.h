@@ -1,6 +1,6 @@
 #pragma once
 
-#include "moses/Syntax/BoundedPriorityContainer.h"
+#include "moses/BoundedPriorityContainer.h"
 #include "moses/Syntax/PHyperedge.h"
 #include "moses/Syntax/PVertex.h"
 #include "moses/Syntax/SHyperedgeBundle.h"
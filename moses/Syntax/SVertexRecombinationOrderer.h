@@ -1,5 +1,7 @@
 #pragma once
 
+#include <boost/functional/hash.hpp>
+
 #include "moses/FF/FFState.h"
 
 #include "SVertex.h"
@@ -31,5 +33,33 @@ public:
   }
 };
 
+// Hash and equality for recombining SVertex objects in a RecombinationTable.
+struct SVertexRecombinationHasher {
+public:
+  std::size_t operator()(const SVertex *v) const {
+    std::size_t seed = 0;
+    for (std::size_t i = 0; i < v->state.size(); ++i) {
+      boost::hash_combine(seed, v->state[i] ? v->state[i]->hash() : 0);
+    }
+    return seed;
+  }
+};
+
+struct SVertexRecombinationEqual {
+public:
+  bool operator()(const SVertex *x, const SVertex *y) const {
+    for (std::size_t i = 0; i < x->state.size(); ++i) {
+      if (x->state[i] == NULL || y->state[i] == NULL) {
+        if (x->state[i] != y->state[i]) {
+          return false;
+        }
+      } else if (x->state[i]->Compare(*y->state[i]) != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
 }  // Syntax
 }  // Moses
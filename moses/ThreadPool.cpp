@@ -20,6 +20,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ***********************************************************************/
 
 
+#include <algorithm>
+#include <limits>
+#include <boost/shared_ptr.hpp>
 #include "ThreadPool.h"
 
 #ifdef WITH_THREADS
@@ -30,41 +33,195 @@ using namespace Moses;
 namespace Moses
 {
 
+namespace
+{
+
+//! tasks given to ThreadPool::RunAndWait, shared between the threads running them
+struct TaskBatch {
+  std::vector<Task*> tasks;
+  size_t next; /**< first task not yet claimed. Guarded by mutex */
+  size_t finished; /**< Guarded by mutex */
+  boost::mutex mutex;
+  boost::condition_variable allFinished;
+
+  explicit TaskBatch(const std::vector<Task*> &batch)
+    : tasks(batch), next(0), finished(0) {}
+
+  //! run unclaimed tasks until there are none left
+  void Work() {
+    while (true) {
+      Task *task;
+      {
+        boost::mutex::scoped_lock lock(mutex);
+        if (next == tasks.size()) {
+          return;
+        }
+        task = tasks[next++];
+      }
+      task->Run();
+      boost::mutex::scoped_lock lock(mutex);
+      if (++finished == tasks.size()) {
+        allFinished.notify_all();
+      }
+    }
+  }
+};
+
+/** queued by RunAndWait. May only start after the batch has finished, so it
+ * shares ownership of the batch */
+class TaskBatchHelper : public Task
+{
+public:
+  explicit TaskBatchHelper(const boost::shared_ptr<TaskBatch> &batch)
+    : m_batch(batch) {}
+
+  virtual void Run() {
+    m_batch->Work();
+  }
+
+  //! the caller is waiting, so with longest-first scheduling run before anything queued
+  virtual size_t GetCost() const {
+    return std::numeric_limits<size_t>::max();
+  }
+
+private:
+  boost::shared_ptr<TaskBatch> m_batch;
+};
+
+}
+
 ThreadPool::ThreadPool( size_t numThreads )
-  : m_stopped(false), m_stopping(false), m_queueLimit(0)
+  : m_queued(0), m_submitted(0), m_sleeping(0), m_stopped(false), m_stopping(false), m_queueLimit(0), m_longestFirst(false)
 {
+  // at least one queue, so that Submit works even without threads
+  for (size_t i = 0; i < std::max<size_t>(numThreads, 1); ++i) {
+    m_queues.push_back(new WorkQueue());
+  }
   for (size_t i = 0; i < numThreads; ++i) {
-    m_threads.create_thread(boost::bind(&ThreadPool::Execute,this));
+    m_threads.create_thread(boost::bind(&ThreadPool::Execute,this,i));
   }
 }
 
-void ThreadPool::Execute()
+ThreadPool::~ThreadPool()
 {
-  do {
-    Task* task = NULL;
-    {
-      // Find a job to perform
+  Stop();
+  for (size_t i = 0; i < m_queues.size(); ++i) {
+    delete m_queues[i];
+  }
+}
+
+Task *ThreadPool::Take(size_t id)
+{
+  if (m_longestFirst) {
+    boost::mutex::scoped_lock lock(m_heapMutex);
+    if (!m_heap.empty()) {
+      std::pop_heap(m_heap.begin(), m_heap.end());
+      Task *task = m_heap.back().task;
+      m_heap.pop_back();
+      return task;
+    }
+  }
+  // our own deque first, then steal
+  for (size_t i = 0; i < m_queues.size(); ++i) {
+    Task *task = Take(*m_queues[(id + i) % m_queues.size()], i != 0);
+    if (task) {
+      return task;
+    }
+  }
+  return NULL;
+}
+
+Task *ThreadPool::Take(WorkQueue &queue, bool fromBack)
+{
+  boost::mutex::scoped_lock lock(queue.mutex);
+  if (queue.tasks.empty()) {
+    return NULL;
+  }
+  Task *task;
+  if (fromBack) {
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+  } else {
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+  }
+  return task;
+}
+
+bool ThreadPool::Empty()
+{
+  {
+    boost::mutex::scoped_lock lock(m_heapMutex);
+    if (!m_heap.empty()) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < m_queues.size(); ++i) {
+    boost::mutex::scoped_lock lock(m_queues[i]->mutex);
+    if (!m_queues[i]->tasks.empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ThreadPool::Clear()
+{
+  std::vector<Task*> dropped;
+  {
+    boost::mutex::scoped_lock lock(m_heapMutex);
+    for (size_t i = 0; i < m_heap.size(); ++i) {
+      dropped.push_back(m_heap[i].task);
+    }
+    m_heap.clear();
+  }
+  for (size_t i = 0; i < m_queues.size(); ++i) {
+    boost::mutex::scoped_lock lock(m_queues[i]->mutex);
+    dropped.insert(dropped.end(), m_queues[i]->tasks.begin(), m_queues[i]->tasks.end());
+    m_queues[i]->tasks.clear();
+  }
+  for (size_t i = 0; i < dropped.size(); ++i) {
+    if (dropped[i]->DeleteAfterExecution()) {
+      delete dropped[i];
+    }
+  }
+}
+
+void ThreadPool::Execute(size_t id)
+{
+  while (true) {
+    Task *task = Take(id);
+    if (task == NULL) {
+      // out of work. Submit queues tasks while holding m_mutex, so looking
+      // again under it means a new task either shows up here or wakes us
       boost::mutex::scoped_lock lock(m_mutex);
-      if (m_tasks.empty() && !m_stopped) {
+      ++m_sleeping;
+      while (!m_stopped && (task = Take(id)) == NULL) {
+        // Stop may be waiting for the queues to drain
+        m_threadAvailable.notify_all();
         m_threadNeeded.wait(lock);
       }
-      if (!m_stopped && !m_tasks.empty()) {
-        task = m_tasks.front();
-        m_tasks.pop();
+      --m_sleeping;
+      if (task == NULL) {
+        break;
       }
     }
+
+    if (m_queueLimit > 0) {
+      boost::mutex::scoped_lock lock(m_mutex);
+      --m_queued;
+      m_threadAvailable.notify_all();
+    }
+
     //Execute job
-    if (task) {
-      // must read from task before run. otherwise task may be deleted by main thread
-      // race condition
-      bool del = task->DeleteAfterExecution();
-      task->Run();
-      if (del) {
-        delete task;
-      }
+    // must read from task before run. otherwise task may be deleted by main thread
+    // race condition
+    bool del = task->DeleteAfterExecution();
+    task->Run();
+    if (del) {
+      delete task;
     }
-    m_threadAvailable.notify_all();
-  } while (!m_stopped);
+  }
 }
 
 void ThreadPool::Submit( Task* task )
@@ -73,11 +230,51 @@ void ThreadPool::Submit( Task* task )
   if (m_stopping) {
     throw runtime_error("ThreadPool stopping - unable to accept new jobs");
   }
-  while (m_queueLimit > 0 && m_tasks.size() >= m_queueLimit) {
-    m_threadAvailable.wait(lock);
+  if (m_queueLimit > 0) {
+    while (m_queued >= m_queueLimit) {
+      m_threadAvailable.wait(lock);
+    }
+    ++m_queued;
+  }
+
+  if (m_longestFirst) {
+    CostlyTask entry;
+    entry.cost = task->GetCost();
+    entry.order = m_submitted;
+    entry.task = task;
+    boost::mutex::scoped_lock heapLock(m_heapMutex);
+    m_heap.push_back(entry);
+    std::push_heap(m_heap.begin(), m_heap.end());
+  } else {
+    WorkQueue &queue = *m_queues[m_submitted % m_queues.size()];
+    boost::mutex::scoped_lock queueLock(queue.mutex);
+    queue.tasks.push_back(task);
+  }
+  ++m_submitted;
+
+  if (m_sleeping > 0) {
+    m_threadNeeded.notify_one();
+  }
+}
+
+void ThreadPool::RunAndWait(const std::vector<Task*> &tasks)
+{
+  if (tasks.empty()) {
+    return;
+  }
+  boost::shared_ptr<TaskBatch> batch(new TaskBatch(tasks));
+
+  // the calling thread takes one task itself
+  const size_t helpers = std::min(tasks.size() - 1, m_threads.size());
+  for (size_t i = 0; i < helpers; ++i) {
+    Submit(new TaskBatchHelper(batch));
+  }
+  batch->Work();
+
+  boost::mutex::scoped_lock lock(batch->mutex);
+  while (batch->finished < batch->tasks.size()) {
+    batch->allFinished.wait(lock);
   }
-  m_tasks.push(task);
-  m_threadNeeded.notify_all();
 }
 
 void ThreadPool::Stop(bool processRemainingJobs)
@@ -91,7 +288,7 @@ void ThreadPool::Stop(bool processRemainingJobs)
   if (processRemainingJobs) {
     boost::mutex::scoped_lock lock(m_mutex);
     //wait for queue to drain.
-    while (!m_tasks.empty() && !m_stopped) {
+    while (!Empty() && !m_stopped) {
       m_threadAvailable.wait(lock);
     }
   }
@@ -100,6 +297,8 @@ void ThreadPool::Stop(bool processRemainingJobs)
     boost::mutex::scoped_lock lock(m_mutex);
     m_stopped = true;
   }
+  // workers stop once they find no more tasks
+  Clear();
   m_threadNeeded.notify_all();
 
   m_threads.join_all();
@@ -22,8 +22,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef moses_ThreadPool_h
 #define moses_ThreadPool_h
 
+#include <deque>
 #include <iostream>
-#include <queue>
 #include <vector>
 
 #ifdef WITH_THREADS
@@ -54,11 +54,23 @@ public:
   virtual bool DeleteAfterExecution() {
     return true;
   }
+  /** relative cost estimate, eg. the input length. With longest-first
+   * scheduling, queued tasks with higher cost run first */
+  virtual size_t GetCost() const {
+    return 0;
+  }
   virtual ~Task() {}
 };
 
 #ifdef WITH_THREADS
 
+/** Work-stealing thread pool. Each worker has its own task deque.
+ * Submitted tasks are spread over the deques round-robin; a worker takes
+ * tasks from its own deque and steals from the others when that is empty,
+ * locking only the deque it looks at. The shared mutex is taken once per
+ * Submit, and by workers only when they run out of work and go to sleep.
+ * With longest-first scheduling, all workers share one heap instead.
+ */
 class ThreadPool
 {
 public:
@@ -67,15 +79,20 @@ public:
    **/
   explicit ThreadPool(size_t numThreads);
 
-  ~ThreadPool() {
-    Stop();
-  }
+  ~ThreadPool();
 
   /**
    * Add a job to the threadpool.
    **/
   void Submit(Task* task);
 
+  /**
+   * Run a batch of tasks, which stay owned by the caller, and return once
+   * they have all finished. The calling thread runs tasks too, so this
+   * can't deadlock even if all workers are busy.
+   **/
+  void RunAndWait(const std::vector<Task*> &tasks);
+
   /**
    * Wait until all queued jobs have completed, and shut down
    * the ThreadPool.
@@ -83,26 +100,74 @@ public:
   void Stop(bool processRemainingJobs = false);
 
   /**
-   * Set maximum number of queued threads (otherwise Submit blocks)
+   * Set maximum number of queued threads (otherwise Submit blocks).
+   * Call before submitting tasks.
    **/
   void SetQueueLimit( size_t limit ) {
     m_queueLimit = limit;
   }
 
+  /**
+   * Run the queued task with the highest Task::GetCost() first, rather than
+   * the oldest. Long tasks then don't end up running alone at the end of a batch.
+   * All workers then take tasks from one heap, so this costs some contention.
+   * Call before submitting tasks.
+   **/
+  void SetLongestFirst( bool longestFirst ) {
+    m_longestFirst = longestFirst;
+  }
+
 private:
+  /** a worker's deque of tasks */
+  struct WorkQueue {
+    std::deque<Task*> tasks;
+    boost::mutex mutex;
+  };
+
+  /** entry of the longest-first heap. Equal costs run in submission order */
+  struct CostlyTask {
+    size_t cost;
+    size_t order;
+    Task *task;
+    bool operator<(const CostlyTask &other) const {
+      return cost < other.cost || (cost == other.cost && order > other.order);
+    }
+  };
+
   /**
    * The main loop executed by each thread.
    **/
-  void Execute();
+  void Execute(size_t id);
+
+  /** remove a task from the heap, worker id's own deque or another worker's
+   * deque, in that order. NULL if there are none */
+  Task *Take(size_t id);
+
+  /** remove a task from queue, or return NULL if it is empty.
+   * fromBack: take the newest task (when stealing) */
+  Task *Take(WorkQueue &queue, bool fromBack);
+
+  //! whether no tasks are queued. Locks each queue in turn
+  bool Empty();
+
+  //! drop all queued tasks without running them. Deletes those that
+  //! would have been deleted after running
+  void Clear();
 
-  std::queue<Task*> m_tasks;
+  std::vector<WorkQueue*> m_queues;
+  std::vector<CostlyTask> m_heap; /**< longest-first tasks. Guarded by m_heapMutex */
+  boost::mutex m_heapMutex;
   boost::thread_group m_threads;
   boost::mutex m_mutex;
   boost::condition_variable m_threadNeeded;
   boost::condition_variable m_threadAvailable;
+  size_t m_queued; /**< tasks not yet taken, only counted with a queue limit. Guarded by m_mutex */
+  size_t m_submitted; /**< Guarded by m_mutex */
+  size_t m_sleeping; /**< workers waiting for m_threadNeeded. Guarded by m_mutex */
   bool m_stopped;
   bool m_stopping;
   size_t m_queueLimit;
+  bool m_longestFirst;
 };
 
 class TestTask : public Task
@@ -267,4 +267,119 @@ void ChartRuleLookupManagerMemory::GetNonTerminalExtension(
   m_stackScores.pop_back();
 }
 
+// Unlike GetChartRuleCollection(), only looks for rules covering exactly this
+// span, and only reads chart cells strictly inside it. Nothing is stashed for
+// later spans, so spans of equal width can be looked up concurrently.
+void ChartRuleLookupManagerMemory::GetChartRuleCollectionConcurrent(
+  const InputPath &inputPath,
+  size_t /* lastPos */,
+  ChartParserCallback &outColl) const
+{
+  SpanLookup lookup(inputPath.GetWordsRange(), outColl);
+  GetSpanExtension(lookup, &m_ruleTable.GetRootNode(), lookup.range.GetStartPos());
+}
+
+// add the rules of node if they end at the end of the span, otherwise try to extend them
+void ChartRuleLookupManagerMemory::AddAndExtendInSpan(
+  SpanLookup &lookup,
+  const PhraseDictionaryNodeMemory *node,
+  size_t endPos) const
+{
+  if (endPos == lookup.range.GetEndPos()) {
+    const TargetPhraseCollection &tpc = node->GetTargetPhraseCollection();
+    if (!tpc.IsEmpty()) {
+      lookup.outColl.Add(tpc, lookup.stackVec, lookup.range);
+    }
+  } else {
+    GetSpanExtension(lookup, node, endPos + 1);
+  }
+}
+
+// search all terminal and non-terminal extensions of a partial rule that start at pos
+// and end inside the span
+void ChartRuleLookupManagerMemory::GetSpanExtension(
+  SpanLookup &lookup,
+  const PhraseDictionaryNodeMemory *node,
+  size_t pos) const
+{
+  const PhraseDictionaryNodeMemory::TerminalMap &terminals = node->GetTerminalMap();
+  if (!terminals.empty()) {
+    const Word &sourceWord = GetSourceAt(pos).GetLabel();
+    // as in GetTerminalExtension(), compare small maps linearly
+    if (terminals.size() < 5) {
+      for (PhraseDictionaryNodeMemory::TerminalMap::const_iterator iter = terminals.begin(); iter != terminals.end(); ++iter) {
+        if (TerminalEqualityPred()(iter->first, sourceWord)) {
+          AddAndExtendInSpan(lookup, &iter->second, pos);
+          break;
+        }
+      }
+    } else {
+      const PhraseDictionaryNodeMemory *child = node->GetChild(sourceWord);
+      if (child != NULL) {
+        AddAndExtendInSpan(lookup, child, pos);
+      }
+    }
+  }
+
+  const PhraseDictionaryNodeMemory::NonTerminalMap &nonTermMap = node->GetNonTerminalMap();
+  if (nonTermMap.empty()) {
+    return;
+  }
+
+  const size_t startPos = lookup.range.GetStartPos();
+  const size_t endPos = lookup.range.GetEndPos();
+
+  // make room for back pointer
+  lookup.stackVec.push_back(NULL);
+
+  for (size_t ntEndPos = pos; ntEndPos <= endPos; ++ntEndPos) {
+    // a non-terminal covering the whole span would be a unary rule
+    if (pos == startPos && ntEndPos == endPos) {
+      break;
+    }
+
+    const ChartCellLabelSet &targetNonTerms = GetTargetLabelSet(pos, ntEndPos);
+    if (targetNonTerms.GetSize() == 0) {
+      continue;
+    }
+
+#if !defined(UNLABELLED_SOURCE)
+    if (GetParser().GetInputPath(pos, ntEndPos).GetNonTerminalSet().size() == 0) {
+      continue;
+    }
+#endif
+
+    PhraseDictionaryNodeMemory::NonTerminalMap::const_iterator p;
+    for (p = nonTermMap.begin(); p != nonTermMap.end(); ++p) {
+#if defined(UNLABELLED_SOURCE)
+      const Word &targetNonTerm = p->first;
+#else
+      const Word &targetNonTerm = p->first.second;
+#endif
+      const PhraseDictionaryNodeMemory *child = &p->second;
+
+      //soft matching of NTs
+      if (m_isSoftMatching && !m_softMatchingMap[targetNonTerm[0]->GetId()].empty()) {
+        const std::vector<Word>& softMatches = m_softMatchingMap[targetNonTerm[0]->GetId()];
+        for (std::vector<Word>::const_iterator softMatch = softMatches.begin(); softMatch != softMatches.end(); ++softMatch) {
+          const ChartCellLabel *cellLabel = targetNonTerms.Find((*softMatch)[0]->GetId());
+          if (cellLabel != NULL) {
+            lookup.stackVec.back() = cellLabel;
+            AddAndExtendInSpan(lookup, child, ntEndPos);
+          }
+        }
+      }
+
+      const ChartCellLabel *cellLabel = targetNonTerms.Find(targetNonTerm[0]->GetId());
+      if (cellLabel != NULL) {
+        lookup.stackVec.back() = cellLabel;
+        AddAndExtendInSpan(lookup, child, ntEndPos);
+      }
+    }
+  }
+
+  // remove last back pointer
+  lookup.stackVec.pop_back();
+}
+
 }  // namespace Moses
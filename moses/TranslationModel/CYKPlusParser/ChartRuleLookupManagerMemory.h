@@ -55,7 +55,37 @@ public:
     size_t lastPos, // last position to consider if using lookahead
     ChartParserCallback &outColl);
 
+  virtual bool SupportsConcurrentLookup() const {
+    return true;
+  }
+
+  virtual void GetChartRuleCollectionConcurrent(
+    const InputPath &inputPath,
+    size_t lastPos,
+    ChartParserCallback &outColl) const;
+
 private:
+  //! state of one call to GetChartRuleCollectionConcurrent()
+  struct SpanLookup {
+    SpanLookup(const WordsRange &range, ChartParserCallback &outColl)
+      : range(range)
+      , outColl(outColl) {}
+
+    const WordsRange &range;
+    ChartParserCallback &outColl;
+    StackVec stackVec;
+  };
+
+  void GetSpanExtension(
+    SpanLookup &lookup,
+    const PhraseDictionaryNodeMemory *node,
+    size_t pos) const;
+
+  void AddAndExtendInSpan(
+    SpanLookup &lookup,
+    const PhraseDictionaryNodeMemory *node,
+    size_t endPos) const;
+
 
   void GetTerminalExtension(
     const PhraseDictionaryNodeMemory *node,
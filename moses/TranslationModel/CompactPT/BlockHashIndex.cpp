@@ -21,6 +21,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "ThrowingFwrite.h"
 #include "BlockHashIndex.h"
+#include "util/file.hh"
 #include "CmphStringVectorAdapter.h"
 #include "util/exception.hh"
 
@@ -71,12 +72,16 @@ BlockHashIndex::~BlockHashIndex()
 #endif
 }
 
+size_t BlockHashIndex::GetRange(const std::string &key) const
+{
+  return std::distance(m_landmarks.begin(),
+                       std::upper_bound(m_landmarks.begin(),
+                                        m_landmarks.end(), key)) - 1;
+}
+
 size_t BlockHashIndex::GetHash(const char* key)
 {
-  std::string keyStr(key);
-  size_t i = std::distance(m_landmarks.begin(),
-                           std::upper_bound(m_landmarks.begin(),
-                               m_landmarks.end(), keyStr)) - 1;
+  size_t i = GetRange(key);
 
   if(i == 0ul-1)
     return GetSize();
@@ -101,6 +106,12 @@ size_t BlockHashIndex::GetHash(size_t i, const char* key)
 #ifdef WITH_THREADS
   boost::mutex::scoped_lock lock(m_mutex);
 #endif
+  return GetHashInLoadedRange(i, key);
+}
+
+// caller holds m_mutex
+size_t BlockHashIndex::GetHashInLoadedRange(size_t i, const char* key)
+{
   if(m_hashes[i] == 0)
     LoadRange(i);
 #ifdef HAVE_CMPH
@@ -119,6 +130,41 @@ size_t BlockHashIndex::GetHash(size_t i, const char* key)
     return GetSize();
 }
 
+void BlockHashIndex::GetHashes(const std::vector<std::string> &keys,
+                               std::vector<size_t> &hashes)
+{
+  hashes.resize(keys.size());
+  std::vector<size_t> ranges(keys.size());
+  for(size_t k = 0; k < keys.size(); k++)
+    ranges[k] = GetRange(keys[k]);
+
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_mutex);
+#endif
+
+  // start reading all missing ranges from disk before loading the first one.
+  // Ranges are only missing if the index was opened with LoadIndex()
+  for(size_t k = 0; k < keys.size(); k++) {
+    size_t i = ranges[k];
+    if(i != 0ul-1 && m_hashes[i] == 0 && i + 1 < m_seekIndex.size())
+      util::AdviseWillNeed(fileno(m_fileHandle), m_fileHandleStart + m_seekIndex[i],
+                           m_seekIndex[i + 1] - m_seekIndex[i]);
+  }
+
+  for(size_t k = 0; k < keys.size(); k++) {
+    size_t i = ranges[k];
+    if(i == 0ul-1) {
+      hashes[k] = GetSize();
+      continue;
+    }
+    size_t pos = GetHashInLoadedRange(i, keys[k].c_str());
+    if(pos != GetSize())
+      hashes[k] = (1ul << m_orderBits) * i + pos;
+    else
+      hashes[k] = GetSize();
+  }
+}
+
 size_t BlockHashIndex::GetHash(std::string key)
 {
   return GetHash(key.c_str());
@@ -96,6 +96,8 @@ private:
 
   size_t GetFprint(const char* key) const;
   size_t GetHash(size_t i, const char* key);
+  size_t GetRange(const std::string &key) const;
+  size_t GetHashInLoadedRange(size_t i, const char* key);
 
 public:
 #ifdef WITH_THREADS
@@ -113,6 +115,10 @@ public:
   size_t operator[](std::string key);
   size_t operator[](char* key);
 
+  /** GetHash() for many keys at once. Ranges that aren't loaded yet are read
+   * ahead together, and the lock is only taken once */
+  void GetHashes(const std::vector<std::string> &keys, std::vector<size_t> &hashes);
+
   void BeginSave(std::FILE* mphf);
   void SaveRange(size_t i);
   void SaveLastRange();
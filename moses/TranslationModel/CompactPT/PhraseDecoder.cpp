@@ -190,7 +190,18 @@ std::string PhraseDecoder::MakeSourceKey(std::string &source)
   return source + m_separator;
 }
 
-TargetPhraseVectorPtr PhraseDecoder::CreateTargetPhraseCollection(const Phrase &sourcePhrase, bool topLevel, bool eval)
+void PhraseDecoder::GetSourcePhraseIds(const std::vector<const Phrase*> &sourcePhrases,
+                                       std::vector<size_t> &sourcePhraseIds)
+{
+  std::vector<std::string> keys(sourcePhrases.size());
+  for(size_t i = 0; i < sourcePhrases.size(); i++) {
+    std::string sourcePhraseString = sourcePhrases[i]->GetStringRep(*m_input);
+    keys[i] = MakeSourceKey(sourcePhraseString);
+  }
+  m_phraseDictionary.m_hash.GetHashes(keys, sourcePhraseIds);
+}
+
+TargetPhraseVectorPtr PhraseDecoder::CreateTargetPhraseCollection(const Phrase &sourcePhrase, bool topLevel, bool eval, const size_t *knownSourcePhraseId)
 {
 
   // Not using TargetPhraseCollection avoiding "new" operator
@@ -217,8 +228,13 @@ TargetPhraseVectorPtr PhraseDecoder::CreateTargetPhraseCollection(const Phrase &
   }
 
   // Retrieve source phrase identifier
-  std::string sourcePhraseString = sourcePhrase.GetStringRep(*m_input);
-  size_t sourcePhraseId = m_phraseDictionary.m_hash[MakeSourceKey(sourcePhraseString)];
+  size_t sourcePhraseId;
+  if(knownSourcePhraseId)
+    sourcePhraseId = *knownSourcePhraseId;
+  else {
+    std::string sourcePhraseString = sourcePhrase.GetStringRep(*m_input);
+    sourcePhraseId = m_phraseDictionary.m_hash[MakeSourceKey(sourcePhraseString)];
+  }
 
   if(sourcePhraseId != m_phraseDictionary.m_hash.GetSize()) {
     // Retrieve compressed and encoded target phrase collection
@@ -444,9 +460,4 @@ TargetPhraseVectorPtr PhraseDecoder::DecodeCollection(
   return tpv;
 }
 
-void PhraseDecoder::PruneCache()
-{
-  m_decodingCache.Prune();
-}
-
 }
@@ -129,8 +129,15 @@ public:
 
   size_t Load(std::FILE* in);
 
+  /** knownSourcePhraseId is the index of sourcePhrase in the phrase table,
+   * if it has been looked up already with GetSourcePhraseIds() */
   TargetPhraseVectorPtr CreateTargetPhraseCollection(const Phrase &sourcePhrase,
-      bool topLevel = false, bool eval = true);
+      bool topLevel = false, bool eval = true, const size_t *knownSourcePhraseId = NULL);
+
+  /** index of each source phrase in the phrase table, or the table size if
+   * it isn't there. All phrases are looked up in one go */
+  void GetSourcePhraseIds(const std::vector<const Phrase*> &sourcePhrases,
+                          std::vector<size_t> &sourcePhraseIds);
 
   TargetPhraseVectorPtr DecodeCollection(TargetPhraseVectorPtr tpv,
                                          BitWrapper<> &encodedBitStream,
@@ -138,7 +145,9 @@ public:
                                          bool topLevel,
                                          bool eval);
 
-  void PruneCache();
+  const TargetPhraseCollectionCache &GetDecodingCache() const {
+    return m_decodingCache;
+  }
 };
 
 }
@@ -113,6 +113,12 @@ void PhraseDictionaryCompact::Load()
 
 const TargetPhraseCollection*
 PhraseDictionaryCompact::GetTargetPhraseCollectionNonCacheLEGACY(const Phrase &sourcePhrase) const
+{
+  return GetTargetPhraseCollectionNonCache(sourcePhrase, NULL);
+}
+
+const TargetPhraseCollection*
+PhraseDictionaryCompact::GetTargetPhraseCollectionNonCache(const Phrase &sourcePhrase, const size_t *sourcePhraseId) const
 {
 
   // There is no souch source phrase if source phrase is longer than longest
@@ -122,7 +128,7 @@ PhraseDictionaryCompact::GetTargetPhraseCollectionNonCacheLEGACY(const Phrase &s
 
   // Retrieve target phrase collection from phrase table
   TargetPhraseVectorPtr decodedPhraseColl
-  = m_phraseDecoder->CreateTargetPhraseCollection(sourcePhrase, true, true);
+  = m_phraseDecoder->CreateTargetPhraseCollection(sourcePhrase, true, true, sourcePhraseId);
 
   if(decodedPhraseColl != NULL && decodedPhraseColl->size()) {
     TargetPhraseVectorPtr tpv(new TargetPhraseVector(*decodedPhraseColl));
@@ -146,6 +152,68 @@ PhraseDictionaryCompact::GetTargetPhraseCollectionNonCacheLEGACY(const Phrase &s
     return NULL;
 }
 
+/** like the default implementation, but the index lookups of all phrases
+ * that aren't cached are done first, and the target phrase collections they
+ * point to are prefetched. With the table on disk, their reads then overlap */
+void PhraseDictionaryCompact::GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
+{
+  std::vector<InputPath*> inputPaths;
+  std::vector<const Phrase*> sourcePhrases;
+  std::vector<size_t> cacheKeys;
+
+  InputPathList::const_iterator iter;
+  for (iter = inputPathQueue.begin(); iter != inputPathQueue.end(); ++iter) {
+    InputPath &inputPath = **iter;
+
+    // backoff
+    if (!SatisfyBackoff(inputPath)) {
+      continue;
+    }
+
+    const Phrase &sourcePhrase = inputPath.GetPhrase();
+    if (sourcePhrase.GetSize() > m_phraseDecoder->GetMaxSourcePhraseLength()) {
+      inputPath.SetTargetPhrases(*this, NULL, NULL);
+      continue;
+    }
+
+    size_t cacheKey = hash_value(sourcePhrase);
+    const TargetPhraseCollection *targetPhrases;
+    if (m_maxCacheSize && m_cache.Find(cacheKey, targetPhrases)) {
+      inputPath.SetTargetPhrases(*this, targetPhrases, NULL);
+      continue;
+    }
+
+    inputPaths.push_back(&inputPath);
+    sourcePhrases.push_back(&sourcePhrase);
+    cacheKeys.push_back(cacheKey);
+  }
+
+  std::vector<size_t> sourcePhraseIds;
+  m_phraseDecoder->GetSourcePhraseIds(sourcePhrases, sourcePhraseIds);
+
+  for (size_t i = 0; i < sourcePhraseIds.size(); ++i) {
+    if (sourcePhraseIds[i] == m_hash.GetSize())
+      continue;
+    if (m_inMemory)
+      m_targetPhrasesMemory.prefetch(sourcePhraseIds[i]);
+    else
+      m_targetPhrasesMapped.prefetch(sourcePhraseIds[i]);
+  }
+
+  for (size_t i = 0; i < inputPaths.size(); ++i) {
+    const TargetPhraseCollection *targetPhrases
+    = GetTargetPhraseCollectionNonCache(*sourcePhrases[i], &sourcePhraseIds[i]);
+    if (m_maxCacheSize) {
+      // same as PhraseDictionary::GetTargetPhraseCollectionLEGACY()
+      if (targetPhrases) {
+        targetPhrases = new TargetPhraseCollection(*targetPhrases);
+      }
+      targetPhrases = m_cache.Insert(cacheKeys[i], targetPhrases);
+    }
+    inputPaths[i]->SetTargetPhrases(*this, targetPhrases, NULL);
+  }
+}
+
 TargetPhraseVectorPtr
 PhraseDictionaryCompact::GetTargetPhraseCollectionRaw(const Phrase &sourcePhrase) const
 {
@@ -186,7 +254,12 @@ void PhraseDictionaryCompact::CleanUpAfterSentenceProcessing(const InputType &so
   if(!m_inMemory)
     m_hash.KeepNLastRanges(0.01, 0.2);
 
-  m_phraseDecoder->PruneCache();
+  IFVERBOSE(3) {
+    const TargetPhraseCollectionCache &cache = m_phraseDecoder->GetDecodingCache();
+    TRACE_ERR("Compact phrase table decoding cache: " << cache.GetSize() << " entries, "
+              << cache.GetHits() << " hits, " << cache.GetMisses() << " misses, "
+              << cache.GetEvictions() << " evictions" << std::endl);
+  }
 
 #ifdef WITH_THREADS
   boost::mutex::scoped_lock lock(m_sentenceMutex);
@@ -75,6 +75,9 @@ public:
   void Load();
 
   const TargetPhraseCollection* GetTargetPhraseCollectionNonCacheLEGACY(const Phrase &source) const;
+  const TargetPhraseCollection* GetTargetPhraseCollectionNonCache(const Phrase &source, const size_t *sourcePhraseId) const;
+
+  void GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const;
   TargetPhraseVectorPtr GetTargetPhraseCollectionRaw(const Phrase &source) const;
 
   void AddEquivPhrase(const Phrase &source, const TargetPhrase &targetPhrase);
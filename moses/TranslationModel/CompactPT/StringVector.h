@@ -35,6 +35,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "MonotonicVector.h"
 #include "MmapAllocator.h"
 
+#include "util/mmap.hh"
+
 namespace Moses
 {
 
@@ -190,6 +192,9 @@ public:
   range operator[](PosT i) const;
   range back() const;
 
+  //! hint that string i will be read soon. Memory-mapped strings are paged in in the background
+  void prefetch(PosT i) const;
+
   template <typename StringT>
   void push_back(StringT s);
   void push_back(const char* c);
@@ -219,6 +224,14 @@ public:
     size_t valSize;
     byteSize += std::fread(&valSize, sizeof(size_t), 1, in) * sizeof(size_t);
 
+    // Large tables are looked up at random, so ask for huge pages before
+    // resize() touches the memory.
+    c.clear();
+    c.reserve(valSize);
+    if (valSize) {
+      c.push_back(0);
+      util::AdviseHugePages(&c[0], valSize * sizeof(ValueT));
+    }
     c.resize(valSize, 0);
     byteSize += std::fread(&c[0], sizeof(ValueT), valSize, in) * sizeof(ValueT);
 
@@ -450,6 +463,17 @@ typename StringVector<ValueT, PosT, Allocator>::range StringVector<ValueT, PosT,
   return at(i);
 }
 
+template<typename ValueT, typename PosT, template <typename> class Allocator>
+void StringVector<ValueT, PosT, Allocator>::prefetch(PosT i) const
+{
+  if(m_memoryMapped)
+    util::AdviseWillNeed(begin(i), length(i) * sizeof(ValueT));
+#ifdef __GNUC__
+  else
+    __builtin_prefetch(begin(i));
+#endif
+}
+
 template<typename ValueT, typename PosT, template <typename> class Allocator>
 typename StringVector<ValueT, PosT, Allocator>::range StringVector<ValueT, PosT, Allocator>::back() const
 {
@@ -22,8 +22,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef moses_TargetPhraseCollectionCache_h
 #define moses_TargetPhraseCollectionCache_h
 
-#include <map>
-#include <set>
+#include <list>
 #include <vector>
 
 #ifdef WITH_THREADS
@@ -33,6 +32,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #endif
 
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "moses/Phrase.h"
 #include "moses/TargetPhraseCollection.h"
@@ -44,125 +44,157 @@ namespace Moses
 typedef std::vector<TargetPhrase> TargetPhraseVector;
 typedef boost::shared_ptr<TargetPhraseVector> TargetPhraseVectorPtr;
 
-/** Implementation of Persistent Cache **/
+/** Implementation of Persistent Cache
+ *
+ * Least-recently-used cache of decoded target phrase vectors, shared by all
+ * threads. Entries are found by the hash of the source phrase and checked
+ * against the stored phrase, so a hash collision is just a miss. The cache
+ * is split into NumShards shards, each with its own mutex and recency list;
+ * the least recently used entry of a shard is dropped as soon as the shard
+ * is full, so there is never a full pass over the cache.
+ **/
 class TargetPhraseCollectionCache
 {
 private:
-  size_t m_max;
-  float m_tolerance;
-
   struct LastUsed {
-    clock_t m_clock;
+    Phrase m_sourcePhrase;
     TargetPhraseVectorPtr m_tpv;
     size_t m_bitsLeft;
 
-    LastUsed() : m_clock(0), m_bitsLeft(0) {}
-
-    LastUsed(clock_t clock, TargetPhraseVectorPtr tpv, size_t bitsLeft = 0)
-      : m_clock(clock), m_tpv(tpv), m_bitsLeft(bitsLeft) {}
+    LastUsed(const Phrase &sourcePhrase, TargetPhraseVectorPtr tpv, size_t bitsLeft)
+      : m_sourcePhrase(sourcePhrase), m_tpv(tpv), m_bitsLeft(bitsLeft) {}
   };
 
-  typedef std::map<Phrase, LastUsed> CacheMap;
-
-  CacheMap m_phraseCache;
+  // most recently used at the front
+  typedef std::list<LastUsed> RecencyList;
+  typedef boost::unordered_map<size_t, RecencyList::iterator> CacheMap;
 
+  struct Shard {
+    RecencyList m_recency;
+    CacheMap m_phraseCache;
+    size_t m_hits, m_misses, m_evictions;
 #ifdef WITH_THREADS
-  boost::mutex m_mutex;
+    boost::mutex m_mutex;
 #endif
+    Shard() : m_hits(0), m_misses(0), m_evictions(0) {}
+  };
 
-public:
-
-  typedef CacheMap::iterator iterator;
-  typedef CacheMap::const_iterator const_iterator;
+  static const size_t NumShards = 16;
 
-  TargetPhraseCollectionCache(size_t max = 5000, float tolerance = 0.2)
-    : m_max(max), m_tolerance(tolerance) {
-  }
+  size_t m_maxPerShard;
+  mutable Shard m_shards[NumShards];
 
-  iterator Begin() {
-    return m_phraseCache.begin();
+  Shard &GetShard(size_t hash) const {
+    // the low bits select the bucket inside the shard's map
+    return m_shards[(hash >> 16) % NumShards];
   }
 
-  const_iterator Begin() const {
-    return m_phraseCache.begin();
-  }
-
-  iterator End() {
-    return m_phraseCache.end();
-  }
+public:
 
-  const_iterator End() const {
-    return m_phraseCache.end();
+  TargetPhraseCollectionCache(size_t max = 5000)
+    : m_maxPerShard((max + NumShards - 1) / NumShards) {
   }
 
-  /** retrieve translations for source phrase from persistent cache **/
+  /** add translations for source phrase to persistent cache **/
   void Cache(const Phrase &sourcePhrase, TargetPhraseVectorPtr tpv,
              size_t bitsLeft = 0, size_t maxRank = 0) {
+    size_t hash = hash_value(sourcePhrase);
+    Shard &shard = GetShard(hash);
+
+    if(maxRank && tpv->size() > maxRank) {
+      TargetPhraseVectorPtr tpv_temp(new TargetPhraseVector());
+      tpv_temp->resize(maxRank);
+      std::copy(tpv->begin(), tpv->begin() + maxRank, tpv_temp->begin());
+      tpv = tpv_temp;
+    }
+
 #ifdef WITH_THREADS
-    boost::mutex::scoped_lock lock(m_mutex);
+    boost::mutex::scoped_lock lock(shard.m_mutex);
 #endif
 
-    // check if source phrase is already in cache
-    iterator it = m_phraseCache.find(sourcePhrase);
-    if(it != m_phraseCache.end())
-      // if found, just update clock
-      it->second.m_clock = clock();
-    else {
-      // else, add to cache
-      if(maxRank && tpv->size() > maxRank) {
-        TargetPhraseVectorPtr tpv_temp(new TargetPhraseVector());
-        tpv_temp->resize(maxRank);
-        std::copy(tpv->begin(), tpv->begin() + maxRank, tpv_temp->begin());
-        m_phraseCache[sourcePhrase] = LastUsed(clock(), tpv_temp, bitsLeft);
-      } else
-        m_phraseCache[sourcePhrase] = LastUsed(clock(), tpv, bitsLeft);
+    CacheMap::iterator it = shard.m_phraseCache.find(hash);
+    if(it != shard.m_phraseCache.end()) {
+      RecencyList::iterator entry = it->second;
+      shard.m_recency.splice(shard.m_recency.begin(), shard.m_recency, entry);
+      // if found, just mark as used
+      if(entry->m_sourcePhrase == sourcePhrase)
+        return;
+      // hash collision, the newer phrase wins
+      *entry = LastUsed(sourcePhrase, tpv, bitsLeft);
+      return;
+    }
+
+    shard.m_recency.push_front(LastUsed(sourcePhrase, tpv, bitsLeft));
+    shard.m_phraseCache[hash] = shard.m_recency.begin();
+
+    if(shard.m_recency.size() > m_maxPerShard) {
+      shard.m_phraseCache.erase(hash_value(shard.m_recency.back().m_sourcePhrase));
+      shard.m_recency.pop_back();
+      ++shard.m_evictions;
     }
   }
 
   std::pair<TargetPhraseVectorPtr, size_t> Retrieve(const Phrase &sourcePhrase) {
+    size_t hash = hash_value(sourcePhrase);
+    Shard &shard = GetShard(hash);
+
 #ifdef WITH_THREADS
-    boost::mutex::scoped_lock lock(m_mutex);
+    boost::mutex::scoped_lock lock(shard.m_mutex);
 #endif
 
-    iterator it = m_phraseCache.find(sourcePhrase);
-    if(it != m_phraseCache.end()) {
-      LastUsed &lu = it->second;
-      lu.m_clock = clock();
+    CacheMap::iterator it = shard.m_phraseCache.find(hash);
+    if(it != shard.m_phraseCache.end() && it->second->m_sourcePhrase == sourcePhrase) {
+      ++shard.m_hits;
+      shard.m_recency.splice(shard.m_recency.begin(), shard.m_recency, it->second);
+      LastUsed &lu = *it->second;
       return std::make_pair(lu.m_tpv, lu.m_bitsLeft);
-    } else
+    } else {
+      ++shard.m_misses;
       return std::make_pair(TargetPhraseVectorPtr(), 0);
+    }
   }
 
-  // if cache full, reduce
-  void Prune() {
+  void CleanUp() {
+    for(size_t i = 0; i < NumShards; ++i) {
 #ifdef WITH_THREADS
-    boost::mutex::scoped_lock lock(m_mutex);
+      boost::mutex::scoped_lock lock(m_shards[i].m_mutex);
 #endif
+      m_shards[i].m_phraseCache.clear();
+      m_shards[i].m_recency.clear();
+    }
+  }
 
-    if(m_phraseCache.size() > m_max * (1 + m_tolerance)) {
-      typedef std::set<std::pair<clock_t, Phrase> > Cands;
-      Cands cands;
-      for(CacheMap::iterator it = m_phraseCache.begin();
-          it != m_phraseCache.end(); it++) {
-        LastUsed &lu = it->second;
-        cands.insert(std::make_pair(lu.m_clock, it->first));
-      }
-
-      for(Cands::iterator it = cands.begin(); it != cands.end(); it++) {
-        const Phrase& p = it->second;
-        m_phraseCache.erase(p);
-
-        if(m_phraseCache.size() < (m_max * (1 - m_tolerance)))
-          break;
-      }
+  // counters for monitoring, summed over all shards
+  size_t GetSize() const {
+    size_t size = 0;
+    for(size_t i = 0; i < NumShards; ++i) {
+#ifdef WITH_THREADS
+      boost::mutex::scoped_lock lock(m_shards[i].m_mutex);
+#endif
+      size += m_shards[i].m_recency.size();
     }
+    return size;
+  }
+  size_t GetHits() const {
+    return Sum(&Shard::m_hits);
+  }
+  size_t GetMisses() const {
+    return Sum(&Shard::m_misses);
+  }
+  size_t GetEvictions() const {
+    return Sum(&Shard::m_evictions);
   }
 
-  void CleanUp() {
+private:
+  size_t Sum(size_t Shard::*counter) const {
+    size_t sum = 0;
+    for(size_t i = 0; i < NumShards; ++i) {
 #ifdef WITH_THREADS
-    boost::mutex::scoped_lock lock(m_mutex);
+      boost::mutex::scoped_lock lock(m_shards[i].m_mutex);
 #endif
-    m_phraseCache.clear();
+      sum += m_shards[i].*counter;
+    }
+    return sum;
   }
 
 };
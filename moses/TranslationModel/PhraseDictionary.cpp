@@ -19,7 +19,6 @@ License along with this library; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ***********************************************************************/
 
-#include <queue>
 #include "moses/TranslationModel/PhraseDictionary.h"
 #include "moses/StaticData.h"
 #include "moses/InputType.h"
@@ -35,19 +34,11 @@ namespace Moses
 {
 std::vector<PhraseDictionary*> PhraseDictionary::s_staticColl;
 
-CacheColl::~CacheColl()
-{
-  for (iterator iter = begin(); iter != end(); ++iter) {
-    std::pair<const TargetPhraseCollection*, clock_t> &key = iter->second;
-    const TargetPhraseCollection *tps = key.first;
-    delete tps;
-  }
-}
-
 PhraseDictionary::PhraseDictionary(const std::string &line)
   :DecodeFeature(line)
   ,m_tableLimit(20) // default
   ,m_maxCacheSize(DEFAULT_MAX_TRANS_OPT_CACHE_SIZE)
+  ,m_cache(DEFAULT_MAX_TRANS_OPT_CACHE_SIZE)
 {
   m_id = s_staticColl.size();
   s_staticColl.push_back(this);
@@ -64,28 +55,14 @@ const TargetPhraseCollection *PhraseDictionary::GetTargetPhraseCollectionLEGACY(
 {
   const TargetPhraseCollection *ret;
   if (m_maxCacheSize) {
-    CacheColl &cache = GetCache();
-
     size_t hash = hash_value(src);
-
-    CacheColl::iterator iter;
-    iter = cache.find(hash);
-
-    if (iter == cache.end()) {
+    if (!m_cache.Find(hash, ret)) {
       // not in cache, need to look up from phrase table
       ret = GetTargetPhraseCollectionNonCacheLEGACY(src);
       if (ret) {
         ret = new TargetPhraseCollection(*ret);
       }
-
-      std::pair<const TargetPhraseCollection*, clock_t> value(ret, clock());
-      cache[hash] = value;
-    } else {
-      // in cache. just use it
-      std::pair<const TargetPhraseCollection*, clock_t> &value = iter->second;
-      value.second = clock();
-
-      ret = value.first;
+      ret = m_cache.Insert(hash, ret);
     }
   } else {
     // don't use cache. look up from phrase table
@@ -116,6 +93,7 @@ SetParameter(const std::string& key, const std::string& value)
 {
   if (key == "cache-size") {
     m_maxCacheSize = Scan<size_t>(value);
+    m_cache.SetMaxSize(m_maxCacheSize);
   } else if (key == "path") {
     m_filePath = value;
   } else if (key == "table-limit") {
@@ -175,73 +153,14 @@ GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
   }
 }
 
-// persistent cache handling
-// saving presistent cache to disk
-//void PhraseDictionary::SaveCache() const
-//{
-//  CacheColl &cache = GetCache();
-//  for( std::map<size_t, std::pair<const TargetPhraseCollection*,clock_t> >::iterator iter,
-//       iter != cache.end(),
-//       iter++ ) {
-//
-//  }
-//}
-
-// loading persistent cache from disk
-//void PhraseDictionary::LoadCache() const
-//{
-//  CacheColl &cache = GetCache();
-//  std::map<size_t, std::pair<const TargetPhraseCollection*,clock_t> >::iterator iter;
-//  iter = cache.begin();
-//  while( iter != cache.end() ) {
-//    std::map<size_t, std::pair<const TargetPhraseCollection*,clock_t> >::iterator iterRemove = iter++;
-//    delete iterRemove->second.first;
-//    cache.erase(iterRemove);
-//  }
-//}
-
-// reduce presistent cache by half of maximum size
 void PhraseDictionary::ReduceCache() const
 {
-  Timer reduceCacheTime;
-  reduceCacheTime.start();
-  CacheColl &cache = GetCache();
-  if (cache.size() <= m_maxCacheSize) return; // not full
-
-  // find cutoff for last used time
-  priority_queue< clock_t > lastUsedTimes;
-  CacheColl::iterator iter;
-  iter = cache.begin();
-  while( iter != cache.end() ) {
-    lastUsedTimes.push( iter->second.second );
-    iter++;
-  }
-  for( size_t i=0; i < lastUsedTimes.size()-m_maxCacheSize/2; i++ )
-    lastUsedTimes.pop();
-  clock_t cutoffLastUsedTime = lastUsedTimes.top();
-
-  // remove all old entries
-  iter = cache.begin();
-  while( iter != cache.end() ) {
-    if (iter->second.second < cutoffLastUsedTime) {
-      CacheColl::iterator iterRemove = iter++;
-      delete iterRemove->second.first;
-      cache.erase(iterRemove);
-    } else iter++;
-  }
-  VERBOSE(2,"Reduced persistent translation option cache in " << reduceCacheTime << " seconds." << std::endl);
-}
-
-CacheColl &PhraseDictionary::GetCache() const
-{
-  CacheColl *cache;
-  cache = m_cache.get();
-  if (cache == NULL) {
-    cache = new CacheColl;
-    m_cache.reset(cache);
+  m_cache.ReleaseThreadEntries();
+  IFVERBOSE(2) {
+    TRACE_ERR("Translation option cache of " << GetScoreProducerDescription()
+              << ": " << m_cache.GetSize() << " entries, " << m_cache.GetHits()
+              << " hits, " << m_cache.GetMisses() << " misses" << std::endl);
   }
-  assert(cache);
-  return *cache;
 }
 
 bool PhraseDictionary::SatisfyBackoff(const InputPath &inputPath) const
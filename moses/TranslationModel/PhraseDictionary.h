@@ -44,6 +44,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "moses/TargetPhraseCollection.h"
 #include "moses/InputPath.h"
 #include "moses/FF/DecodeFeature.h"
+#include "moses/TranslationModel/PhraseDictionaryCache.h"
 
 namespace Moses
 {
@@ -55,16 +56,6 @@ class ChartCellCollectionBase;
 class ChartRuleLookupManager;
 class ChartParser;
 
-class CacheColl : public boost::unordered_map<size_t, std::pair<const TargetPhraseCollection*, clock_t> >
-{
-// 1st = hash of source phrase/ address of phrase-table node
-// 2nd = all translations
-// 3rd = time of last access
-
-public:
-  ~CacheColl();
-};
-
 /**
   * Abstract base class for phrase dictionaries (tables).
   **/
@@ -159,19 +150,16 @@ protected:
 
   // cache
   size_t m_maxCacheSize; // 0 = no caching
-
-#ifdef WITH_THREADS
-  //reader-writer lock
-  mutable boost::thread_specific_ptr<CacheColl> m_cache;
-#else
-  mutable boost::scoped_ptr<CacheColl> m_cache;
-#endif
+  PhraseDictionaryCache m_cache; // shared by all threads
 
   virtual const TargetPhraseCollection *GetTargetPhraseCollectionNonCacheLEGACY(const Phrase& src) const;
+  //! call between sentences: lets the cache free what this thread no longer uses
   void ReduceCache() const;
 
 protected:
-  CacheColl &GetCache() const;
+  const PhraseDictionaryCache &GetCache() const {
+    return m_cache;
+  }
   size_t m_id;
 
 };
@@ -0,0 +1,150 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include "PhraseDictionaryCache.h"
+#include "moses/TargetPhraseCollection.h"
+#include "util/murmur_hash.hh"
+
+namespace Moses
+{
+
+PhraseDictionaryCache::PhraseDictionaryCache(size_t maxSize)
+  : m_maxSize(maxSize)
+{
+}
+
+PhraseDictionaryCache::Shard &PhraseDictionaryCache::GetShard(size_t key) const
+{
+  // keys may be file offsets, so mix the bits before picking a shard
+  return m_shards[util::MurmurHashNative(&key, sizeof(key)) % NumShards];
+}
+
+PhraseDictionaryCache::Held &PhraseDictionaryCache::GetHeld() const
+{
+#ifdef WITH_THREADS
+  Held *held = m_held.get();
+  if (held == NULL) {
+    held = new Held;
+    m_held.reset(held);
+  }
+  return *held;
+#else
+  return m_held;
+#endif
+}
+
+bool PhraseDictionaryCache::Find(size_t key, const TargetPhraseCollection *&value) const
+{
+  Shard &shard = GetShard(key);
+  Value found;
+  {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(shard.mutex);
+#endif
+    boost::unordered_map<size_t, LRUList::iterator>::const_iterator iter = shard.index.find(key);
+    if (iter == shard.index.end()) {
+      ++shard.misses;
+      return false;
+    }
+    ++shard.hits;
+    // move to front
+    shard.lru.splice(shard.lru.begin(), shard.lru, iter->second);
+    found = iter->second->value;
+  }
+
+  GetHeld().push_back(found);
+  value = found.get();
+  return true;
+}
+
+const TargetPhraseCollection *PhraseDictionaryCache::Insert(size_t key, const TargetPhraseCollection *value) const
+{
+  Value inserted(value);
+  Shard &shard = GetShard(key);
+  const size_t shardSize = (m_maxSize + NumShards - 1) / NumShards;
+  {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(shard.mutex);
+#endif
+    boost::unordered_map<size_t, LRUList::iterator>::iterator iter = shard.index.find(key);
+    if (iter != shard.index.end()) {
+      // lost a race with another thread looking up the same phrase
+      shard.lru.splice(shard.lru.begin(), shard.lru, iter->second);
+      inserted = iter->second->value;
+    } else if (shardSize) {
+      Entry entry;
+      entry.key = key;
+      entry.value = inserted;
+      shard.lru.push_front(entry);
+      shard.index[key] = shard.lru.begin();
+
+      while (shard.lru.size() > shardSize) {
+        // threads still holding the evicted collection keep it alive
+        shard.index.erase(shard.lru.back().key);
+        shard.lru.pop_back();
+      }
+    }
+  }
+
+  GetHeld().push_back(inserted);
+  return inserted.get();
+}
+
+void PhraseDictionaryCache::ReleaseThreadEntries() const
+{
+  Held().swap(GetHeld());
+}
+
+size_t PhraseDictionaryCache::GetSize() const
+{
+  size_t ret = 0;
+  for (size_t i = 0; i < NumShards; ++i) {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_shards[i].mutex);
+#endif
+    ret += m_shards[i].lru.size();
+  }
+  return ret;
+}
+
+size_t PhraseDictionaryCache::GetHits() const
+{
+  size_t ret = 0;
+  for (size_t i = 0; i < NumShards; ++i) {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_shards[i].mutex);
+#endif
+    ret += m_shards[i].hits;
+  }
+  return ret;
+}
+
+size_t PhraseDictionaryCache::GetMisses() const
+{
+  size_t ret = 0;
+  for (size_t i = 0; i < NumShards; ++i) {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_shards[i].mutex);
+#endif
+    ret += m_shards[i].misses;
+  }
+  return ret;
+}
+
+}
@@ -0,0 +1,117 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_PhraseDictionaryCache_h
+#define moses_PhraseDictionaryCache_h
+
+#include <list>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#endif
+
+namespace Moses
+{
+
+class TargetPhraseCollection;
+
+/** Translations of source phrases, shared by all decoding threads.
+ *
+ * Keys are hashes of source phrases, or addresses of phrase-table nodes.
+ * The cache is split into shards, each with its own mutex and its own
+ * least-recently-used list, so that threads looking up different phrases
+ * rarely wait for each other. Each shard keeps at most 1/NumShards of
+ * GetMaxSize() collections, rounded up.
+ *
+ * Collections are handed out as raw pointers, but another thread may evict
+ * an entry at any time. So every collection returned to a thread is also
+ * held by that thread until it calls ReleaseThreadEntries(), which phrase
+ * tables do between sentences.
+ */
+class PhraseDictionaryCache
+{
+public:
+  explicit PhraseDictionaryCache(size_t maxSize);
+
+  size_t GetMaxSize() const {
+    return m_maxSize;
+  }
+  //! not thread-safe. Only call while loading
+  void SetMaxSize(size_t maxSize) {
+    m_maxSize = maxSize;
+  }
+
+  /** look up key. Returns false if it isn't cached. The collection, which may
+   * be NULL if the phrase has no translations, is held for this thread */
+  bool Find(size_t key, const TargetPhraseCollection *&value) const;
+
+  /** cache value under key, taking ownership. If another thread cached the
+   * key in the meantime, value is deleted and the existing collection is
+   * returned instead. The returned collection is held for this thread */
+  const TargetPhraseCollection *Insert(size_t key, const TargetPhraseCollection *value) const;
+
+  //! let go of the collections this thread got since the last call
+  void ReleaseThreadEntries() const;
+
+  size_t GetSize() const;
+  size_t GetHits() const;
+  size_t GetMisses() const;
+
+private:
+  typedef boost::shared_ptr<const TargetPhraseCollection> Value;
+  typedef std::vector<Value> Held;
+
+  struct Entry {
+    size_t key;
+    Value value;
+  };
+  typedef std::list<Entry> LRUList; /**< most recently used at the front */
+
+  struct Shard {
+    LRUList lru;
+    boost::unordered_map<size_t, LRUList::iterator> index;
+    size_t hits, misses;
+#ifdef WITH_THREADS
+    boost::mutex mutex;
+#endif
+    Shard() : hits(0), misses(0) {}
+  };
+
+  static const size_t NumShards = 16;
+
+  mutable Shard m_shards[NumShards];
+  size_t m_maxSize; /**< over all shards. 0 = don't keep anything between sentences */
+
+#ifdef WITH_THREADS
+  mutable boost::thread_specific_ptr<Held> m_held;
+#else
+  mutable Held m_held;
+#endif
+
+  Shard &GetShard(size_t key) const;
+  Held &GetHeld() const;
+};
+
+}
+
+#endif
@@ -57,15 +57,12 @@ void PhraseDictionaryTransliteration::GetTargetPhraseCollection(InputPath &input
   const Phrase &sourcePhrase = inputPath.GetPhrase();
   size_t hash = hash_value(sourcePhrase);
 
-  CacheColl &cache = GetCache();
+  const PhraseDictionaryCache &cache = GetCache();
 
-  CacheColl::iterator iter;
-  iter = cache.find(hash);
-
-  if (iter != cache.end()) {
+  const TargetPhraseCollection *cached;
+  if (cache.Find(hash, cached)) {
     // already in cache
-    const TargetPhraseCollection *tpColl = iter->second.first;
-    inputPath.SetTargetPhrases(*this, tpColl, NULL);
+    inputPath.SetTargetPhrases(*this, cached, NULL);
   } else {
     // TRANSLITERATE
     char *ptr = tmpnam(NULL);
@@ -97,10 +94,9 @@ void PhraseDictionaryTransliteration::GetTargetPhraseCollection(InputPath &input
       tpColl->Add(tp);
     }
 
-    std::pair<const TargetPhraseCollection*, clock_t> value(tpColl, clock());
-    cache[hash] = value;
+    const TargetPhraseCollection *cached = cache.Insert(hash, tpColl);
 
-    inputPath.SetTargetPhrases(*this, tpColl, NULL);
+    inputPath.SetTargetPhrases(*this, cached, NULL);
 
     // clean up temporary files
     remove(inFile.c_str());
@@ -68,7 +68,13 @@ void ProbingPT::InitializeForInput(InputType const& source)
 
 void ProbingPT::GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
 {
-  CacheColl &cache = GetCache();
+  const PhraseDictionaryCache &cache = GetCache();
+
+  // phrases that aren't cached. Their entries are all found, and paged in,
+  // before the first one is decoded
+  std::vector<InputPath*> inputPaths;
+  std::vector<size_t> cacheKeys;
+  std::vector<uint64_t> probingKeys;
 
   InputPathList::const_iterator iter;
   for (iter = inputPathQueue.begin(); iter != inputPathQueue.end(); ++iter) {
@@ -79,14 +85,30 @@ void ProbingPT::GetTargetPhraseCollectionBatch(const InputPathList &inputPathQue
       continue;
     }
 
-    TargetPhraseCollection *tpColl = CreateTargetPhrase(sourcePhrase);
-
-    // add target phrase to phrase-table cache
+    const TargetPhraseCollection *tpColl;
     size_t hash = hash_value(sourcePhrase);
-    std::pair<const TargetPhraseCollection*, clock_t> value(tpColl, clock());
-    cache[hash] = value;
+    if (cache.Find(hash, tpColl)) {
+      inputPath.SetTargetPhrases(*this, tpColl, NULL);
+      continue;
+    }
+
+    inputPaths.push_back(&inputPath);
+    cacheKeys.push_back(hash);
 
-    inputPath.SetTargetPhrases(*this, tpColl, NULL);
+    bool ok;
+    vector<uint64_t> probingSource = ConvertToProbingSourcePhrase(sourcePhrase, ok);
+    if (ok) {
+      probingKeys.push_back(m_engine->getKey(probingSource));
+    }
+  }
+
+  m_engine->prefetch(probingKeys);
+
+  for (size_t i = 0; i < inputPaths.size(); ++i) {
+    // add target phrase to phrase-table cache
+    const TargetPhraseCollection *tpColl
+    = cache.Insert(cacheKeys[i], CreateTargetPhrase(inputPaths[i]->GetPhrase()));
+    inputPaths[i]->SetTargetPhrases(*this, tpColl, NULL);
   }
 }
 
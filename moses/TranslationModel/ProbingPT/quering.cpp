@@ -1,4 +1,5 @@
 #include "quering.hh"
+#include "util/mmap.hh"
 
 unsigned char * read_binary_file(const char * filename, size_t filesize)
 {
@@ -86,17 +87,33 @@ QueryEngine::~QueryEngine()
 
 }
 
-std::pair<bool, std::vector<target_text> > QueryEngine::query(std::vector<uint64_t> source_phrase)
+uint64_t QueryEngine::getKey(const std::vector<uint64_t> &source_phrase) const
 {
-  bool found;
-  std::vector<target_text> translation_entries;
-  const Entry * entry;
   //TOO SLOW
   //uint64_t key = util::MurmurHashNative(&source_phrase[0], source_phrase.size());
   uint64_t key = 0;
   for (int i = 0; i < source_phrase.size(); i++) {
     key += (source_phrase[i] << i);
   }
+  return key;
+}
+
+void QueryEngine::prefetch(const std::vector<uint64_t> &keys) const
+{
+  const Entry * entry;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (table.Find(keys[i], entry)) {
+      util::AdviseWillNeed(binary_mmaped + entry -> GetValue(), entry -> bytes_toread);
+    }
+  }
+}
+
+std::pair<bool, std::vector<target_text> > QueryEngine::query(std::vector<uint64_t> source_phrase)
+{
+  bool found;
+  std::vector<target_text> translation_entries;
+  const Entry * entry;
+  uint64_t key = getKey(source_phrase);
 
 
   found = table.Find(key, entry);
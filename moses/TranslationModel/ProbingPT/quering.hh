@@ -30,6 +30,10 @@ class QueryEngine {
         ~QueryEngine();
         std::pair<bool, std::vector<target_text> > query(StringPiece source_phrase);
         std::pair<bool, std::vector<target_text> > query(std::vector<uint64_t> source_phrase);
+        uint64_t getKey(const std::vector<uint64_t> &source_phrase) const;
+        //Finds all keys first and asks the OS to page in their target phrases,
+        //so that the disk reads of a batch of queries overlap
+        void prefetch(const std::vector<uint64_t> &keys) const;
         void printTargetInfo(std::vector<target_text> target_phrases);
         const std::map<unsigned int, std::string> getVocab() const
         { return decoder.get_target_lookup_map(); }
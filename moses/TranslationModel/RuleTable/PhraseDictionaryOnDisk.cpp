@@ -18,6 +18,7 @@
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  ***********************************************************************/
 
+#include <set>
 #include "PhraseDictionaryOnDisk.h"
 #include "moses/InputFileStream.h"
 #include "moses/StaticData.h"
@@ -104,12 +105,67 @@ void PhraseDictionaryOnDisk::InitializeForInput(InputType const& source)
   m_implementation.reset(obj);
 }
 
+/** The node of a path is a child of its previous path's node, so nodes are
+ * read in waves: a wave ends before the first path whose previous path is
+ * in the same wave. For text input, that is one wave per phrase length.
+ * Within a wave, the reads of all nodes are announced to the OS before the
+ * first node is read, and so are the reads of all target phrase collections
+ * at the end. With the table on slow storage, those reads then overlap */
 void PhraseDictionaryOnDisk::GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
 {
-  InputPathList::const_iterator iter;
+  OnDiskPt::OnDiskWrapper &wrapper = const_cast<OnDiskPt::OnDiskWrapper&>(GetImplementation());
+
+  InputPathList::const_iterator iter = inputPathQueue.begin();
+  while (iter != inputPathQueue.end()) {
+    std::set<const InputPath*> wave;
+    std::vector<InputPath*> found;
+    std::vector<UINT64> filePos;
+
+    for (; iter != inputPathQueue.end() && !wave.count((*iter)->GetPrevPath()); ++iter) {
+      InputPath &inputPath = **iter;
+      wave.insert(&inputPath);
+
+      UINT64 nodeFilePos;
+      if (FindSourceNode(inputPath, nodeFilePos)) {
+        wrapper.AdviseSourceNode(nodeFilePos);
+        found.push_back(&inputPath);
+        filePos.push_back(nodeFilePos);
+      }
+    }
+
+    for (size_t i = 0; i < found.size(); ++i) {
+      const OnDiskPt::PhraseNode *ptNode = new OnDiskPt::PhraseNode(filePos[i], wrapper);
+      found[i]->SetTargetPhrases(*this, NULL, ptNode);
+    }
+  }
+
+  // target phrases of the nodes that aren't cached
+  const PhraseDictionaryCache &cache = GetCache();
+  std::vector<InputPath*> uncached;
   for (iter = inputPathQueue.begin(); iter != inputPathQueue.end(); ++iter) {
     InputPath &inputPath = **iter;
-    GetTargetPhraseCollectionBatch(inputPath);
+    const OnDiskPt::PhraseNode *ptNode = static_cast<const OnDiskPt::PhraseNode*>(inputPath.GetPtNode(*this));
+    if (ptNode == NULL) {
+      continue;
+    }
+
+    const TargetPhraseCollection *targetPhrases;
+    if (cache.Find((size_t) ptNode->GetFilePos(), targetPhrases)) {
+      inputPath.SetTargetPhrases(*this, targetPhrases, ptNode);
+    } else {
+      if (ptNode->GetValue() > 0) {
+        wrapper.AdviseTargetPhraseCollection(ptNode->GetValue());
+      }
+      uncached.push_back(&inputPath);
+    }
+  }
+
+  for (size_t i = 0; i < uncached.size(); ++i) {
+    InputPath &inputPath = *uncached[i];
+    const OnDiskPt::PhraseNode *ptNode = static_cast<const OnDiskPt::PhraseNode*>(inputPath.GetPtNode(*this));
+    const TargetPhraseCollection *targetPhrases
+    = cache.Insert((size_t) ptNode->GetFilePos(), GetTargetPhraseCollectionNonCache(ptNode));
+    inputPath.SetTargetPhrases(*this, targetPhrases, ptNode);
   }
 
   // delete nodes that's been saved
@@ -121,7 +177,7 @@ void PhraseDictionaryOnDisk::GetTargetPhraseCollectionBatch(const InputPathList
 
 }
 
-void PhraseDictionaryOnDisk::GetTargetPhraseCollectionBatch(InputPath &inputPath) const
+bool PhraseDictionaryOnDisk::FindSourceNode(InputPath &inputPath, UINT64 &filePos) const
 {
   OnDiskPt::OnDiskWrapper &wrapper = const_cast<OnDiskPt::OnDiskWrapper&>(GetImplementation());
   const Phrase &phrase = inputPath.GetPhrase();
@@ -139,54 +195,42 @@ void PhraseDictionaryOnDisk::GetTargetPhraseCollectionBatch(InputPath &inputPath
 
   // backoff
   if (!SatisfyBackoff(inputPath)) {
-    return;
+    return false;
   }
 
-  if (prevPtNode) {
-    Word lastWord = phrase.GetWord(phrase.GetSize() - 1);
-    lastWord.OnlyTheseFactors(m_inputFactors);
-    OnDiskPt::Word *lastWordOnDisk = wrapper.ConvertFromMoses(m_input, lastWord);
+  if (prevPtNode == NULL) {
+    return false;
+  }
 
-    if (lastWordOnDisk == NULL) {
-      // OOV according to this phrase table. Not possible to extend
-      inputPath.SetTargetPhrases(*this, NULL, NULL);
-    } else {
-      const OnDiskPt::PhraseNode *ptNode = prevPtNode->GetChild(*lastWordOnDisk, wrapper);
-      if (ptNode) {
-        const TargetPhraseCollection *targetPhrases = GetTargetPhraseCollection(ptNode);
-        inputPath.SetTargetPhrases(*this, targetPhrases, ptNode);
-      } else {
-        inputPath.SetTargetPhrases(*this, NULL, NULL);
-      }
+  Word lastWord = phrase.GetWord(phrase.GetSize() - 1);
+  lastWord.OnlyTheseFactors(m_inputFactors);
+  OnDiskPt::Word *lastWordOnDisk = wrapper.ConvertFromMoses(m_input, lastWord);
 
-      delete lastWordOnDisk;
-    }
+  if (lastWordOnDisk == NULL) {
+    // OOV according to this phrase table. Not possible to extend
+    inputPath.SetTargetPhrases(*this, NULL, NULL);
+    return false;
+  }
+
+  bool found = prevPtNode->FindChild(*lastWordOnDisk, filePos, wrapper);
+  if (!found) {
+    inputPath.SetTargetPhrases(*this, NULL, NULL);
   }
+
+  delete lastWordOnDisk;
+  return found;
 }
 
 const TargetPhraseCollection *PhraseDictionaryOnDisk::GetTargetPhraseCollection(const OnDiskPt::PhraseNode *ptNode) const
 {
   const TargetPhraseCollection *ret;
 
-  CacheColl &cache = GetCache();
+  const PhraseDictionaryCache &cache = GetCache();
   size_t hash = (size_t) ptNode->GetFilePos();
 
-  CacheColl::iterator iter;
-
-  iter = cache.find(hash);
-
-  if (iter == cache.end()) {
+  if (!cache.Find(hash, ret)) {
     // not in cache, need to look up from phrase table
-    ret = GetTargetPhraseCollectionNonCache(ptNode);
-
-    std::pair<const TargetPhraseCollection*, clock_t> value(ret, clock());
-    cache[hash] = value;
-  } else {
-    // in cache. just use it
-    std::pair<const TargetPhraseCollection*, clock_t> &value = iter->second;
-    value.second = clock();
-
-    ret = value.first;
+    ret = cache.Insert(hash, GetTargetPhraseCollectionNonCache(ptNode));
   }
 
   return ret;
@@ -62,7 +62,8 @@ protected:
   OnDiskPt::OnDiskWrapper &GetImplementation();
   const OnDiskPt::OnDiskWrapper &GetImplementation() const;
 
-  void GetTargetPhraseCollectionBatch(InputPath &inputPath) const;
+  //! file position of the node for inputPath. False, and maybe an empty result, if there is none
+  bool FindSourceNode(InputPath &inputPath, UINT64 &filePos) const;
 
 public:
   PhraseDictionaryOnDisk(const std::string &line);
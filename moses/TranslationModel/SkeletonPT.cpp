@@ -24,7 +24,7 @@ void SkeletonPT::InitializeForInput(InputType const& source)
 
 void SkeletonPT::GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
 {
-  CacheColl &cache = GetCache();
+  const PhraseDictionaryCache &cache = GetCache();
 
   InputPathList::const_iterator iter;
   for (iter = inputPathQueue.begin(); iter != inputPathQueue.end(); ++iter) {
@@ -37,10 +37,9 @@ void SkeletonPT::GetTargetPhraseCollectionBatch(const InputPathList &inputPathQu
 
     // add target phrase to phrase-table cache
     size_t hash = hash_value(sourcePhrase);
-    std::pair<const TargetPhraseCollection*, clock_t> value(tpColl, clock());
-    cache[hash] = value;
+    const TargetPhraseCollection *cached = cache.Insert(hash, tpColl);
 
-    inputPath.SetTargetPhrases(*this, tpColl, NULL);
+    inputPath.SetTargetPhrases(*this, cached, NULL);
   }
 }
 
@@ -38,6 +38,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "moses/FF/UnknownWordPenaltyProducer.h"
 #include "moses/FF/LexicalReordering/LexicalReordering.h"
 #include "moses/FF/InputFeature.h"
+#include "moses/ThreadPool.h"
 #include "util/exception.hh"
 
 using namespace std;
@@ -60,6 +61,7 @@ TranslationOptionCollection::TranslationOptionCollection(
   ,m_futureScore(src.GetSize())
   ,m_maxNoTransOptPerCoverage(maxNoTransOptPerCoverage)
   ,m_translationOptionThreshold(translationOptionThreshold)
+  ,m_threadsPerSentence(1)
 {
   // create 2-d vector
   size_t size = src.GetSize();
@@ -100,49 +102,7 @@ void TranslationOptionCollection::Prune()
     maxSize = std::min(maxSize, maxSizePhrase);
 
     for (size_t endPos = startPos ; endPos < startPos + maxSize ; ++endPos) {
-      // consider list for a span
-      TranslationOptionList &fullList = GetTranslationOptionList(startPos, endPos);
-      total += fullList.size();
-
-      // size pruning
-      if (m_maxNoTransOptPerCoverage > 0 &&
-          fullList.size() > m_maxNoTransOptPerCoverage) {
-        // sort in vector
-        NTH_ELEMENT4(fullList.begin(), fullList.begin() + m_maxNoTransOptPerCoverage, fullList.end(), CompareTranslationOption);
-        totalPruned += fullList.size() - m_maxNoTransOptPerCoverage;
-
-        // delete the rest
-        for (size_t i = m_maxNoTransOptPerCoverage ; i < fullList.size() ; ++i) {
-          delete fullList.Get(i);
-        }
-        fullList.resize(m_maxNoTransOptPerCoverage);
-      }
-
-      // threshold pruning
-      if (fullList.size() > 1 && m_translationOptionThreshold != -std::numeric_limits<float>::infinity()) {
-        // first, find the best score
-        float bestScore = -std::numeric_limits<float>::infinity();
-        for (size_t i=0; i < fullList.size() ; ++i) {
-          if (fullList.Get(i)->GetFutureScore() > bestScore)
-            bestScore = fullList.Get(i)->GetFutureScore();
-        }
-        //std::cerr << "best score for span " << startPos << "-" << endPos << " is " << bestScore << "\n";
-        // then, remove items that are worse than best score + threshold
-        for (size_t i=0; i < fullList.size() ; ++i) {
-          if (fullList.Get(i)->GetFutureScore() < bestScore + m_translationOptionThreshold) {
-            //std::cerr << "\tremoving item " << i << ", score " << fullList.Get(i)->GetFutureScore() << ": " << fullList.Get(i)->GetTargetPhrase() << "\n";
-            delete fullList.Get(i);
-            fullList.Remove(i);
-            total--;
-            totalPruned++;
-            i--;
-          }
-          //else
-          //{
-          //	std::cerr << "\tkeeping item " << i << ", score " << fullList.Get(i)->GetFutureScore() << ": " << fullList.Get(i)->GetTargetPhrase() << "\n";
-          //}
-        }
-      } // end of threshold pruning
+      Prune(GetTranslationOptionList(startPos, endPos), total, totalPruned);
     }
   } // end of loop through all spans
 
@@ -150,6 +110,55 @@ void TranslationOptionCollection::Prune()
           << "Total translation options pruned: " << totalPruned << std::endl);
 }
 
+//! prune the list for a span
+void TranslationOptionCollection::Prune(TranslationOptionList &fullList, size_t &total, size_t &totalPruned) const
+{
+  total += fullList.size();
+
+  if (m_maxNoTransOptPerCoverage == 0 && m_translationOptionThreshold == -std::numeric_limits<float>::infinity())
+    return;
+
+  // size pruning
+  if (m_maxNoTransOptPerCoverage > 0 &&
+      fullList.size() > m_maxNoTransOptPerCoverage) {
+    // sort in vector
+    NTH_ELEMENT4(fullList.begin(), fullList.begin() + m_maxNoTransOptPerCoverage, fullList.end(), CompareTranslationOption);
+    totalPruned += fullList.size() - m_maxNoTransOptPerCoverage;
+
+    // delete the rest
+    for (size_t i = m_maxNoTransOptPerCoverage ; i < fullList.size() ; ++i) {
+      delete fullList.Get(i);
+    }
+    fullList.resize(m_maxNoTransOptPerCoverage);
+  }
+
+  // threshold pruning
+  if (fullList.size() > 1 && m_translationOptionThreshold != -std::numeric_limits<float>::infinity()) {
+    // first, find the best score
+    float bestScore = -std::numeric_limits<float>::infinity();
+    for (size_t i=0; i < fullList.size() ; ++i) {
+      if (fullList.Get(i)->GetFutureScore() > bestScore)
+        bestScore = fullList.Get(i)->GetFutureScore();
+    }
+    //std::cerr << "best score for span " << startPos << "-" << endPos << " is " << bestScore << "\n";
+    // then, remove items that are worse than best score + threshold
+    for (size_t i=0; i < fullList.size() ; ++i) {
+      if (fullList.Get(i)->GetFutureScore() < bestScore + m_translationOptionThreshold) {
+        //std::cerr << "\tremoving item " << i << ", score " << fullList.Get(i)->GetFutureScore() << ": " << fullList.Get(i)->GetTargetPhrase() << "\n";
+        delete fullList.Get(i);
+        fullList.Remove(i);
+        total--;
+        totalPruned++;
+        i--;
+      }
+      //else
+      //{
+      //	std::cerr << "\tkeeping item " << i << ", score " << fullList.Get(i)->GetFutureScore() << ": " << fullList.Get(i)->GetTargetPhrase() << "\n";
+      //}
+    }
+  } // end of threshold pruning
+}
+
 /** Force a creation of a translation option where there are none for a particular source position.
 * ie. where a source word has not been translated, create a translation option by
 *				1. not observing the table limits on phrase/generation tables
@@ -375,6 +384,17 @@ void TranslationOptionCollection::CreateTranslationOptions()
   // table loaded on initialization), generate TranslationOption objects
   // for all phrases
 
+#ifdef WITH_THREADS
+  ThreadPool *pool = StaticData::Instance().GetSentenceThreadPool();
+  if (pool && m_threadsPerSentence > 1 && m_source.GetSize() > 1) {
+    if (SupportsConcurrentCreation()) {
+      CreateTranslationOptionsConcurrently(*pool);
+      return;
+    }
+    VERBOSE(1, "Input type doesn't support concurrent option creation, creating translation options serially" << endl);
+  }
+#endif
+
   // there may be multiple decoding graphs (factorizations of decoding)
   const vector <DecodeGraph*> &decodeGraphList = StaticData::Instance().GetDecodeGraphs();
 
@@ -388,53 +408,209 @@ void TranslationOptionCollection::CreateTranslationOptions()
     }
 
     const DecodeGraph &decodeGraph = *decodeGraphList[graphInd];
-    size_t backoff = decodeGraph.GetBackoff();
     // generate phrases that start at startPos ...
 //    VERBOSE(1,"TranslationOptionCollection::CreateTranslationOptions() graphInd:" << graphInd << endl);
     for (size_t startPos = 0 ; startPos < size; startPos++) {
+      CreateTranslationOptionsForStartPos(decodeGraph, graphInd, startPos);
+    }
+  }
+
+  VERBOSE(3,"Translation Option Collection\n " << *this << endl);
+
+  ProcessUnknownWord();
+
+  EvaluateWithSourceContext();
+
+  // Prune
+  Prune();
+
+  Sort();
+
+  // future score matrix
+  CalcFutureScore();
+
+  // Cached lex reodering costs
+  CacheLexReordering();
+}
+
+void TranslationOptionCollection::CreateTranslationOptionsForStartPos(const DecodeGraph &decodeGraph, size_t graphInd, size_t startPos)
+{
 //      VERBOSE(1,"TranslationOptionCollection::CreateTranslationOptions() startPos:" << startPos << endl);
-      size_t maxSize = size - startPos; // don't go over end of sentence
-      size_t maxSizePhrase = StaticData::Instance().GetMaxPhraseLength();
-      maxSize = std::min(maxSize, maxSizePhrase);
+  size_t backoff = decodeGraph.GetBackoff();
+  size_t maxSize = m_source.GetSize() - startPos; // don't go over end of sentence
+  size_t maxSizePhrase = StaticData::Instance().GetMaxPhraseLength();
+  maxSize = std::min(maxSize, maxSizePhrase);
 
-      // ... and that end at endPos
-      for (size_t endPos = startPos ; endPos < startPos + maxSize ; endPos++) {
+  // ... and that end at endPos
+  for (size_t endPos = startPos ; endPos < startPos + maxSize ; endPos++) {
 //        VERBOSE(1,"TranslationOptionCollection::CreateTranslationOptions() endPos:" << endPos << endl);
-        if (graphInd > 0 && // only skip subsequent graphs
-            backoff != 0 && // use of backoff specified
-            (endPos-startPos+1 > backoff || // size exceeds backoff limit or ...
-             m_collection[startPos][endPos-startPos].size() > 0)) { // no phrases found so far
-          VERBOSE(3,"No backoff to graph " << graphInd << " for span [" << startPos << ";" << endPos << "]" << endl);
-          // do not create more options
+    if (graphInd > 0 && // only skip subsequent graphs
+        backoff != 0 && // use of backoff specified
+        (endPos-startPos+1 > backoff || // size exceeds backoff limit or ...
+         m_collection[startPos][endPos-startPos].size() > 0)) { // no phrases found so far
+      VERBOSE(3,"No backoff to graph " << graphInd << " for span [" << startPos << ";" << endPos << "]" << endl);
+      // do not create more options
 //          VERBOSE(1,"TranslationOptionCollection::CreateTranslationOptions() continue:" << endl);
-          continue;
-        }
+      continue;
+    }
 
-        // create translation options for that range
+    // create translation options for that range
 //        VERBOSE(1,"TranslationOptionCollection::CreateTranslationOptions() before CreateTranslationOptionsForRange" << endl);
-        CreateTranslationOptionsForRange( decodeGraph, startPos, endPos, true, graphInd);
+    CreateTranslationOptionsForRange( decodeGraph, startPos, endPos, true, graphInd);
 //        VERBOSE(1,"TranslationOptionCollection::CreateTranslationOptions() after CreateTranslationOptionsForRange" << endl);
-      }
+  }
+}
+
+void TranslationOptionCollection::FinishTranslationOptionsForStartPos(size_t startPos, bool evaluateSourceContext, bool cacheLexReordering, size_t &total, size_t &totalPruned)
+{
+  size_t maxSize = m_source.GetSize() - startPos;
+  size_t maxSizePhrase = StaticData::Instance().GetMaxPhraseLength();
+  maxSize = std::min(maxSize, maxSizePhrase);
+
+  for (size_t endPos = startPos ; endPos < startPos + maxSize ; ++endPos) {
+    TranslationOptionList &transOptList = GetTranslationOptionList(startPos, endPos);
+    if (evaluateSourceContext) {
+      EvaluateWithSourceContext(transOptList);
+    }
+    Prune(transOptList, total, totalPruned);
+    Sort(transOptList);
+    if (cacheLexReordering) {
+      CacheLexReordering(transOptList);
     }
   }
+}
+
+#ifdef WITH_THREADS
+/** runs the per-span work for all spans with the same start position.
+ * Each task only touches the option lists of its own start position */
+class TranslationOptionCollection::StartPosTask : public Task
+{
+public:
+  StartPosTask(TranslationOptionCollection &coll, size_t startPos)
+    : m_coll(coll)
+    , m_startPos(startPos)
+    , m_decodeGraph(NULL)
+    , m_graphInd(0)
+    , m_evaluateSourceContext(false)
+    , m_cacheLexReordering(false)
+    , m_total(0)
+    , m_totalPruned(0) {}
+
+  //! next Run() creates options from this graph
+  void SetDecodeGraph(const DecodeGraph &decodeGraph, size_t graphInd) {
+    m_decodeGraph = &decodeGraph;
+    m_graphInd = graphInd;
+  }
+
+  //! next Run() scores, prunes and sorts the options
+  void SetFinish(bool evaluateSourceContext, bool cacheLexReordering) {
+    m_decodeGraph = NULL;
+    m_evaluateSourceContext = evaluateSourceContext;
+    m_cacheLexReordering = cacheLexReordering;
+  }
+
+  virtual void Run() {
+    if (m_decodeGraph) {
+      m_coll.CreateTranslationOptionsForStartPos(*m_decodeGraph, m_graphInd, m_startPos);
+    } else {
+      m_coll.FinishTranslationOptionsForStartPos(m_startPos, m_evaluateSourceContext, m_cacheLexReordering, m_total, m_totalPruned);
+    }
+  }
+
+  virtual bool DeleteAfterExecution() {
+    return false;
+  }
+
+  size_t GetTotal() const {
+    return m_total;
+  }
+  size_t GetTotalPruned() const {
+    return m_totalPruned;
+  }
+
+private:
+  TranslationOptionCollection &m_coll;
+  size_t m_startPos;
+  const DecodeGraph *m_decodeGraph;
+  size_t m_graphInd;
+  bool m_evaluateSourceContext;
+  bool m_cacheLexReordering;
+  size_t m_total, m_totalPruned;
+};
+
+/** same steps as the serial CreateTranslationOptions(), but spans with
+ * different start positions are handled in parallel. Decoding graphs are
+ * still done one after the other, because backoff looks at the options
+ * found by earlier graphs */
+void TranslationOptionCollection::CreateTranslationOptionsConcurrently(ThreadPool &pool)
+{
+  const vector <DecodeGraph*> &decodeGraphList = StaticData::Instance().GetDecodeGraphs();
+  const size_t size = m_source.GetSize();
+
+  // one task per start position. Short spans near the end of the sentence
+  // are cheap, so there are more tasks than threads to keep them all busy
+  vector<StartPosTask*> tasks;
+  vector<Task*> batch;
+  for (size_t startPos = 0 ; startPos < size ; ++startPos) {
+    tasks.push_back(new StartPosTask(*this, startPos));
+    batch.push_back(tasks.back());
+  }
+
+  for (size_t graphInd = 0 ; graphInd < decodeGraphList.size() ; graphInd++) {
+    if (decodeGraphList.size() > 1) {
+      VERBOSE(3,"Creating translation options from decoding graph " << graphInd << endl);
+    }
+    for (size_t i = 0 ; i < tasks.size() ; ++i) {
+      tasks[i]->SetDecodeGraph(*decodeGraphList[graphInd], graphInd);
+    }
+    pool.RunAndWait(batch);
+  }
 
   VERBOSE(3,"Translation Option Collection\n " << *this << endl);
 
   ProcessUnknownWord();
 
-  EvaluateWithSourceContext();
+  // features that keep per-input state in InitializeForInput(), e.g. in
+  // thread local storage, only see it on this thread
+  const bool concurrentSourceContext = FeatureFunction::AllSupportConcurrentSourceContextEvaluation();
+  if (!concurrentSourceContext) {
+    EvaluateWithSourceContext();
+  }
 
-  // Prune
-  Prune();
+  // lexical reordering tables that are loaded per thread are done afterwards
+  bool concurrentLexReordering = true;
+  const std::vector<const StatefulFeatureFunction*> &ffs = StatefulFeatureFunction::GetStatefulFeatureFunctions();
+  for (size_t i = 0 ; i < ffs.size() ; ++i) {
+    if (typeid(*ffs[i]) == typeid(LexicalReordering) &&
+        !static_cast<const LexicalReordering*>(ffs[i])->SupportsConcurrentLookup()) {
+      concurrentLexReordering = false;
+    }
+  }
 
-  Sort();
+  for (size_t i = 0 ; i < tasks.size() ; ++i) {
+    tasks[i]->SetFinish(concurrentSourceContext, concurrentLexReordering);
+  }
+  pool.RunAndWait(batch);
+
+  size_t total = 0;
+  size_t totalPruned = 0;
+  for (size_t i = 0 ; i < tasks.size() ; ++i) {
+    total += tasks[i]->GetTotal();
+    totalPruned += tasks[i]->GetTotalPruned();
+  }
+  VERBOSE(2,"       Total translation options: " << total << std::endl
+          << "Total translation options pruned: " << totalPruned << std::endl);
+
+  RemoveAllInColl(tasks);
 
   // future score matrix
   CalcFutureScore();
 
-  // Cached lex reodering costs
-  CacheLexReordering();
+  if (!concurrentLexReordering) {
+    CacheLexReordering();
+  }
 }
+#endif
 
 void TranslationOptionCollection::CreateTranslationOptionsForRange(
   const DecodeGraph &decodeGraph
@@ -562,19 +738,22 @@ void TranslationOptionCollection::EvaluateWithSourceContext()
     maxSize = std::min(maxSize, maxSizePhrase);
 
     for (size_t endPos = startPos ; endPos < startPos + maxSize ; ++endPos) {
-      TranslationOptionList &transOptList = GetTranslationOptionList(startPos, endPos);
-
-      TranslationOptionList::const_iterator iterTransOpt;
-      for(iterTransOpt = transOptList.begin() ; iterTransOpt != transOptList.end() ; ++iterTransOpt) {
-        TranslationOption &transOpt = **iterTransOpt;
-        transOpt.EvaluateWithSourceContext(m_source);
-      }
-
-      EvaluateTranslatonOptionListWithSourceContext(transOptList);
+      EvaluateWithSourceContext(GetTranslationOptionList(startPos, endPos));
     }
   }
 }
 
+void TranslationOptionCollection::EvaluateWithSourceContext(TranslationOptionList &transOptList)
+{
+  TranslationOptionList::const_iterator iterTransOpt;
+  for(iterTransOpt = transOptList.begin() ; iterTransOpt != transOptList.end() ; ++iterTransOpt) {
+    TranslationOption &transOpt = **iterTransOpt;
+    transOpt.EvaluateWithSourceContext(m_source);
+  }
+
+  EvaluateTranslatonOptionListWithSourceContext(transOptList);
+}
+
 void TranslationOptionCollection::EvaluateTranslatonOptionListWithSourceContext(
   TranslationOptionList &translationOptionList)
 {
@@ -599,12 +778,16 @@ void TranslationOptionCollection::Sort()
     maxSize = std::min(maxSize, maxSizePhrase);
 
     for (size_t endPos = startPos ; endPos < startPos + maxSize; ++endPos) {
-      TranslationOptionList &transOptList = GetTranslationOptionList(startPos, endPos);
-      std::sort(transOptList.begin(), transOptList.end(), CompareTranslationOption);
+      Sort(GetTranslationOptionList(startPos, endPos));
     }
   }
 }
 
+void TranslationOptionCollection::Sort(TranslationOptionList &transOptList) const
+{
+  std::sort(transOptList.begin(), transOptList.end(), CompareTranslationOption);
+}
+
 /** Check if this range overlaps with any XML options. This doesn't need to be an exact match, only an overlap.
  * by default, we don't support XML options. subclasses need to override this function.
  * called by CreateTranslationOptionsForRange()
@@ -687,32 +870,35 @@ std::ostream& operator<<(std::ostream& out, const TranslationOptionCollection& c
 void TranslationOptionCollection::CacheLexReordering()
 {
   size_t size = m_source.GetSize();
+  for (size_t startPos = 0 ; startPos < size ; startPos++) {
+    size_t maxSize =  size - startPos;
+    size_t maxSizePhrase = StaticData::Instance().GetMaxPhraseLength();
+    maxSize = std::min(maxSize, maxSizePhrase);
+
+    for (size_t endPos = startPos ; endPos < startPos + maxSize; endPos++) {
+      CacheLexReordering(GetTranslationOptionList(startPos, endPos));
+    }
+  }
+}
 
+void TranslationOptionCollection::CacheLexReordering(TranslationOptionList &transOptList) const
+{
   const std::vector<const StatefulFeatureFunction*> &ffs = StatefulFeatureFunction::GetStatefulFeatureFunctions();
   std::vector<const StatefulFeatureFunction*>::const_iterator iter;
   for (iter = ffs.begin(); iter != ffs.end(); ++iter) {
     const StatefulFeatureFunction &ff = **iter;
     if (typeid(ff) == typeid(LexicalReordering)) {
       const LexicalReordering &lexreordering = static_cast<const LexicalReordering&>(ff);
-      for (size_t startPos = 0 ; startPos < size ; startPos++) {
-        size_t maxSize =  size - startPos;
-        size_t maxSizePhrase = StaticData::Instance().GetMaxPhraseLength();
-        maxSize = std::min(maxSize, maxSizePhrase);
-
-        for (size_t endPos = startPos ; endPos < startPos + maxSize; endPos++) {
-          TranslationOptionList &transOptList = GetTranslationOptionList( startPos, endPos);
-          TranslationOptionList::iterator iterTransOpt;
-          for(iterTransOpt = transOptList.begin() ; iterTransOpt != transOptList.end() ; ++iterTransOpt) {
-            TranslationOption &transOpt = **iterTransOpt;
-            //Phrase sourcePhrase =  m_source.GetSubString(WordsRange(startPos,endPos));
-            const Phrase &sourcePhrase = transOpt.GetInputPath().GetPhrase();
-            Scores score = lexreordering.GetProb(sourcePhrase
-                                                 , transOpt.GetTargetPhrase());
-            if (!score.empty())
-              transOpt.CacheLexReorderingScores(lexreordering, score);
-          } // for(iterTransOpt
-        } // for (size_t endPos = startPos ; endPos < startPos + maxSize; endPos++) {
-      } // for (size_t startPos = 0 ; startPos < size ; startPos++) {
+      TranslationOptionList::iterator iterTransOpt;
+      for(iterTransOpt = transOptList.begin() ; iterTransOpt != transOptList.end() ; ++iterTransOpt) {
+        TranslationOption &transOpt = **iterTransOpt;
+        //Phrase sourcePhrase =  m_source.GetSubString(WordsRange(startPos,endPos));
+        const Phrase &sourcePhrase = transOpt.GetInputPath().GetPhrase();
+        Scores score = lexreordering.GetProb(sourcePhrase
+                                             , transOpt.GetTargetPhrase());
+        if (!score.empty())
+          transOpt.CacheLexReorderingScores(lexreordering, score);
+      } // for(iterTransOpt
     } // if (typeid(ff) == typeid(LexicalReordering)) {
   } // for (iter = ffs.begin(); iter != ffs.end(); ++iter) {
 }
@@ -45,6 +45,9 @@ class Word;
 class DecodeGraph;
 class PhraseDictionary;
 class InputPath;
+#ifdef WITH_THREADS
+class ThreadPool;
+#endif
 
 /** Contains all phrase translations applicable to current input type (a sentence or confusion network).
  * A key insight into efficient decoding is that various input
@@ -71,6 +74,7 @@ protected:
   const float				m_translationOptionThreshold; /*< threshold for translation options with regard to best option for input span */
   std::vector<const Phrase*> m_unksrcs;
   InputPathList m_inputPathQueue;
+  size_t m_threadsPerSentence; /*< tasks that may create and score options at the same time. 1 = serial */
 
   TranslationOptionCollection(InputType const& src, size_t maxNoTransOptPerCoverage,
                               float translationOptionThreshold);
@@ -84,9 +88,11 @@ protected:
 
   //! pruning: only keep the top n (m_maxNoTransOptPerCoverage) elements */
   void Prune();
+  void Prune(TranslationOptionList &fullList, size_t &total, size_t &totalPruned) const;
 
   //! sort all trans opt in each list for cube pruning */
   void Sort();
+  void Sort(TranslationOptionList &transOptList) const;
 
   //! list of trans opt for a particular span
   TranslationOptionList &GetTranslationOptionList(size_t startPos, size_t endPos);
@@ -97,10 +103,29 @@ protected:
   virtual void ProcessUnknownWord(size_t sourcePos)=0;
 
   void EvaluateWithSourceContext();
+  void EvaluateWithSourceContext(TranslationOptionList &transOptList);
 
   void EvaluateTranslatonOptionListWithSourceContext(TranslationOptionList&);
 
   void CacheLexReordering();
+  void CacheLexReordering(TranslationOptionList &transOptList) const;
+
+  //! all spans of one decode graph that start at startPos
+  void CreateTranslationOptionsForStartPos(const DecodeGraph &decodeGraph, size_t graphInd, size_t startPos);
+
+  //! source context scores (optionally), pruning, sorting (and optionally lex reordering) for spans that start at startPos
+  void FinishTranslationOptionsForStartPos(size_t startPos, bool evaluateSourceContext, bool cacheLexReordering, size_t &total, size_t &totalPruned);
+
+  /** whether CreateTranslationOptionsForRange() can be called for different
+   * spans at the same time. True if all phrase lookups are done beforehand */
+  virtual bool SupportsConcurrentCreation() const {
+    return false;
+  }
+
+#ifdef WITH_THREADS
+  class StartPosTask;
+  void CreateTranslationOptionsConcurrently(ThreadPool &pool);
+#endif
 
   void GetTargetPhraseCollectionBatch();
 
@@ -127,6 +152,11 @@ public:
     return m_unksrcs;
   }
 
+  //! number of threads CreateTranslationOptions() may use. Default is 1
+  void SetThreadsPerSentence(size_t threads) {
+    m_threadsPerSentence = threads;
+  }
+
   //! Create all possible translations from the phrase tables
   virtual void CreateTranslationOptions();
   //! Create translation options that exactly cover a specific input span.
@@ -169,6 +169,11 @@ void TranslationOptionCollectionConfusionNet::CreateTranslationOptions()
   TranslationOptionCollection::CreateTranslationOptions();
 }
 
+bool TranslationOptionCollectionConfusionNet::SupportsConcurrentCreation() const
+{
+  return !StaticData::Instance().GetUseLegacyPT();
+}
+
 
 /** create translation options that exactly cover a specific input span.
  * Called by CreateTranslationOptions() and ProcessUnknownWord()
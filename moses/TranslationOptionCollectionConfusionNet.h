@@ -34,6 +34,9 @@ protected:
       , bool adhereTableLimit
       , size_t graphInd);
 
+  //! the legacy phrase tables are queried while ranges are processed
+  bool SupportsConcurrentCreation() const;
+
 public:
   TranslationOptionCollectionConfusionNet(const ConfusionNet &source, size_t maxNoTransOptPerCoverage, float translationOptionThreshold);
 
@@ -45,6 +45,11 @@ protected:
 
   InputPath &GetInputPath(size_t startPos, size_t endPos);
 
+  //! phrases are looked up in CreateTranslationOptions() before any range is processed
+  bool SupportsConcurrentCreation() const {
+    return true;
+  }
+
 public:
   void ProcessUnknownWord(size_t sourcePos);
 
@@ -30,6 +30,11 @@ TranslationTask::~TranslationTask()
   delete m_source;
 }
 
+size_t TranslationTask::GetCost() const
+{
+  return m_source->GetSize();
+}
+
 void TranslationTask::Run()
 {
   // shorthand for "global data"
@@ -123,6 +128,8 @@ void TranslationTask::Run()
 
   manager->OutputAlignment(m_ioWrapper.GetAlignmentInfoCollector());
 
+  m_ioWrapper.FinishTranslation(translationId);
+
   // report additional statistics
   manager->CalcDecoderStatistics();
   VERBOSE(1, "Line " << translationId << ": Additional reporting took " << additionalReportingTime << " seconds total" << endl);
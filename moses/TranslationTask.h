@@ -34,6 +34,9 @@ public:
    * gets called by main function implemented at end of this source file */
   void Run();
 
+  //! longer input takes longer to translate
+  size_t GetCost() const;
+
 
 private:
   Moses::InputType* m_source;
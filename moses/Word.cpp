@@ -51,11 +51,12 @@ int Word::Compare(const Word &targetWord, const Word &sourceWord)
     return targetWord.IsNonTerminal() ? -1 : 1;
   }
 
+  // by id. 0 means there is no factor
   for (size_t factorType = 0 ; factorType < MAX_NUM_FACTORS ; factorType++) {
-    const Factor *targetFactor = targetWord[factorType];
-    const Factor *sourceFactor = sourceWord[factorType];
+    const uint32_t targetFactor = targetWord.m_factorIds[factorType];
+    const uint32_t sourceFactor = sourceWord.m_factorIds[factorType];
 
-    if (targetFactor == NULL || sourceFactor == NULL)
+    if (targetFactor == 0 || sourceFactor == 0)
       continue;
     if (targetFactor == sourceFactor)
       continue;
@@ -69,10 +70,8 @@ int Word::Compare(const Word &targetWord, const Word &sourceWord)
 void Word::Merge(const Word &sourceWord)
 {
   for (unsigned int currFactor = 0 ; currFactor < MAX_NUM_FACTORS ; currFactor++) {
-    const Factor *sourcefactor		= sourceWord.m_factorArray[currFactor]
-                                    ,*targetFactor		= this     ->m_factorArray[currFactor];
-    if (targetFactor == NULL && sourcefactor != NULL) {
-      m_factorArray[currFactor] = sourcefactor;
+    if (m_factorIds[currFactor] == 0) {
+      m_factorIds[currFactor] = sourceWord.m_factorIds[currFactor];
     }
   }
 }
@@ -88,7 +87,7 @@ std::string Word::GetString(const vector<FactorType> factorType,bool endWithBlan
                    "Trying to reference factor " << factorType[i]
                    << ". Max factor is " << MAX_NUM_FACTORS);
 
-    const Factor *factor = m_factorArray[factorType[i]];
+    const Factor *factor = GetFactor(factorType[i]);
     if (factor != NULL) {
       if (firstPass) {
         firstPass = false;
@@ -104,7 +103,7 @@ std::string Word::GetString(const vector<FactorType> factorType,bool endWithBlan
 
 StringPiece Word::GetString(FactorType factorType) const
 {
-  return m_factorArray[factorType]->GetString();
+  return GetFactor(factorType)->GetString();
 }
 
 class StrayFactorException : public util::Exception {};
@@ -146,7 +145,7 @@ CreateFromString(FactorDirection direction
   for (size_t k = 0; k < factorOrder.size(); ++k) {
     UTIL_THROW_IF(factorOrder[k] >= MAX_NUM_FACTORS, util::Exception,
                   "Factor order out of bounds.");
-    m_factorArray[factorOrder[k]] = factorCollection.AddFactor(bits[k], isNonTerminal);
+    SetFactor(factorOrder[k], factorCollection.AddFactor(bits[k], isNonTerminal));
   }
   // assume term/non-term same for all factors
   m_isNonTerminal = isNonTerminal;
@@ -184,7 +183,7 @@ void Word::OnlyTheseFactors(const FactorMask &factors)
 
 bool Word::IsEpsilon() const
 {
-  const Factor *factor = m_factorArray[0];
+  const Factor *factor = GetFactor(0);
   int compare = factor->GetString().compare(EPSILON);
 
   return compare == 0;
@@ -22,6 +22,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef moses_Word_h
 #define moses_Word_h
 
+#include <cassert>
 #include <cstring>
 #include <iostream>
 #include <vector>
@@ -29,17 +30,21 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "util/murmur_hash.hh"
 
+#include "Factor.h"
 #include "TypeDef.h"
 #include "Util.h"
 #include "util/string_piece.hh"
 
 namespace Moses
 {
-class Factor;
 class FactorMask;
 
 /** Represent a word (terminal or non-term)
  * Wrapper around hold a set of factors for a single word
+ *
+ * Factors are held as 32-bit factor ids rather than pointers, which halves
+ * the size of a word on 64-bit machines. GetFactor() turns an id back into
+ * the factor through Factor::FromId().
  */
 class Word
 {
@@ -47,23 +52,47 @@ class Word
 
 protected:
 
-  typedef const Factor * FactorArray[MAX_NUM_FACTORS];
+  typedef uint32_t FactorIdArray[MAX_NUM_FACTORS];
 
-  FactorArray m_factorArray; /**< set of factors */
+  FactorIdArray m_factorIds; /**< id + 1 of each factor, 0 if there is none */
   bool m_isNonTerminal;
   bool m_isOOV;
 
 public:
+  //! what non-const operator[] returns, so that word[type] = factor still works
+  class FactorRef
+  {
+    Word &m_word;
+    FactorType m_factorType;
+  public:
+    FactorRef(Word &word, FactorType factorType)
+      : m_word(word), m_factorType(factorType) {
+    }
+    FactorRef &operator=(const Factor *factor) {
+      m_word.SetFactor(m_factorType, factor);
+      return *this;
+    }
+    FactorRef &operator=(const FactorRef &other) {
+      return *this = static_cast<const Factor*>(other);
+    }
+    operator const Factor*() const {
+      return m_word.GetFactor(m_factorType);
+    }
+    const Factor *operator->() const {
+      return m_word.GetFactor(m_factorType);
+    }
+  };
+
   /** deep copy */
   Word(const Word &copy)
     :m_isNonTerminal(copy.m_isNonTerminal)
     ,m_isOOV(copy.m_isOOV) {
-    std::memcpy(m_factorArray, copy.m_factorArray, sizeof(FactorArray));
+    std::memcpy(m_factorIds, copy.m_factorIds, sizeof(FactorIdArray));
   }
 
   /** empty word */
   explicit Word(bool isNonTerminal = false) {
-    std::memset(m_factorArray, 0, sizeof(FactorArray));
+    std::memset(m_factorIds, 0, sizeof(FactorIdArray));
     m_isNonTerminal = isNonTerminal;
     m_isOOV = false;
   }
@@ -71,20 +100,30 @@ public:
   ~Word() {}
 
   //! returns Factor pointer for particular FactorType
-  const Factor*& operator[](FactorType index) {
-    return m_factorArray[index];
+  FactorRef operator[](FactorType index) {
+    return FactorRef(*this, index);
   }
 
-  const Factor * const & operator[](FactorType index) const {
-    return m_factorArray[index];
+  const Factor *operator[](FactorType index) const {
+    return GetFactor(index);
   }
 
   //! Deprecated. should use operator[]
   inline const Factor* GetFactor(FactorType factorType) const {
-    return m_factorArray[factorType];
+    const uint32_t id = m_factorIds[factorType];
+    return id ? Factor::FromId(id - 1) : NULL;
   }
   inline void SetFactor(FactorType factorType, const Factor *factor) {
-    m_factorArray[factorType] = factor;
+    m_factorIds[factorType] = factor ? factor->GetId() + 1 : 0;
+  }
+
+  //! same as GetFactor(factorType)->GetId(), without looking up the factor
+  inline size_t GetFactorId(FactorType factorType) const {
+    assert(m_factorIds[factorType]);
+    return m_factorIds[factorType] - 1;
+  }
+  inline bool HasFactor(FactorType factorType) const {
+    return m_factorIds[factorType] != 0;
   }
 
   inline bool IsNonTerminal() const {
@@ -159,7 +198,7 @@ public:
   void OnlyTheseFactors(const FactorMask &factors);
 
   inline size_t hash() const {
-    return util::MurmurHashNative(m_factorArray, MAX_NUM_FACTORS*sizeof(Factor*), m_isNonTerminal);
+    return util::MurmurHashNative(m_factorIds, sizeof(FactorIdArray), m_isNonTerminal);
   }
 };
 
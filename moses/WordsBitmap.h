@@ -22,6 +22,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef moses_WordsBitmap_h
 #define moses_WordsBitmap_h
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 #include <iostream>
@@ -30,122 +31,252 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <cstdlib>
 #include "TypeDef.h"
 #include "WordsRange.h"
+#include "util/murmur_hash.hh"
 
 namespace Moses
 {
 typedef unsigned long WordsBitmapID;
 
-/** vector of boolean used to represent whether a word has been translated or not
+/** vector of boolean used to represent whether a word has been translated or not.
+ * Bits are packed 64 to a block. Sentences of up to InlineBlocks*64 words are
+ * stored inside the object itself, so copying a bitmap (once per hypothesis)
+ * does not touch the heap. The first gap and number of covered words are
+ * cached and kept up to date by SetValue().
 */
 class WordsBitmap
 {
   friend std::ostream& operator<<(std::ostream& out, const WordsBitmap& wordsBitmap);
 protected:
+  typedef UINT64 Block;
+  static const size_t BlockBits = 64;
+  static const size_t InlineBlocks = 2;
+
   const size_t m_size; /**< number of words in sentence */
-  bool	*m_bitmap;	/**< ticks of words that have been done */
+  const size_t m_numBlocks; /**< number of blocks used by m_bitmap */
+  Block	*m_bitmap;	/**< ticks of words that have been done. Points to m_inline for short sentences */
+  Block m_inline[InlineBlocks];
+  size_t m_firstGap; /**< cached position of 1st word not yet translated */
+  size_t m_numWordsCovered; /**< cached count of words translated */
 
   WordsBitmap(); // not implemented
+  WordsBitmap& operator=(const WordsBitmap&); // not implemented
+
+  static size_t NumBlocks(size_t size) {
+    return (size + BlockBits - 1) / BlockBits;
+  }
+
+  //! bits [bit, BlockBits) of a block
+  static Block MaskFrom(size_t bit) {
+    return ~Block(0) << bit;
+  }
+
+  //! bits [0, bit] of a block
+  static Block MaskTo(size_t bit) {
+    return ~Block(0) >> (BlockBits - 1 - bit);
+  }
+
+  static size_t PopCount(Block block) {
+#ifdef __GNUC__
+    return __builtin_popcountll(block);
+#else
+    size_t count = 0;
+    for (; block; block &= block - 1) ++count;
+    return count;
+#endif
+  }
+
+  //! index of lowest set bit. block must not be 0
+  static size_t LowestBit(Block block) {
+#ifdef __GNUC__
+    return __builtin_ctzll(block);
+#else
+    size_t bit = 0;
+    while (!(block & 1)) {
+      block >>= 1;
+      ++bit;
+    }
+    return bit;
+#endif
+  }
+
+  //! index of highest set bit. block must not be 0
+  static size_t HighestBit(Block block) {
+#ifdef __GNUC__
+    return BlockBits - 1 - __builtin_clzll(block);
+#else
+    size_t bit = 0;
+    while (block >>= 1) ++bit;
+    return bit;
+#endif
+  }
+
+  void Allocate() {
+    m_bitmap = (m_numBlocks <= InlineBlocks) ? m_inline : (Block*) malloc(sizeof(Block) * m_numBlocks);
+  }
 
   //! set all elements to false
   void Initialize() {
-    for (size_t pos = 0 ; pos < m_size ; pos++) {
-      m_bitmap[pos] = false;
-    }
+    std::memset(m_bitmap, 0, sizeof(Block) * m_numBlocks);
+    m_firstGap = m_size ? 0 : NOT_FOUND;
+    m_numWordsCovered = 0;
   }
 
   //sets elements by vector
-  void Initialize(std::vector<bool> vector) {
+  void Initialize(const std::vector<bool> &vector) {
+    Initialize();
     size_t vector_size = vector.size();
-    for (size_t pos = 0 ; pos < m_size ; pos++) {
-      if (pos < vector_size && vector[pos] == true) m_bitmap[pos] = true;
-      else m_bitmap[pos] = false;
+    for (size_t pos = 0 ; pos < m_size && pos < vector_size ; pos++) {
+      if (vector[pos]) {
+        m_bitmap[pos / BlockBits] |= Block(1) << (pos % BlockBits);
+        ++m_numWordsCovered;
+      }
+    }
+    m_firstGap = FindGapFrom(0);
+  }
+
+  //! first position >= pos that has not been translated, or NOT_FOUND
+  size_t FindGapFrom(size_t pos) const {
+    if (pos >= m_size) return NOT_FOUND;
+    size_t block = pos / BlockBits;
+    Block bits = ~m_bitmap[block] & MaskFrom(pos % BlockBits);
+    while (!bits) {
+      if (++block == m_numBlocks) return NOT_FOUND;
+      bits = ~m_bitmap[block];
+    }
+    // padding bits past m_size are never set, so they look like gaps
+    pos = block * BlockBits + LowestBit(bits);
+    return pos < m_size ? pos : NOT_FOUND;
+  }
+
+  //! first position >= pos that has been translated, or NOT_FOUND
+  size_t FindCoveredFrom(size_t pos) const {
+    if (pos >= m_size) return NOT_FOUND;
+    size_t block = pos / BlockBits;
+    Block bits = m_bitmap[block] & MaskFrom(pos % BlockBits);
+    while (!bits) {
+      if (++block == m_numBlocks) return NOT_FOUND;
+      bits = m_bitmap[block];
+    }
+    return block * BlockBits + LowestBit(bits);
+  }
+
+  //! last position <= pos that has not been translated, or NOT_FOUND
+  size_t FindGapUpTo(size_t pos) const {
+    size_t block = pos / BlockBits;
+    Block bits = ~m_bitmap[block] & MaskTo(pos % BlockBits);
+    while (!bits) {
+      if (block == 0) return NOT_FOUND;
+      bits = ~m_bitmap[--block];
+    }
+    return block * BlockBits + HighestBit(bits);
+  }
+
+  //! last position <= pos that has been translated, or NOT_FOUND
+  size_t FindCoveredUpTo(size_t pos) const {
+    size_t block = pos / BlockBits;
+    Block bits = m_bitmap[block] & MaskTo(pos % BlockBits);
+    while (!bits) {
+      if (block == 0) return NOT_FOUND;
+      bits = m_bitmap[--block];
     }
+    return block * BlockBits + HighestBit(bits);
   }
 
+  //! bits [startPos, startPos + count) as an integer, count <= BlockBits
+  Block GetBits(size_t startPos, size_t count) const {
+    if (count == 0) return 0;
+    size_t block = startPos / BlockBits, offset = startPos % BlockBits;
+    Block bits = m_bitmap[block] >> offset;
+    if (offset && offset + count > BlockBits && block + 1 < m_numBlocks) {
+      bits |= m_bitmap[block + 1] << (BlockBits - offset);
+    }
+    return (count == BlockBits) ? bits : bits & ((Block(1) << count) - 1);
+  }
 
 public:
   //! create WordsBitmap of length size and initialise with vector
-  WordsBitmap(size_t size, std::vector<bool> initialize_vector)
-    :m_size	(size) {
-    m_bitmap = (bool*) malloc(sizeof(bool) * size);
+  WordsBitmap(size_t size, const std::vector<bool> &initialize_vector)
+    :m_size	(size)
+    ,m_numBlocks(NumBlocks(size)) {
+    Allocate();
     Initialize(initialize_vector);
   }
   //! create WordsBitmap of length size and initialise
   WordsBitmap(size_t size)
-    :m_size	(size) {
-    m_bitmap = (bool*) malloc(sizeof(bool) * size);
+    :m_size	(size)
+    ,m_numBlocks(NumBlocks(size)) {
+    Allocate();
     Initialize();
   }
   //! deep copy
   WordsBitmap(const WordsBitmap &copy)
-    :m_size	(copy.m_size) {
-    m_bitmap = (bool*) malloc(sizeof(bool) * m_size);
-    for (size_t pos = 0 ; pos < copy.m_size ; pos++) {
-      m_bitmap[pos] = copy.GetValue(pos);
-    }
+    :m_size	(copy.m_size)
+    ,m_numBlocks(copy.m_numBlocks)
+    ,m_firstGap(copy.m_firstGap)
+    ,m_numWordsCovered(copy.m_numWordsCovered) {
+    Allocate();
+    std::memcpy(m_bitmap, copy.m_bitmap, sizeof(Block) * m_numBlocks);
   }
   ~WordsBitmap() {
-    free(m_bitmap);
+    if (m_bitmap != m_inline) {
+      free(m_bitmap);
+    }
   }
   //! count of words translated
   size_t GetNumWordsCovered() const {
-    size_t count = 0;
-    for (size_t pos = 0 ; pos < m_size ; pos++) {
-      if (m_bitmap[pos])
-        count++;
-    }
-    return count;
+    return m_numWordsCovered;
   }
 
   //! position of 1st word not yet translated, or NOT_FOUND if everything already translated
   size_t GetFirstGapPos() const {
-    for (size_t pos = 0 ; pos < m_size ; pos++) {
-      if (!m_bitmap[pos]) {
-        return pos;
-      }
-    }
-    // no starting pos
-    return NOT_FOUND;
+    return m_firstGap;
   }
 
 
   //! position of last word not yet translated, or NOT_FOUND if everything already translated
   size_t GetLastGapPos() const {
-    for (int pos = (int) m_size - 1 ; pos >= 0 ; pos--) {
-      if (!m_bitmap[pos]) {
-        return pos;
-      }
-    }
-    // no starting pos
-    return NOT_FOUND;
+    return m_size ? FindGapUpTo(m_size - 1) : NOT_FOUND;
   }
 
 
   //! position of last translated word
   size_t GetLastPos() const {
-    for (int pos = (int) m_size - 1 ; pos >= 0 ; pos--) {
-      if (m_bitmap[pos]) {
-        return pos;
-      }
-    }
-    // no starting pos
-    return NOT_FOUND;
+    return m_size ? FindCoveredUpTo(m_size - 1) : NOT_FOUND;
   }
 
   bool IsAdjacent(size_t startPos, size_t endPos) const;
 
   //! whether a word has been translated at a particular position
   bool GetValue(size_t pos) const {
-    return m_bitmap[pos];
+    return (m_bitmap[pos / BlockBits] >> (pos % BlockBits)) & 1;
   }
   //! set value at a particular position
   void SetValue( size_t pos, bool value ) {
-    m_bitmap[pos] = value;
+    SetValue(pos, pos, value);
   }
   //! set value between 2 positions, inclusive
   void SetValue( size_t startPos, size_t endPos, bool value ) {
-    for(size_t pos = startPos ; pos <= endPos ; pos++) {
-      m_bitmap[pos] = value;
+    if (startPos > endPos) return;
+    const size_t firstBlock = startPos / BlockBits, lastBlock = endPos / BlockBits;
+    for (size_t block = firstBlock ; block <= lastBlock ; block++) {
+      Block mask = ~Block(0);
+      if (block == firstBlock) mask &= MaskFrom(startPos % BlockBits);
+      if (block == lastBlock) mask &= MaskTo(endPos % BlockBits);
+      if (value) {
+        m_numWordsCovered += PopCount(mask & ~m_bitmap[block]);
+        m_bitmap[block] |= mask;
+      } else {
+        m_numWordsCovered -= PopCount(mask & m_bitmap[block]);
+        m_bitmap[block] &= ~mask;
+      }
+    }
+
+    if (value) {
+      if (m_firstGap >= startPos && m_firstGap <= endPos) {
+        m_firstGap = FindGapFrom(endPos + 1);
+      }
+    } else if (startPos < m_firstGap) {
+      m_firstGap = startPos;
     }
   }
   //! whether every word has been translated
@@ -154,8 +285,14 @@ public:
   }
   //! whether the wordrange overlaps with any translated word in this bitmap
   bool Overlap(const WordsRange &compare) const {
-    for (size_t pos = compare.GetStartPos() ; pos <= compare.GetEndPos() ; pos++) {
-      if (m_bitmap[pos])
+    const size_t startPos = compare.GetStartPos(), endPos = compare.GetEndPos();
+    if (startPos > endPos) return false;
+    const size_t firstBlock = startPos / BlockBits, lastBlock = endPos / BlockBits;
+    for (size_t block = firstBlock ; block <= lastBlock ; block++) {
+      Block mask = ~Block(0);
+      if (block == firstBlock) mask &= MaskFrom(startPos % BlockBits);
+      if (block == lastBlock) mask &= MaskTo(endPos % BlockBits);
+      if (m_bitmap[block] & mask)
         return true;
     }
     return false;
@@ -165,7 +302,8 @@ public:
     return m_size;
   }
 
-  //! transitive comparison of WordsBitmap
+  //! transitive comparison of WordsBitmap. Orders bitmaps of equal size
+  //! lexicographically by position, covered > not covered
   inline int Compare (const WordsBitmap &compare) const {
     // -1 = less than
     // +1 = more than
@@ -177,27 +315,45 @@ public:
     if (thisSize != compareSize) {
       return (thisSize < compareSize) ? -1 : 1;
     }
-    return std::memcmp(m_bitmap, compare.m_bitmap, thisSize * sizeof(bool));
+    for (size_t block = 0 ; block < m_numBlocks ; block++) {
+      Block diff = m_bitmap[block] ^ compare.m_bitmap[block];
+      if (diff) {
+        // lowest differing bit is the first differing position
+        return (m_bitmap[block] >> LowestBit(diff)) & 1 ? 1 : -1;
+      }
+    }
+    return 0;
+  }
+
+  //! hash consistent with Compare()
+  size_t hash() const {
+    return util::MurmurHashNative(m_bitmap, sizeof(Block) * m_numBlocks, m_size);
   }
 
   bool operator< (const WordsBitmap &compare) const {
     return Compare(compare) < 0;
   }
 
+  /** first untranslated span that starts at or after pos, as
+   * [startGap, endGap]. Returns false if there is none */
+  bool GetGapFrom(size_t pos, size_t &startGap, size_t &endGap) const {
+    startGap = FindGapFrom(pos);
+    if (startGap == NOT_FOUND) return false;
+    size_t covered = FindCoveredFrom(startGap);
+    endGap = (covered == NOT_FOUND) ? m_size - 1 : covered - 1;
+    return true;
+  }
+
   inline size_t GetEdgeToTheLeftOf(size_t l) const {
     if (l == 0) return l;
-    while (l && !m_bitmap[l-1]) {
-      --l;
-    }
-    return l;
+    size_t covered = FindCoveredUpTo(l - 1);
+    return (covered == NOT_FOUND) ? 0 : covered + 1;
   }
 
   inline size_t GetEdgeToTheRightOf(size_t r) const {
     if (r+1 == m_size) return r;
-    while (r+1 < m_size && !m_bitmap[r+1]) {
-      ++r;
-    }
-    return r;
+    size_t covered = FindCoveredFrom(r + 1);
+    return (covered == NOT_FOUND) ? m_size - 1 : covered - 1;
   }
 
 
@@ -216,8 +372,8 @@ public:
 
     assert(end < start || end-start <= 16);
     WordsBitmapID id = 0;
-    for(size_t pos = end; pos > start; pos--) {
-      id = id*2 + (int) GetValue(pos);
+    if (end > start) {
+      id = GetBits(start + 1, end - start);
     }
     return id + (1<<16) * start;
   }
@@ -237,10 +393,13 @@ public:
 
     assert(end < start || end-start <= 16);
     WordsBitmapID id = 0;
-    for(size_t pos = end; pos > start; pos--) {
-      id = id*2;
-      if (GetValue(pos) || (startPos<=pos && pos<=endPos))
-        id++;
+    if (end > start) {
+      id = GetBits(start + 1, end - start);
+      // bits of the additional span that fall into the pattern
+      size_t spanStart = std::max(startPos, start + 1);
+      if (spanStart <= endPos) {
+        id |= ((WordsBitmapID(1) << (endPos - spanStart + 1)) - 1) << (spanStart - start - 1);
+      }
     }
     return id + (1<<16) * start;
   }
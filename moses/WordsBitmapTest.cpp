@@ -0,0 +1,196 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include "WordsBitmap.h"
+
+using namespace Moses;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(words_bitmap)
+
+namespace
+{
+
+// reference implementations of the queries over a plain vector<bool>
+size_t FirstGap(const vector<bool> &v)
+{
+  for (size_t i = 0; i < v.size(); ++i) if (!v[i]) return i;
+  return NOT_FOUND;
+}
+
+size_t LastGap(const vector<bool> &v)
+{
+  for (size_t i = v.size(); i > 0; --i) if (!v[i-1]) return i-1;
+  return NOT_FOUND;
+}
+
+size_t LastPos(const vector<bool> &v)
+{
+  for (size_t i = v.size(); i > 0; --i) if (v[i-1]) return i-1;
+  return NOT_FOUND;
+}
+
+size_t Count(const vector<bool> &v)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < v.size(); ++i) count += v[i];
+  return count;
+}
+
+void CheckSame(const WordsBitmap &bitmap, const vector<bool> &v)
+{
+  BOOST_REQUIRE_EQUAL(bitmap.GetSize(), v.size());
+  for (size_t i = 0; i < v.size(); ++i) {
+    BOOST_CHECK_EQUAL(bitmap.GetValue(i), v[i]);
+  }
+  BOOST_CHECK_EQUAL(bitmap.GetFirstGapPos(), FirstGap(v));
+  BOOST_CHECK_EQUAL(bitmap.GetLastGapPos(), LastGap(v));
+  BOOST_CHECK_EQUAL(bitmap.GetLastPos(), LastPos(v));
+  BOOST_CHECK_EQUAL(bitmap.GetNumWordsCovered(), Count(v));
+  BOOST_CHECK_EQUAL(bitmap.IsComplete(), Count(v) == v.size());
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(set_and_query)
+{
+  const size_t sizes[] = {1, 5, 63, 64, 65, 128, 130, 200};
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    const size_t size = sizes[s];
+    WordsBitmap bitmap(size);
+    vector<bool> v(size, false);
+    CheckSame(bitmap, v);
+
+    // cover a range across a block boundary, then punch holes
+    size_t start = size / 3, end = size - 1 - size / 4;
+    bitmap.SetValue(start, end, true);
+    for (size_t i = start; i <= end; ++i) v[i] = true;
+    CheckSame(bitmap, v);
+
+    bitmap.SetValue(0, 0, true);
+    v[0] = true;
+    CheckSame(bitmap, v);
+
+    bitmap.SetValue(end, false);
+    v[end] = false;
+    CheckSame(bitmap, v);
+
+    bitmap.SetValue(0, size - 1, true);
+    v.assign(size, true);
+    CheckSame(bitmap, v);
+    BOOST_CHECK_EQUAL(bitmap.GetFirstGapPos(), NOT_FOUND);
+
+    bitmap.SetValue(size / 2, false);
+    v[size / 2] = false;
+    CheckSame(bitmap, v);
+
+    WordsBitmap copy(bitmap);
+    CheckSame(copy, v);
+    BOOST_CHECK_EQUAL(copy.Compare(bitmap), 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(initialize_from_vector)
+{
+  vector<bool> v(140, false);
+  v[0] = v[1] = v[70] = v[139] = true;
+  WordsBitmap bitmap(140, v);
+  CheckSame(bitmap, v);
+
+  // shorter initialisation vector leaves the rest uncovered
+  vector<bool> shortVector(3, true);
+  WordsBitmap prefix(10, shortVector);
+  BOOST_CHECK_EQUAL(prefix.GetFirstGapPos(), 3);
+  BOOST_CHECK_EQUAL(prefix.GetNumWordsCovered(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(overlap_and_edges)
+{
+  WordsBitmap bitmap(150);
+  bitmap.SetValue(10, 12, true);
+  bitmap.SetValue(100, true);
+
+  BOOST_CHECK(!bitmap.Overlap(WordsRange(0, 9)));
+  BOOST_CHECK(bitmap.Overlap(WordsRange(12, 20)));
+  BOOST_CHECK(!bitmap.Overlap(WordsRange(13, 99)));
+  BOOST_CHECK(bitmap.Overlap(WordsRange(60, 140)));
+
+  BOOST_CHECK_EQUAL(bitmap.GetEdgeToTheLeftOf(50), 13);
+  BOOST_CHECK_EQUAL(bitmap.GetEdgeToTheLeftOf(5), 0);
+  BOOST_CHECK_EQUAL(bitmap.GetEdgeToTheRightOf(50), 99);
+  BOOST_CHECK_EQUAL(bitmap.GetEdgeToTheRightOf(120), 149);
+}
+
+BOOST_AUTO_TEST_CASE(compare)
+{
+  // ordering is lexicographic by position, as with the old bool array
+  WordsBitmap a(100), b(100);
+  a.SetValue(1, true);
+  b.SetValue(99, true);
+  BOOST_CHECK(b < a);
+  BOOST_CHECK(!(a < b));
+  b.SetValue(1, true);
+  BOOST_CHECK(a < b);
+  a.SetValue(99, true);
+  BOOST_CHECK_EQUAL(a.Compare(b), 0);
+
+  WordsBitmap shorter(99);
+  BOOST_CHECK(shorter < a);
+}
+
+BOOST_AUTO_TEST_CASE(ids)
+{
+  WordsBitmap bitmap(20);
+  bitmap.SetValue(0, 2, true);
+  bitmap.SetValue(5, true);
+  bitmap.SetValue(7, true);
+  // first gap 3, pattern over positions 4..7 = 1010 (pos 7 most significant)
+  BOOST_CHECK_EQUAL(bitmap.GetID(), (1UL << 16) * 3 + 10);
+
+  // covering 8-9 extends the pattern to 4..9
+  BOOST_CHECK_EQUAL(bitmap.GetIDPlus(8, 9), (1UL << 16) * 3 + 58);
+
+  // filling the first gap moves it
+  WordsBitmap filled(bitmap);
+  filled.SetValue(3, true);
+  BOOST_CHECK_EQUAL(bitmap.GetIDPlus(3, 3), filled.GetID());
+}
+
+BOOST_AUTO_TEST_CASE(gaps)
+{
+  WordsBitmap bitmap(150);
+  bitmap.SetValue(0, 9, true);
+  bitmap.SetValue(70, 127, true);
+  size_t startGap, endGap;
+  BOOST_CHECK(bitmap.GetGapFrom(0, startGap, endGap));
+  BOOST_CHECK_EQUAL(startGap, 10);
+  BOOST_CHECK_EQUAL(endGap, 69);
+  BOOST_CHECK(bitmap.GetGapFrom(endGap + 1, startGap, endGap));
+  BOOST_CHECK_EQUAL(startGap, 128);
+  BOOST_CHECK_EQUAL(endGap, 149);
+  BOOST_CHECK(!bitmap.GetGapFrom(endGap + 1, startGap, endGap));
+
+  bitmap.SetValue(128, 149, true);
+  BOOST_CHECK(!bitmap.GetGapFrom(70, startGap, endGap));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
@@ -0,0 +1,254 @@
+#ifndef UTIL_BUCKET_PROBING_HASH_TABLE_H
+#define UTIL_BUCKET_PROBING_HASH_TABLE_H
+
+#include "util/exception.hh"
+#include "util/probing_hash_table.hh"
+
+#include <algorithm>
+#include <cstddef>
+
+#include <assert.h>
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace util {
+
+namespace detail {
+// Bit i is set if bucket[i] == key.  bucket has 8 keys.
+inline unsigned int MatchBucket(const uint64_t *bucket, uint64_t key) {
+#if defined(__AVX2__)
+  const __m256i want = _mm256_set1_epi64x(key);
+  unsigned int low = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(want, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bucket)))));
+  unsigned int high = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(want, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bucket + 4)))));
+  return low | (high << 4);
+#elif defined(__SSE2__)
+  // SSE2 lacks a 64-bit compare, so compare halves and require both to match.
+  const __m128i want = _mm_set_epi32(static_cast<int>(key >> 32), static_cast<int>(key), static_cast<int>(key >> 32), static_cast<int>(key));
+  unsigned int ret = 0;
+  for (unsigned int i = 0; i < 8; i += 2) {
+    __m128i halves = _mm_cmpeq_epi32(want, _mm_loadu_si128(reinterpret_cast<const __m128i*>(bucket + i)));
+    __m128i both = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+    ret |= static_cast<unsigned int>(_mm_movemask_pd(_mm_castsi128_pd(both))) << i;
+  }
+  return ret;
+#else
+  unsigned int ret = 0;
+  for (unsigned int i = 0; i < 8; ++i) {
+    ret |= static_cast<unsigned int>(bucket[i] == key) << i;
+  }
+  return ret;
+#endif
+}
+
+inline unsigned int FirstBit(unsigned int mask) {
+  assert(mask);
+#if defined(__GNUC__)
+  return __builtin_ctz(mask);
+#else
+  unsigned int ret = 0;
+  for (; !(mask & 1); mask >>= 1) ++ret;
+  return ret;
+#endif
+}
+} // namespace detail
+
+/* Linear probing over buckets of 8 keys instead of single entries.
+ * Each bucket is a cache line of uint64_t keys followed by the 8 payloads,
+ * padded to whole lines.  A probe compares the whole line of keys at once
+ * with SIMD, so probing past a collision stays within the line instead of
+ * walking entries.  Lookups for absent keys, which are common when backing
+ * off, don't read the payloads (Prefetch does fetch them).  Keeping a
+ * bucket's payloads next to its keys rather than in another array keeps a hit
+ * within one page; the hardware usually fetches the neighbouring line with
+ * the keys.
+ *
+ * Drop-in for ProbingHashTable where the entry has a uint64_t key and a value
+ * member: iterators point to a Payload whose value member is the entry's
+ * value.  Like ProbingHashTable, memory is externalized, must start zeroed
+ * (or be Clear()ed) and there is only insert and lookup.  Buckets are on cache
+ * lines if the memory passed in is.
+ */
+template <class EntryT, class HashT> class BucketProbingHashTable {
+  public:
+    typedef EntryT Entry;
+    typedef uint64_t Key;
+    typedef HashT Hash;
+
+    struct Payload {
+      typename Entry::Value value;
+    };
+    typedef const Payload *ConstIterator;
+    typedef Payload *MutableIterator;
+
+    static const std::size_t kKeysPerBucket = 8;
+
+    static uint64_t Size(uint64_t entries, float multiplier) {
+      uint64_t slots = std::max(entries + 1, static_cast<uint64_t>(multiplier * static_cast<float>(entries)));
+      uint64_t buckets = (slots + kKeysPerBucket - 1) / kKeysPerBucket;
+      return buckets * kBucketBytes;
+    }
+
+    // Must be assigned to later.
+    BucketProbingHashTable() : entries_(0) {}
+
+    BucketProbingHashTable(void *start, std::size_t allocated, const Key &invalid = Key(), const Hash &hash_func = Hash())
+      : base_(static_cast<uint8_t*>(start)),
+        buckets_(allocated / kBucketBytes),
+        invalid_(invalid),
+        hash_(hash_func),
+        entries_(0) {}
+
+    void Relocate(void *new_base) {
+      base_ = static_cast<uint8_t*>(new_base);
+    }
+
+    template <class T> MutableIterator Insert(const T &t) {
+      UTIL_THROW_IF(++entries_ >= buckets_ * kKeysPerBucket, ProbingSizeException, "Hash table with " << (buckets_ * kKeysPerBucket) << " slots is full.");
+      for (std::size_t bucket = Ideal(t.GetKey());; bucket = Next(bucket)) {
+        unsigned int empty = detail::MatchBucket(Keys(bucket), invalid_);
+        if (empty) return Put(bucket, detail::FirstBit(empty), t);
+      }
+    }
+
+    // Return true if the value was found (and not inserted).  This is consistent with Find but the opposite if hash_map!
+    template <class T> bool FindOrInsert(const T &t, MutableIterator &out) {
+      const Key key = t.GetKey();
+      for (std::size_t bucket = Ideal(key);; bucket = Next(bucket)) {
+        unsigned int found = detail::MatchBucket(Keys(bucket), key);
+        if (found) {
+          out = Payloads(bucket) + detail::FirstBit(found);
+          return true;
+        }
+        unsigned int empty = detail::MatchBucket(Keys(bucket), invalid_);
+        if (empty) {
+          UTIL_THROW_IF(++entries_ >= buckets_ * kKeysPerBucket, ProbingSizeException, "Hash table with " << (buckets_ * kKeysPerBucket) << " slots is full.");
+          out = Put(bucket, detail::FirstBit(empty), t);
+          return false;
+        }
+      }
+    }
+
+    void FinishedInserting() {}
+
+    // Don't change anything related to GetKey,
+    bool UnsafeMutableFind(const Key key, MutableIterator &out) {
+      return FindPayload(key, out);
+    }
+
+    // Like UnsafeMutableFind, but the key must be there.
+    MutableIterator UnsafeMutableMustFind(const Key key) {
+      MutableIterator ret;
+      bool found = FindPayload(key, ret);
+      assert(found);
+      (void)found;
+      return ret;
+    }
+
+    bool Find(const Key key, ConstIterator &out) const {
+      MutableIterator ret;
+      if (!FindPayload(key, ret)) return false;
+      out = ret;
+      return true;
+    }
+
+    // Like Find but we're sure it must be there.
+    ConstIterator MustFind(const Key key) const {
+      MutableIterator ret;
+      bool found = FindPayload(key, ret);
+      assert(found);
+      (void)found;
+      return ret;
+    }
+
+    // Hint that key will be looked up soon by pulling its ideal bucket into
+    // cache: the line of keys and the first line of payloads.  Unlike Find,
+    // this touches payloads even if the key turns out to be absent, betting
+    // that prefetched keys are usually present.
+    void Prefetch(const Key key) const {
+#if defined(__GNUC__)
+      std::size_t bucket = Ideal(key);
+      __builtin_prefetch(Keys(bucket));
+      __builtin_prefetch(Payloads(bucket));
+#endif
+    }
+
+    void Clear() {
+      for (std::size_t bucket = 0; bucket < buckets_; ++bucket) {
+        std::fill(Keys(bucket), Keys(bucket) + kKeysPerBucket, invalid_);
+      }
+      entries_ = 0;
+    }
+
+    // Return number of entries assuming no serialization went on.
+    std::size_t SizeNoSerialization() const {
+      return entries_;
+    }
+
+    // Mostly for tests: every key must be reachable from its ideal bucket
+    // without crossing a bucket that has an empty slot.
+    void CheckConsistency() const {
+      for (std::size_t bucket = 0; bucket < buckets_; ++bucket) {
+        for (const Key *k = Keys(bucket); k != Keys(bucket) + kKeysPerBucket; ++k) {
+          if (*k == invalid_) continue;
+          for (std::size_t on = Ideal(*k); on != bucket; on = Next(on)) {
+            UTIL_THROW_IF(detail::MatchBucket(Keys(on), invalid_), Exception, "Inconsistency in bucket " << bucket << " with ideal bucket " << Ideal(*k));
+          }
+        }
+      }
+    }
+
+  private:
+    // A line of keys, then their payloads padded to whole lines.
+    static const std::size_t kKeyBytes = kKeysPerBucket * sizeof(Key);
+    static const std::size_t kBucketBytes = kKeyBytes + (kKeysPerBucket * sizeof(Payload) + 63) / 64 * 64;
+
+    Key *Keys(std::size_t bucket) const {
+      return reinterpret_cast<Key*>(base_ + bucket * kBucketBytes);
+    }
+
+    Payload *Payloads(std::size_t bucket) const {
+      return reinterpret_cast<Payload*>(base_ + bucket * kBucketBytes + kKeyBytes);
+    }
+
+    std::size_t Ideal(const Key key) const {
+      return hash_(key) % buckets_;
+    }
+
+    std::size_t Next(std::size_t bucket) const {
+      return (++bucket == buckets_) ? 0 : bucket;
+    }
+
+    template <class T> MutableIterator Put(std::size_t bucket, unsigned int index, const T &t) {
+      Keys(bucket)[index] = t.GetKey();
+      MutableIterator ret = Payloads(bucket) + index;
+      ret->value = t.value;
+      return ret;
+    }
+
+    bool FindPayload(const Key key, MutableIterator &out) const {
+      for (std::size_t bucket = Ideal(key);; bucket = Next(bucket)) {
+        const Key *keys = Keys(bucket);
+        unsigned int found = detail::MatchBucket(keys, key);
+        if (found) {
+          out = Payloads(bucket) + detail::FirstBit(found);
+          return true;
+        }
+        if (detail::MatchBucket(keys, invalid_)) return false;
+      }
+    }
+
+    uint8_t *base_;
+    std::size_t buckets_;
+    Key invalid_;
+    Hash hash_;
+    std::size_t entries_;
+};
+
+} // namespace util
+
+#endif // UTIL_BUCKET_PROBING_HASH_TABLE_H
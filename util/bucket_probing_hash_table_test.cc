@@ -0,0 +1,94 @@
+#include "util/bucket_probing_hash_table.hh"
+
+#include "util/murmur_hash.hh"
+#include "util/scoped.hh"
+
+#define BOOST_TEST_MODULE BucketProbingHashTableTest
+#include <boost/test/unit_test.hpp>
+#include <limits>
+#include <string.h>
+#include <stdint.h>
+
+namespace util {
+namespace {
+
+struct Entry {
+  uint64_t key;
+  typedef uint64_t Key;
+  typedef uint64_t Value;
+
+  Entry() {}
+
+  Entry(uint64_t key_in, uint64_t value_in) : key(key_in), value(value_in) {}
+
+  Key GetKey() const { return key; }
+
+  uint64_t value;
+};
+
+typedef BucketProbingHashTable<Entry, IdentityHash> Table;
+
+BOOST_AUTO_TEST_CASE(match_bucket) {
+  uint64_t bucket[8] = {1, 0, 0xffffffff00000000ULL, 3, 0x00000000ffffffffULL, 0, 7, 0xffffffff00000000ULL};
+  BOOST_CHECK_EQUAL(0x22U, detail::MatchBucket(bucket, 0));
+  BOOST_CHECK_EQUAL(0x84U, detail::MatchBucket(bucket, 0xffffffff00000000ULL));
+  BOOST_CHECK_EQUAL(0x10U, detail::MatchBucket(bucket, 0x00000000ffffffffULL));
+  BOOST_CHECK_EQUAL(0U, detail::MatchBucket(bucket, 2));
+}
+
+BOOST_AUTO_TEST_CASE(simple) {
+  size_t size = Table::Size(10, 1.2);
+  scoped_malloc mem(MallocOrThrow(size));
+  memset(mem.get(), 0, size);
+
+  Table table(mem.get(), size);
+  Table::ConstIterator i = NULL;
+  BOOST_CHECK(!table.Find(2, i));
+  table.Insert(Entry(3, 328920));
+  BOOST_REQUIRE(table.Find(3, i));
+  BOOST_CHECK_EQUAL(static_cast<uint64_t>(328920), i->value);
+  BOOST_CHECK(!table.Find(2, i));
+}
+
+// Few buckets so that keys overflow into the following buckets and wrap around.
+BOOST_AUTO_TEST_CASE(overflow) {
+  const uint64_t kEntries = 40;
+  size_t size = Table::Size(kEntries, 1.1);
+  scoped_malloc mem(MallocOrThrow(size));
+  Table table(mem.get(), size, std::numeric_limits<uint64_t>::max());
+  table.Clear();
+  for (uint64_t i = 0; i < kEntries; ++i) {
+    Table::MutableIterator it;
+    // Hash collisions: everything wants the last few buckets.
+    BOOST_CHECK(!table.FindOrInsert(Entry(i * 6 + 5, i), it));
+    BOOST_CHECK_EQUAL(i, it->value);
+  }
+  table.CheckConsistency();
+  for (uint64_t i = 0; i < kEntries; ++i) {
+    Table::ConstIterator it;
+    BOOST_REQUIRE(table.Find(i * 6 + 5, it));
+    BOOST_CHECK_EQUAL(i, it->value);
+    BOOST_CHECK_EQUAL(it, table.MustFind(i * 6 + 5));
+    Table::MutableIterator mut;
+    BOOST_CHECK(table.FindOrInsert(Entry(i * 6 + 5, 0), mut));
+    BOOST_CHECK_EQUAL(i, mut->value);
+  }
+  Table::ConstIterator it;
+  BOOST_CHECK(!table.Find(4, it));
+  BOOST_CHECK(!table.Find(0, it));
+}
+
+BOOST_AUTO_TEST_CASE(full) {
+  size_t size = Table::Size(8, 1.0);
+  scoped_malloc mem(MallocOrThrow(size));
+  memset(mem.get(), 0, size);
+  Table table(mem.get(), size);
+  for (uint64_t i = 1; i < 16; ++i) {
+    table.Insert(Entry(MurmurHash64A(&i, 8), i));
+  }
+  uint64_t last = 16;
+  BOOST_CHECK_THROW(table.Insert(Entry(MurmurHash64A(&last, 8), 16)), ProbingSizeException);
+}
+
+} // namespace
+} // namespace util
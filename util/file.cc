@@ -288,6 +288,13 @@ void FSyncOrThrow(int fd) {
 #endif
 }
 
+void AdviseWillNeed(int fd, uint64_t off, uint64_t size) {
+#if defined(POSIX_FADV_WILLNEED) && !defined(_WIN32) && !defined(_WIN64)
+  // Only a hint, so failure doesn't matter.  Size 0 would mean the rest of the file.
+  if (size) posix_fadvise(fd, off, size, POSIX_FADV_WILLNEED);
+#endif
+}
+
 namespace {
 
 // Static assert for 64-bit off_t size.
@@ -105,6 +105,10 @@ void ErsatzPWrite(int fd, const void *data_void, std::size_t size, uint64_t off)
 
 void FSyncOrThrow(int fd);
 
+// Hint that [off, off + size) will be read soon, so the kernel can start
+// reading it in the background.  Does nothing where unsupported.
+void AdviseWillNeed(int fd, uint64_t off, uint64_t size);
+
 // Seeking
 void SeekOrThrow(int fd, uint64_t off);
 void AdvanceOrThrow(int fd, int64_t off);
@@ -146,16 +146,6 @@ static const double_conversion::StringToDoubleConverter kConverter(
     "inf",
     "NaN");
 
-void ParseNumber(const char *begin, const char *&end, float &out) {
-  int count;
-  out = kConverter.StringToFloat(begin, end - begin, &count);
-  end = begin + count;
-}
-void ParseNumber(const char *begin, const char *&end, double &out) {
-  int count;
-  out = kConverter.StringToDouble(begin, end - begin, &count);
-  end = begin + count;
-}
 void ParseNumber(const char *begin, const char *&end, long int &out) {
   char *silly_end;
   out = strtol(begin, &silly_end, 10);
@@ -168,6 +158,17 @@ void ParseNumber(const char *begin, const char *&end, unsigned long int &out) {
 }
 } // namespace
 
+void ParseNumber(const char *begin, const char *&end, float &out) {
+  int count;
+  out = kConverter.StringToFloat(begin, end - begin, &count);
+  end = begin + count;
+}
+void ParseNumber(const char *begin, const char *&end, double &out) {
+  int count;
+  out = kConverter.StringToDouble(begin, end - begin, &count);
+  end = begin + count;
+}
+
 template <class T> T FilePiece::ReadNumber() {
   SkipSpaces();
   while (last_space_ < position_) {
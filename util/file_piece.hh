@@ -25,6 +25,11 @@ class ParseNumberException : public Exception {
 
 extern const bool kSpaces[256];
 
+// Parse a number at the start of [begin, end) like FilePiece::ReadFloat and
+// ReadDouble do.  end is set past the number, or to begin if there isn't one.
+void ParseNumber(const char *begin, const char *&end, float &out);
+void ParseNumber(const char *begin, const char *&end, double &out);
+
 // Memory backing the returned StringPiece may vanish on the next call.
 class FilePiece {
   public:
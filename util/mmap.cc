@@ -25,6 +25,13 @@
 #include <unistd.h>
 #endif
 
+#if defined(__linux__)
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/syscall.h>
+#endif
+
 namespace util {
 
 long SizePage() {
@@ -37,6 +44,17 @@ long SizePage() {
 #endif
 }
 
+void AdviseWillNeed(const void *start, std::size_t size) {
+#if defined(MADV_WILLNEED) && !defined(_WIN32) && !defined(_WIN64)
+  if (!size) return;
+  const std::size_t page = SizePage();
+  const std::size_t begin = reinterpret_cast<std::size_t>(start) & ~(page - 1);
+  const std::size_t end = reinterpret_cast<std::size_t>(start) + size;
+  // Only a hint, so failure doesn't matter.
+  madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+#endif
+}
+
 void SyncOrThrow(void *start, size_t length) {
 #if defined(_WIN32) || defined(_WIN64)
   UTIL_THROW_IF(!::FlushViewOfFile(start, length), ErrnoException, "Failed to sync mmap");
@@ -159,6 +177,16 @@ void MapRead(LoadMethod method, int fd, uint64_t offset, std::size_t size, scope
       out.reset(MallocOrThrow(size), size, scoped_memory::MALLOC_ALLOCATED);
       ParallelRead(fd, out.get(), size, offset);
       break;
+    case HUGE_READ:
+    case NUMA_INTERLEAVE_READ:
+      // Placement is decided when a page is first touched, so set it up
+      // before reading.
+      HugeMalloc(size, out);
+      if (method == NUMA_INTERLEAVE_READ) {
+        InterleaveNodes(out.get(), out.size());
+      }
+      ParallelRead(fd, out.get(), size, offset);
+      break;
   }
 }
 
@@ -178,6 +206,87 @@ void MapAnonymous(std::size_t size, util::scoped_memory &to) {
 #endif
 }
 
+namespace {
+#if defined(__linux__) && defined(MAP_HUGETLB)
+// Map explicit huge pages of 1 << shift bytes.  Returns MAP_FAILED if none
+// are reserved.
+void *TryHugeMap(std::size_t size, int shift, int size_flag, std::size_t &rounded) {
+  const std::size_t page = static_cast<std::size_t>(1) << shift;
+  rounded = (size + page - 1) & ~(page - 1);
+  return mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_HUGETLB | size_flag, -1, 0);
+}
+#endif
+} // namespace
+
+void HugeMalloc(std::size_t size, scoped_memory &to) {
+  to.reset();
+#if defined(__linux__) && defined(MAP_HUGETLB)
+  // Private hugetlb maps reserve their pages up front, so failure shows up
+  // here rather than as SIGBUS later.
+  std::size_t rounded;
+  void *ret;
+#  ifdef MAP_HUGE_1GB
+  if (size >= (static_cast<std::size_t>(1) << 30)) {
+    ret = TryHugeMap(size, 30, MAP_HUGE_1GB, rounded);
+    if (ret != MAP_FAILED) {
+      to.reset(ret, rounded, scoped_memory::MMAP_ALLOCATED);
+      return;
+    }
+  }
+#  endif
+#  ifdef MAP_HUGE_2MB
+  ret = TryHugeMap(size, 21, MAP_HUGE_2MB, rounded);
+#  else
+  ret = TryHugeMap(size, 21, 0, rounded);
+#  endif
+  if (ret != MAP_FAILED) {
+    to.reset(ret, rounded, scoped_memory::MMAP_ALLOCATED);
+    return;
+  }
+#endif
+  // MapOrThrow asks for transparent huge pages.
+  MapAnonymous(size, to);
+}
+
+void AdviseHugePages(void *start, std::size_t size) {
+#ifdef MADV_HUGEPAGE
+  const std::size_t page = SizePage();
+  const std::size_t begin = (reinterpret_cast<std::size_t>(start) + page - 1) & ~(page - 1);
+  const std::size_t end = (reinterpret_cast<std::size_t>(start) + size) & ~(page - 1);
+  if (begin < end) {
+    madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+  }
+#endif
+}
+
+bool InterleaveNodes(void *start, std::size_t size) {
+#if defined(__linux__) && defined(SYS_mbind)
+  // Parse the online node list, eg "0-1" or "0,2-3", into a bit mask.
+  const std::size_t kMaxNodes = 1024;
+  const std::size_t kBits = sizeof(unsigned long) * 8;
+  unsigned long mask[kMaxNodes / kBits] = {0};
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string range;
+  std::size_t nodes = 0;
+  while (std::getline(online, range, ',')) {
+    std::size_t first, last;
+    char dash;
+    std::istringstream parse(range);
+    if (!(parse >> first)) return false;
+    last = (parse >> dash >> last) ? last : first;
+    for (std::size_t node = first; node <= last && node < kMaxNodes; ++node, ++nodes) {
+      mask[node / kBits] |= 1UL << (node % kBits);
+    }
+  }
+  if (nodes < 2) return nodes == 1;
+  const int kMpolInterleave = 3; // MPOL_INTERLEAVE in linux/mempolicy.h
+  // The kernel reads maxnode - 1 bits.
+  return syscall(SYS_mbind, start, size, kMpolInterleave, mask, kMaxNodes + 1, 0) == 0;
+#else
+  return false;
+#endif
+}
+
 void *MapZeroedWrite(int fd, std::size_t size) {
   ResizeOrThrow(fd, 0);
   ResizeOrThrow(fd, size);
@@ -14,6 +14,11 @@ class scoped_fd;
 
 long SizePage();
 
+// Hint that memory in [start, start + size) will be read soon.  The range is
+// widened to whole pages.  Useful for memory mapped from slow storage; does
+// nothing where unsupported.
+void AdviseWillNeed(const void *start, std::size_t size);
+
 // (void*)-1 is MAP_FAILED; this is done to avoid including the mmap header here.  
 class scoped_mmap {
   public:
@@ -96,6 +101,12 @@ typedef enum {
   READ,
   // malloc and read in parallel (recommended for Lustre)
   PARALLEL_READ,
+  // Like PARALLEL_READ, but into memory backed by huge pages (see HugeMalloc)
+  // to cut TLB misses on large models.
+  HUGE_READ,
+  // HUGE_READ with the pages interleaved across all NUMA nodes, so that
+  // threads on every socket see the same average latency.
+  NUMA_INTERLEAVE_READ,
 } LoadMethod;
 
 extern const int kFileFlags;
@@ -107,6 +118,23 @@ void MapRead(LoadMethod method, int fd, uint64_t offset, std::size_t size, scope
 
 void MapAnonymous(std::size_t size, scoped_memory &to);
 
+// Allocates size bytes of zeroed memory in to, backed by the largest pages
+// available: explicit 1 GB then 2 MB huge pages if the administrator reserved
+// them (vm.nr_hugepages), otherwise transparent huge pages, otherwise normal
+// pages.  to.size() may be rounded up to the page size.
+void HugeMalloc(std::size_t size, scoped_memory &to);
+
+// Ask for transparent huge pages in [start, start + size), shrunk to whole
+// pages.  Only affects pages that have not been touched yet.  Does nothing
+// where unsupported.
+void AdviseHugePages(void *start, std::size_t size);
+
+// Spread the not yet touched pages of [start, start + size) round-robin over
+// the online NUMA nodes.  start must be page aligned.  Returns false if this
+// is unsupported or failed, in which case the usual first-touch placement
+// applies.
+bool InterleaveNodes(void *start, std::size_t size);
+
 // Open file name with mmap of size bytes, all of which are initially zero.  
 void *MapZeroedWrite(int fd, std::size_t size);
 void *MapZeroedWrite(const char *name, std::size_t size, scoped_fd &file);
@@ -139,6 +139,14 @@ template <class EntryT, class HashT, class EqualT = std::equal_to<typename Entry
       }    
     }
 
+    // Hint that key will be looked up soon by pulling its ideal bucket into
+    // cache.  Only a hint: there is no guarantee the entry is in that bucket.
+    template <class Key> void Prefetch(const Key key) const {
+#if defined(__GNUC__)
+      __builtin_prefetch(begin_ + (hash_(key) % buckets_));
+#endif
+    }
+
     // Like Find but we're sure it must be there.
     template <class Key> ConstIterator MustFind(const Key key) const {
       for (ConstIterator i(begin_ + (hash_(key) % buckets_));;) {
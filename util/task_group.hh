@@ -0,0 +1,125 @@
+#ifndef UTIL_TASK_GROUP_H
+#define UTIL_TASK_GROUP_H
+
+/* Run a handful of tasks on their own threads and wait for them.  This is for
+ * splitting one big job, like sorting or parsing, across cores; use
+ * ThreadPool for a stream of requests.
+ *
+ * Exceptions can't cross threads, so Join rethrows the exception of the
+ * earliest started task that failed as a util::Exception with the same
+ * message.  Without WITH_THREADS, Start runs the task immediately and errors
+ * still come out of Join.
+ */
+
+#include "util/exception.hh"
+
+#include <boost/noncopyable.hpp>
+
+#include <deque>
+#include <exception>
+#include <string>
+
+#ifdef WITH_THREADS
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread.hpp>
+#endif
+
+namespace util {
+
+namespace detail {
+
+struct TaskFailure {
+  TaskFailure() : failed(false) {}
+  bool failed;
+  std::string what;
+};
+
+template <class Task> class TaskRunner {
+  public:
+    TaskRunner(const Task &task, TaskFailure &failure) : task_(task), failure_(&failure) {}
+
+    void operator()() {
+      try {
+        task_();
+      } catch (const std::exception &e) {
+        failure_->what = e.what();
+        failure_->failed = true;
+      } catch (...) {
+        failure_->what = "Unknown exception in a task";
+        failure_->failed = true;
+      }
+    }
+
+  private:
+    Task task_;
+    TaskFailure *failure_;
+};
+
+} // namespace detail
+
+// Number of tasks worth splitting a job into: the number of cores, or 1 without threads.
+inline unsigned DefaultTaskCount() {
+#ifdef WITH_THREADS
+  unsigned ret = boost::thread::hardware_concurrency();
+  return ret ? ret : 2;
+#else
+  return 1;
+#endif
+}
+
+class TaskGroup : boost::noncopyable {
+  public:
+    TaskGroup() {}
+
+    // Waits but doesn't throw.  Call Join to see errors.
+    ~TaskGroup() {
+      Wait();
+    }
+
+    // Task is copied and called with no arguments, e.g. the result of boost::bind.
+    // Anything it references must live until Join.
+    template <class Task> void Start(const Task &task) {
+      // deque::push_back doesn't move existing elements, which running tasks point to.
+      failures_.push_back(detail::TaskFailure());
+      detail::TaskRunner<Task> runner(task, failures_.back());
+#ifdef WITH_THREADS
+      threads_.push_back(new boost::thread(runner));
+#else
+      runner();
+#endif
+    }
+
+    // Wait for all started tasks then rethrow the first failure, if any.
+    void Join() {
+      Wait();
+      std::deque<detail::TaskFailure> failures;
+      failures.swap(failures_);
+      for (std::deque<detail::TaskFailure>::const_iterator i = failures.begin(); i != failures.end(); ++i) {
+        if (i->failed) {
+          util::Exception e;
+          e << i->what;
+          throw e;
+        }
+      }
+    }
+
+  private:
+    void Wait() {
+#ifdef WITH_THREADS
+      for (boost::ptr_vector<boost::thread>::iterator i = threads_.begin(); i != threads_.end(); ++i) {
+        i->join();
+      }
+      threads_.clear();
+#endif
+    }
+
+#ifdef WITH_THREADS
+    boost::ptr_vector<boost::thread> threads_;
+#endif
+
+    std::deque<detail::TaskFailure> failures_;
+};
+
+} // namespace util
+
+#endif // UTIL_TASK_GROUP_H
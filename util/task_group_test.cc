@@ -0,0 +1,58 @@
+#include "util/task_group.hh"
+
+#include <boost/bind.hpp>
+
+#define BOOST_TEST_MODULE TaskGroupTest
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+namespace util {
+namespace {
+
+void Square(const int *in, int *out) {
+  *out = *in * *in;
+}
+
+void Fail(int number) {
+  UTIL_THROW(Exception, "Task " << number << " failed");
+}
+
+BOOST_AUTO_TEST_CASE(Results) {
+  std::vector<int> in, out(100);
+  for (int i = 0; i < 100; ++i) in.push_back(i);
+  TaskGroup group;
+  for (int i = 0; i < 100; ++i) {
+    group.Start(boost::bind(&Square, &in[i], &out[i]));
+  }
+  group.Join();
+  for (int i = 0; i < 100; ++i) {
+    BOOST_CHECK_EQUAL(i * i, out[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(FirstError) {
+  TaskGroup group;
+  int in = 3, out = 0;
+  group.Start(boost::bind(&Square, &in, &out));
+  group.Start(boost::bind(&Fail, 1));
+  group.Start(boost::bind(&Fail, 2));
+  try {
+    group.Join();
+    BOOST_FAIL("Join should have thrown");
+  } catch (const Exception &e) {
+    std::string what(e.what());
+    BOOST_CHECK(what.find("Task 1 failed") != std::string::npos);
+    BOOST_CHECK(what.find("Task 2 failed") == std::string::npos);
+  }
+  BOOST_CHECK_EQUAL(9, out);
+  // Errors were reported, so the group can be used again.
+  in = 4;
+  group.Start(boost::bind(&Square, &in, &out));
+  group.Join();
+  BOOST_CHECK_EQUAL(16, out);
+}
+
+}
+} // namespace util